@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+#include <afina/logging/Service.h>
+#include <afina/network/Server.h>
+
+#include "logging/ServiceImpl.h"
+#include "network/mt_blocking/ServerImpl.h"
+#include "network/mt_nonblocking/ServerImpl.h"
+#include "network/st_blocking/ServerImpl.h"
+#include "network/st_nonblocking/ServerImpl.h"
+#ifdef AFINA_HAVE_IO_URING
+#include "network/uring/ServerImpl.h"
+#endif
+#include "storage/StripedLRU.h"
+
+using namespace Afina;
+
+/**
+ * # Network load generator
+ * Starts server of the given type in process and loads it with memcached get/set requests over
+ * loopback. Each client thread owns a number of connections, sends a batch of pipelined requests
+ * into every connection and then waits for all responses, e.g:
+ *
+ * runNetworkBench --network mt_nonblock,mt_reuseport --threads 4 --connections 64 --depth 16
+ *
+ * Prints throughput along with voluntary context switches of the whole process per request, the
+ * latter shows how often threads go to sleep in epoll_wait/read and get woken up again. Latency is
+ * time a connection waits for responses to the whole batch. A few heavy connections make load
+ * skewed, so that workers serving them are overloaded while others idle:
+ *
+ * runNetworkBench --network mt_reuseport,mt_rebalance --connections 64 --heavy 4 --heavy-depth 512
+ */
+namespace {
+
+std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> result;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        result.push_back(item);
+    }
+    return result;
+}
+
+std::string make_key(size_t i) { return "key:" + std::to_string(i); }
+
+std::shared_ptr<Network::Server> make_server(const std::string &type, std::shared_ptr<Storage> storage,
+                                             std::shared_ptr<Logging::Service> logging) {
+    if (type == "st_block") {
+        return std::make_shared<Network::STblocking::ServerImpl>(storage, logging);
+    } else if (type == "mt_block") {
+        return std::make_shared<Network::MTblocking::ServerImpl>(storage, logging);
+    } else if (type == "st_nonblock") {
+        return std::make_shared<Network::STnonblock::ServerImpl>(storage, logging);
+    } else if (type == "mt_nonblock") {
+        return std::make_shared<Network::MTnonblock::ServerImpl>(storage, logging);
+    } else if (type == "mt_reuseport") {
+        return std::make_shared<Network::MTnonblock::ServerImpl>(storage, logging,
+                                                                 Network::MTnonblock::ServerImpl::Mode::ReusePort);
+    } else if (type == "mt_rebalance") {
+        return std::make_shared<Network::MTnonblock::ServerImpl>(storage, logging,
+                                                                 Network::MTnonblock::ServerImpl::Mode::Rebalance);
+#ifdef AFINA_HAVE_IO_URING
+    } else if (type == "uring") {
+        return std::make_shared<Network::Uring::ServerImpl>(storage, logging);
+#endif
+    }
+    throw std::runtime_error("Unknown network type: " + type);
+}
+
+int connect_to(uint16_t port) {
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // Server threads may still be starting up
+    for (int attempt = 0; attempt < 100; attempt++) {
+        int s = socket(AF_INET, SOCK_STREAM, 0);
+        if (s == -1) {
+            throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+        }
+        if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+            int opts = 1;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &opts, sizeof(opts));
+            return s;
+        }
+        close(s);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    throw std::runtime_error("Failed to connect: " + std::string(strerror(errno)));
+}
+
+// Client side of the connection, counts complete responses in the stream
+class Client {
+public:
+    explicit Client(uint16_t port) : _socket(connect_to(port)) {}
+    ~Client() { close(_socket); }
+
+    void Send(const std::string &data) {
+        for (size_t offset = 0; offset < data.size();) {
+            ssize_t sent = send(_socket, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                throw std::runtime_error("Failed to send: " + std::string(strerror(errno)));
+            }
+            offset += sent;
+        }
+    }
+
+    // Reads until the given number of responses arrive, value lines never look like response ends
+    void Receive(size_t responses) {
+        while (responses > 0) {
+            char buffer[16384];
+            ssize_t readed = read(_socket, buffer, sizeof(buffer));
+            if (readed <= 0) {
+                throw std::runtime_error("Connection closed by server");
+            }
+
+            for (ssize_t i = 0; i < readed; i++) {
+                if (buffer[i] != '\n') {
+                    _line.push_back(buffer[i]);
+                    continue;
+                }
+                if (_line == "END\r" || _line == "STORED\r") {
+                    responses--;
+                } else if (_line.compare(0, 5, "VALUE") != 0 && _line.find_first_not_of('v') != _line.size() - 1) {
+                    throw std::runtime_error("Unexpected response: " + _line);
+                }
+                _line.clear();
+            }
+        }
+    }
+
+private:
+    int _socket;
+    std::string _line;
+};
+
+// Load put by clients, first heavy connections pipeline more requests than the rest
+struct Workload {
+    size_t threads;
+    size_t connections;
+    size_t depth;
+    size_t heavy;
+    size_t heavy_depth;
+    double duration;
+    size_t keys;
+    unsigned reads;
+    size_t value_size;
+};
+
+struct Result {
+    double rps;
+    double switches;
+    double p50;
+    double p99;
+};
+
+std::string make_batch(uint64_t seed, size_t depth, const Workload &load) {
+    std::string batch, value(load.value_size, 'v');
+    uint64_t state = seed;
+    for (size_t i = 0; i < depth; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::string key = make_key((state >> 33) % load.keys);
+        if ((state >> 17) % 100 < load.reads) {
+            batch += "get " + key + "\r\n";
+        } else {
+            batch += "set " + key + " 0 0 " + std::to_string(load.value_size) + "\r\n" + value + "\r\n";
+        }
+    }
+    return batch;
+}
+
+Result run(uint16_t port, const Workload &load) {
+    std::atomic<bool> start(false), stop(false);
+    std::atomic<size_t> total(0);
+    std::vector<std::vector<double>> latencies(load.threads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < load.threads; t++) {
+        threads.emplace_back([&, t]() {
+            // Every batch is the same, so that client doesn't spend time building requests
+            std::vector<std::unique_ptr<Client>> clients;
+            std::vector<std::string> batches;
+            std::vector<size_t> depths;
+            for (size_t c = t; c < load.connections; c += load.threads) {
+                clients.emplace_back(new Client(port));
+                depths.push_back(c < load.heavy ? load.heavy_depth : load.depth);
+                batches.push_back(make_batch(c + 1, depths.back(), load));
+            }
+
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+
+            // Latency of the connection is time since batch is sent until all responses arrive
+            size_t done = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto sent = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < clients.size(); i++) {
+                    clients[i]->Send(batches[i]);
+                }
+                for (size_t i = 0; i < clients.size(); i++) {
+                    clients[i]->Receive(depths[i]);
+                    std::chrono::duration<double, std::micro> latency = std::chrono::steady_clock::now() - sent;
+                    latencies[t].push_back(latency.count());
+                    done += depths[i];
+                }
+            }
+            total.fetch_add(done);
+        });
+    }
+
+    struct rusage before, after;
+    getrusage(RUSAGE_SELF, &before);
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true);
+    std::this_thread::sleep_for(std::chrono::duration<double>(load.duration));
+    stop.store(true);
+    for (auto &t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    getrusage(RUSAGE_SELF, &after);
+
+    std::vector<double> all;
+    for (auto &l : latencies) {
+        all.insert(all.end(), l.begin(), l.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    Result result;
+    result.rps = total.load() / elapsed.count();
+    result.switches = double(after.ru_nvcsw - before.ru_nvcsw) / std::max<size_t>(total.load(), 1);
+    result.p50 = all.empty() ? 0 : all[all.size() / 2];
+    result.p99 = all.empty() ? 0 : all[all.size() * 99 / 100];
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("runNetworkBench", "Network load generator");
+    options.add_options()("network", "Comma separated network types to run",
+                          cxxopts::value<std::string>()->default_value("mt_nonblock,mt_reuseport"));
+    options.add_options()("port", "First port to listen on, each network type takes the next one",
+                          cxxopts::value<uint16_t>()->default_value("9090"));
+    options.add_options()("workers", "Number of server workers", cxxopts::value<uint32_t>()->default_value("4"));
+    options.add_options()("threads", "Number of client threads", cxxopts::value<size_t>()->default_value("4"));
+    options.add_options()("connections", "Number of client connections",
+                          cxxopts::value<size_t>()->default_value("64"));
+    options.add_options()("depth", "Requests pipelined into connection at once",
+                          cxxopts::value<size_t>()->default_value("16"));
+    options.add_options()("heavy", "Number of connections pipelining heavy-depth requests",
+                          cxxopts::value<size_t>()->default_value("0"));
+    options.add_options()("heavy-depth", "Requests pipelined into heavy connection at once",
+                          cxxopts::value<size_t>()->default_value("256"));
+    options.add_options()("duration", "Seconds to run each network type", cxxopts::value<double>()->default_value("5"));
+    options.add_options()("keys", "Number of distinct keys", cxxopts::value<size_t>()->default_value("10000"));
+    options.add_options()("reads", "Percent of get requests", cxxopts::value<unsigned>()->default_value("90"));
+    options.add_options()("value-size", "Value size in bytes", cxxopts::value<size_t>()->default_value("100"));
+    options.add_options()("h,help", "Print usage info");
+
+    try {
+        options.parse(argc, argv);
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (options.count("help") > 0) {
+        std::cerr << options.help() << std::endl;
+        return 0;
+    }
+
+    uint16_t port = options["port"].as<uint16_t>();
+    uint32_t workers = options["workers"].as<uint32_t>();
+
+    Workload load;
+    load.threads = options["threads"].as<size_t>();
+    load.connections = std::max(options["connections"].as<size_t>(), load.threads);
+    load.depth = options["depth"].as<size_t>();
+    load.heavy = options["heavy"].as<size_t>();
+    load.heavy_depth = options["heavy-depth"].as<size_t>();
+    load.duration = options["duration"].as<double>();
+    load.keys = options["keys"].as<size_t>();
+    load.reads = options["reads"].as<unsigned>();
+    load.value_size = options["value-size"].as<size_t>();
+
+    // Server reports errors only, so that logging doesn't take part in measurements
+    std::shared_ptr<Logging::Config> log_config(new Logging::Config);
+    Logging::Appender &console = log_config->appenders["console"];
+    console.type = Logging::Appender::Type::STDERR;
+    Logging::Logger &logger = log_config->loggers["root"];
+    logger.level = Logging::Logger::Level::ERROR;
+    logger.appenders.push_back("console");
+    std::shared_ptr<Logging::Service> logging(new Logging::ServiceImpl(log_config));
+    logging->Start();
+
+    std::cout << std::left << std::setw(14) << "network" << std::setw(14) << "requests/sec" << std::setw(18)
+              << "switches/request" << std::setw(10) << "p50 us"
+              << "p99 us" << std::endl;
+    for (auto &type : split(options["network"].as<std::string>())) {
+        try {
+            std::shared_ptr<Storage> storage =
+                std::make_shared<Backend::StripedLRU>(16, 4 * load.keys * (load.value_size + 64));
+            std::string value(load.value_size, 'v');
+            for (size_t i = 0; i < load.keys; i++) {
+                storage->Put(make_key(i), value);
+            }
+
+            std::shared_ptr<Network::Server> server = make_server(type, storage, logging);
+            server->Start(port, 1, workers);
+            Result result = run(port, load);
+            server->Stop();
+            server->Join();
+
+            std::cout << std::left << std::setw(14) << type << std::fixed << std::setprecision(0) << std::setw(14)
+                      << result.rps << std::setprecision(3) << std::setw(18) << result.switches << std::setprecision(0)
+                      << std::setw(10) << result.p50 << result.p99 << std::endl;
+        } catch (std::exception &ex) {
+            std::cerr << type << ": " << ex.what() << std::endl;
+        }
+        port++;
+    }
+
+    logging->Stop();
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include <afina/allocator/Region.h>
+#include <afina/execute/Command.h>
+
+#include "protocol/Parser.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+
+/**
+ * # Request processing allocations benchmark
+ * Runs stream of memcached get/set requests through the same parse -> build -> execute -> response
+ * path as blocking servers do, but without sockets. Counts heap allocations made per request once
+ * all buffers are warmed up, so that any allocation sneaking into request processing shows up,
+ * e.g:
+ *
+ * runRequestBench --requests 1000000 --key-size 32 --value-size 100 --reads 90
+ *
+ * "heap" mode is parser without request memory, "region" is per-request region as servers use.
+ * Allocations are counted by intercepting glibc malloc, storage updates values in place, so that
+ * only request processing is measured.
+ */
+namespace {
+
+std::atomic<bool> counting(false);
+std::atomic<size_t> mallocs(0);
+
+} // namespace
+
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *p, size_t size);
+
+void *malloc(size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        mallocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        mallocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        mallocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_realloc(p, size);
+}
+
+} // extern "C"
+
+namespace {
+
+std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> result;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        result.push_back(item);
+    }
+    return result;
+}
+
+std::string make_key(size_t i, size_t key_size) {
+    std::string key = "key:" + std::to_string(i);
+    key.resize(std::max(key.size(), key_size), '_');
+    return key;
+}
+
+// Client connection, processes input the same way as blocking servers do
+class Connection {
+public:
+    Connection(Storage &storage, bool region) : _storage(storage), _parser(region ? &_request_memory : nullptr) {}
+
+    // Processes the whole input read by chunks, returns number of response bytes
+    size_t Process(const std::string &input) {
+        size_t sent = 0;
+        for (size_t offset = 0; offset < input.size();) {
+            size_t readed_bytes = std::min(sizeof(_buffer), input.size() - offset);
+            std::memcpy(_buffer, input.data() + offset, readed_bytes);
+            offset += readed_bytes;
+
+            while (readed_bytes > 0) {
+                if (!_command) {
+                    size_t parsed = 0;
+                    if (_parser.Parse(_buffer, readed_bytes, parsed)) {
+                        _command = _parser.Build(_arg_remains);
+                        if (_arg_remains > 0) {
+                            _arg_remains += 2;
+                        }
+                    }
+                    if (parsed == 0) {
+                        break;
+                    }
+                    std::memmove(_buffer, _buffer + parsed, readed_bytes - parsed);
+                    readed_bytes -= parsed;
+                }
+
+                if (_command && _arg_remains > 0) {
+                    size_t to_read = std::min(_arg_remains, readed_bytes);
+                    _argument.append(_buffer, to_read);
+                    std::memmove(_buffer, _buffer + to_read, readed_bytes - to_read);
+                    _arg_remains -= to_read;
+                    readed_bytes -= to_read;
+                }
+
+                if (_command && _arg_remains == 0) {
+                    _command->Execute(_storage, _argument, _result);
+                    _result += "\r\n";
+                    sent += _result.size();
+
+                    _command.reset();
+                    _argument.resize(0);
+                    _parser.Reset();
+                    _request_memory.reset();
+                }
+            }
+        }
+        return sent;
+    }
+
+private:
+    Storage &_storage;
+    char _buffer[4096];
+
+    Allocator::Region _request_memory;
+    Protocol::Parser _parser;
+    std::unique_ptr<Execute::Command> _command;
+    size_t _arg_remains = 0;
+    std::string _argument;
+    std::string _result;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("runRequestBench", "Request processing allocations benchmark");
+    options.add_options()("mode", "Comma separated request memory modes: heap, region",
+                          cxxopts::value<std::string>()->default_value("heap,region"));
+    options.add_options()("requests", "Number of requests", cxxopts::value<size_t>()->default_value("1000000"));
+    options.add_options()("keys", "Number of distinct keys", cxxopts::value<size_t>()->default_value("1000"));
+    options.add_options()("key-size", "Key size in bytes", cxxopts::value<size_t>()->default_value("32"));
+    options.add_options()("value-size", "Value size in bytes", cxxopts::value<size_t>()->default_value("100"));
+    options.add_options()("reads", "Percent of get requests", cxxopts::value<unsigned>()->default_value("90"));
+    options.add_options()("h,help", "Print usage info");
+
+    try {
+        options.parse(argc, argv);
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (options.count("help") > 0) {
+        std::cerr << options.help() << std::endl;
+        return 0;
+    }
+
+    size_t requests = options["requests"].as<size_t>();
+    size_t keys = options["keys"].as<size_t>();
+    size_t key_size = options["key-size"].as<size_t>();
+    size_t value_size = options["value-size"].as<size_t>();
+    unsigned reads = options["reads"].as<unsigned>();
+
+    // Whole input is prepared in advance, each key is set once before any get
+    std::string input, value(value_size, 'v');
+    for (size_t i = 0; i < keys; i++) {
+        input += "set " + make_key(i, key_size) + " 0 0 " + std::to_string(value_size) + "\r\n" + value + "\r\n";
+    }
+    uint64_t state = 1;
+    for (size_t i = 0; i < requests; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::string key = make_key((state >> 33) % keys, key_size);
+        if ((state >> 17) % 100 < reads) {
+            input += "get " + key + "\r\n";
+        } else {
+            input += "set " + key + " 0 0 " + std::to_string(value_size) + "\r\n" + value + "\r\n";
+        }
+    }
+
+    std::cout << std::left << std::setw(10) << "mode" << std::setw(14) << "requests/sec" << std::setw(18)
+              << "mallocs/request"
+              << "response MB" << std::endl;
+    for (auto &mode : split(options["mode"].as<std::string>())) {
+        if (mode != "heap" && mode != "region") {
+            std::cerr << "Unknown mode: " << mode << std::endl;
+            return 1;
+        }
+
+        Backend::SimpleLRU storage(4 * keys * (key_size + value_size + 64));
+        Connection connection(storage, mode == "region");
+
+        // Warm up pass fills storage and grows all reusable buffers
+        connection.Process(input);
+
+        mallocs.store(0);
+        counting.store(true);
+        auto begin = std::chrono::steady_clock::now();
+        size_t sent = connection.Process(input);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        counting.store(false);
+
+        size_t total = keys + requests;
+        std::cout << std::left << std::setw(10) << mode << std::fixed << std::setprecision(0) << std::setw(14)
+                  << total / elapsed.count() << std::setprecision(3) << std::setw(18)
+                  << double(mallocs.load()) / total << sent / (1024 * 1024) << std::endl;
+    }
+
+    return 0;
+}
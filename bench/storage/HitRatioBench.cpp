@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include <afina/Storage.h>
+
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+
+/**
+ * # Eviction policy hit ratio benchmark
+ * Replays a trace against the storage working as a look-aside cache: each request is a Get and a
+ * miss is followed by Put of the same key. Trace is a Zipf distributed hot set mixed with periodic
+ * scans, each scan goes through keys never seen before, like a batch job reading the whole dataset
+ * does. Reports hit ratio of all requests and of hot set requests only, e.g:
+ *
+ * runHitRatioBench --policy lru,slru --keys 100000 --items 10000 --scan-every 50000 --scan-length 20000
+ *
+ * Hot set hit ratio of a scan resistant policy stays about the same with and without scans
+ * (--scan-every 0), while LRU loses the whole hot set on each scan longer than the cache.
+ *
+ * Some hot set requests could be replaced with keys requested once only, which is where admission
+ * filter of W-TinyLFU helps:
+ *
+ * runHitRatioBench --policy lru,tinylfu --scan-every 0 --noise 30
+ *
+ * Recorded trace could be replayed instead, it is a text file with a request per line and the key
+ * as the first word of the line, so block traces like ones of ARC and LIRS papers work as is:
+ *
+ * runHitRatioBench --trace OLTP.lis
+ */
+namespace {
+
+// Cheap random generator, so that every policy gets exactly the same trace
+class XorShift {
+public:
+    explicit XorShift(uint64_t seed) : _state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+
+    uint64_t next() {
+        _state ^= _state << 13;
+        _state ^= _state >> 7;
+        _state ^= _state << 17;
+        return _state;
+    }
+
+    // Uniform in [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    uint64_t _state;
+};
+
+struct Request {
+    std::string key;
+
+    // Key is out of the hot set and is requested once only
+    bool scan;
+};
+
+std::string make_key(uint64_t i) { return "key:" + std::to_string(i); }
+
+// Hot set requests with Zipf distributed keys, rank 0 is the most popular, noise percent of them
+// goes to unique keys instead
+std::vector<Request> make_trace(size_t requests, size_t keys, double skew, size_t scan_every, size_t scan_length,
+                                unsigned noise) {
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (size_t i = 0; i < keys; i++) {
+        sum += 1.0 / std::pow(double(i + 1), skew);
+        cdf[i] = sum;
+    }
+
+    XorShift rnd(1);
+    std::vector<Request> trace;
+    trace.reserve(requests);
+    uint64_t next_unique_key = keys;
+    for (size_t i = 0; i < requests; i++) {
+        if (scan_every > 0 && i > 0 && i % scan_every == 0) {
+            for (size_t j = 0; j < scan_length; j++) {
+                trace.push_back(Request{make_key(next_unique_key++), true});
+            }
+        }
+
+        if (rnd.next() % 100 < noise) {
+            trace.push_back(Request{make_key(next_unique_key++), true});
+            continue;
+        }
+
+        double r = rnd.uniform() * sum;
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), r) - cdf.begin();
+        trace.push_back(Request{make_key(std::min(rank, keys - 1)), false});
+    }
+    return trace;
+}
+
+// Reads the recorded trace, all its requests count as hot set ones
+std::vector<Request> load_trace(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open trace: " + path);
+    }
+
+    std::vector<Request> trace;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string key;
+        if (ss >> key) {
+            trace.push_back(Request{std::move(key), false});
+        }
+    }
+    return trace;
+}
+
+std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> result;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        result.push_back(item);
+    }
+    return result;
+}
+
+Backend::SimpleLRU::Policy parse_policy(const std::string &name) {
+    if (name == "lru") {
+        return Backend::SimpleLRU::Policy::LRU;
+    } else if (name == "slru") {
+        return Backend::SimpleLRU::Policy::SegmentedLRU;
+    } else if (name == "tinylfu") {
+        return Backend::SimpleLRU::Policy::TinyLFU;
+    }
+    throw std::runtime_error("Unknown eviction policy: " + name);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("runHitRatioBench", "Eviction policy hit ratio benchmark");
+    options.add_options()("policy", "Comma separated eviction policies to run: lru, slru, tinylfu",
+                          cxxopts::value<std::string>()->default_value("lru,slru,tinylfu"));
+    options.add_options()("requests", "Number of hot set requests",
+                          cxxopts::value<size_t>()->default_value("1000000"));
+    options.add_options()("keys", "Number of distinct hot set keys", cxxopts::value<size_t>()->default_value("100000"));
+    options.add_options()("items", "Storage capacity in items of the given value size",
+                          cxxopts::value<size_t>()->default_value("10000"));
+    options.add_options()("skew", "Zipf distribution exponent", cxxopts::value<double>()->default_value("0.99"));
+    options.add_options()("scan-every", "Number of hot set requests between scans, 0 disables scans",
+                          cxxopts::value<size_t>()->default_value("50000"));
+    options.add_options()("scan-length", "Number of keys each scan reads",
+                          cxxopts::value<size_t>()->default_value("20000"));
+    options.add_options()("noise", "Percent of hot set requests replaced with keys requested once",
+                          cxxopts::value<unsigned>()->default_value("0"));
+    options.add_options()("trace", "File with recorded trace to replay instead of the generated one",
+                          cxxopts::value<std::string>());
+    options.add_options()("value-size", "Value size in bytes", cxxopts::value<size_t>()->default_value("100"));
+    options.add_options()("h,help", "Print usage info");
+
+    try {
+        options.parse(argc, argv);
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (options.count("help") > 0) {
+        std::cerr << options.help() << std::endl;
+        return 0;
+    }
+
+    size_t keys = std::max<size_t>(1, options["keys"].as<size_t>());
+    size_t value_size = options["value-size"].as<size_t>();
+    size_t scan_every = options["scan-every"].as<size_t>();
+    size_t scan_length = options["scan-length"].as<size_t>();
+    std::vector<Request> trace;
+    if (options.count("trace") > 0) {
+        trace = load_trace(options["trace"].as<std::string>());
+    } else {
+        trace = make_trace(options["requests"].as<size_t>(), keys, options["skew"].as<double>(), scan_every,
+                           scan_length, options["noise"].as<unsigned>());
+    }
+
+    // Capacity is given in items, so that it doesn't depend on the storage overhead
+    size_t memory = options["items"].as<size_t>() * Backend::SimpleLRU::ItemSize(make_key(keys).size(), value_size);
+
+    std::cout << std::left << std::setw(10) << "policy" << std::setw(14) << "hit ratio"
+              << "hot set hit ratio" << std::endl;
+    for (auto &name : split(options["policy"].as<std::string>())) {
+        Backend::SimpleLRU storage(memory, parse_policy(name));
+        std::string value(value_size, 'v'), out;
+        size_t hits = 0, hot = 0, hot_hits = 0;
+        for (const Request &request : trace) {
+            bool hit = storage.Get(request.key, out);
+            if (!hit) {
+                storage.Put(request.key, value);
+            }
+
+            hits += hit;
+            if (!request.scan) {
+                hot++;
+                hot_hits += hit;
+            }
+        }
+
+        std::cout << std::left << std::setw(10) << name << std::fixed << std::setprecision(4) << std::setw(14)
+                  << double(hits) / trace.size() << double(hot_hits) / std::max<size_t>(1, hot) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,368 @@
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <malloc.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+#include <afina/Storage.h>
+#include <afina/allocator/Slab.h>
+#include <afina/allocator/SmallAlloc.h>
+
+#include "storage/ClockLRU.h"
+#include "storage/FlatLRU.h"
+#include "storage/LockFreeLRU.h"
+#include "storage/SimpleLRU.h"
+#include "storage/StripedLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina;
+
+/**
+ * # Multi-threaded storage throughput benchmark
+ * Preloads storage with given number of keys and then runs a number of threads each executing
+ * a mix of Get and Put on uniformly distributed keys. Prints total throughput for each thread
+ * count, so that scalability of different storages could be compared, e.g:
+ *
+ * runStorageBench --storage mt_lru,clock_lru --threads 1,2,4,8,16 --reads 95
+ *
+ * Along with throughput benchmark reports heap bytes spent per preloaded item, including all
+ * allocator and index overhead. Single threaded storages (st_lru, flat_lru) could be run with
+ * one thread only:
+ *
+ * runStorageBench --storage st_lru,flat_lru --threads 1 --keys 10000000 --value-size 20
+ *
+ * Hardware cache misses per operation are reported too, if the kernel allows to count them, so
+ * that --reads 100 gives misses per Get. Otherwise the column is empty.
+ *
+ * Values of random sizes make heap fragmentation visible, process RSS after the run is reported
+ * for that. LRU storages could take items from slab allocator or keep values in a compacted arena
+ * instead of the heap, LRU storages accessed from many threads could share lock-free small objects
+ * allocator:
+ *
+ * runStorageBench --storage st_lru --threads 1 --reads 0 --max-value-size 4000 --memory 67108864 --allocator slab
+ *
+ * Reads could be issued as multi-key lookups, like get with many keys does, each key counts as an operation:
+ *
+ * runStorageBench --storage mt_lru,striped_lru --batch 100
+ *
+ * Put latency is reported as well, eviction makes it grow once memory limit is less than keys take.
+ * Background eviction keeps free room ahead of writers:
+ *
+ * runStorageBench --storage mt_lru,striped_lru --reads 50 --max-value-size 4000 --memory 4000000 --watermarks 10,30
+ */
+namespace {
+
+// Cheap per thread random generator, so that benchmark doesn't measure rand() lock
+class XorShift {
+public:
+    explicit XorShift(uint64_t seed) : _state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+
+    uint64_t next() {
+        _state ^= _state << 13;
+        _state ^= _state >> 7;
+        _state ^= _state << 17;
+        return _state;
+    }
+
+private:
+    uint64_t _state;
+};
+
+bool is_thread_safe(const std::string &type) { return type != "st_lru" && type != "flat_lru"; }
+
+std::shared_ptr<Storage> make_storage(const std::string &type, size_t memory, size_t stripes,
+                                      const std::string &allocator) {
+    if (allocator == "slab") {
+        std::unique_ptr<Allocator::Slab> slab(new Allocator::Slab(memory));
+        if (type == "st_lru") {
+            return std::make_shared<Backend::SimpleLRU>(std::move(slab));
+        } else if (type == "mt_lru") {
+            return std::make_shared<Backend::ThreadSafeSimpleLRU>(std::move(slab));
+        }
+        throw std::runtime_error("Storage doesn't support slab allocator: " + type);
+    } else if (allocator == "arena") {
+        if (type == "st_lru") {
+            return std::make_shared<Backend::SimpleLRU>(memory, memory);
+        } else if (type == "mt_lru") {
+            return std::make_shared<Backend::ThreadSafeSimpleLRU>(memory, memory);
+        }
+        throw std::runtime_error("Storage doesn't support values arena: " + type);
+    } else if (allocator == "small") {
+        // Pools need some spare slabs on top of the budget, each thread keeps its own ones
+        std::shared_ptr<Allocator::SmallAlloc> items(new Allocator::SmallAlloc(memory + memory / 4));
+        if (type == "st_lru") {
+            return std::make_shared<Backend::SimpleLRU>(memory, items);
+        } else if (type == "mt_lru") {
+            return std::make_shared<Backend::ThreadSafeSimpleLRU>(memory, items);
+        } else if (type == "striped_lru") {
+            return std::make_shared<Backend::StripedLRU>(stripes, memory, items);
+        }
+        throw std::runtime_error("Storage doesn't support small objects allocator: " + type);
+    } else if (allocator != "malloc") {
+        throw std::runtime_error("Unknown allocator: " + allocator);
+    }
+
+    if (type == "st_lru") {
+        return std::make_shared<Backend::SimpleLRU>(memory);
+    } else if (type == "flat_lru") {
+        return std::make_shared<Backend::FlatLRU>(memory);
+    } else if (type == "mt_lru") {
+        return std::make_shared<Backend::ThreadSafeSimpleLRU>(memory);
+    } else if (type == "striped_lru") {
+        return std::make_shared<Backend::StripedLRU>(stripes, memory);
+    } else if (type == "clock_lru") {
+        return std::make_shared<Backend::ClockLRU>(memory);
+    } else if (type == "lockfree_lru") {
+        return std::make_shared<Backend::LockFreeLRU>(memory);
+    }
+    throw std::runtime_error("Unknown storage type: " + type);
+}
+
+// Same as above, thread safe LRU storages get background eviction if watermarks are set
+std::shared_ptr<Storage> make_storage(const std::string &type, size_t memory, size_t stripes,
+                                      const std::string &allocator, size_t low_watermark, size_t high_watermark) {
+    std::shared_ptr<Storage> storage = make_storage(type, memory, stripes, allocator);
+    if (auto lru = std::dynamic_pointer_cast<Backend::ThreadSafeSimpleLRU>(storage)) {
+        lru->SetWatermarks(low_watermark, high_watermark);
+    } else if (auto striped = std::dynamic_pointer_cast<Backend::StripedLRU>(storage)) {
+        striped->SetWatermarks(low_watermark, high_watermark);
+    }
+    storage->Start();
+    return storage;
+}
+
+std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> result;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        result.push_back(item);
+    }
+    return result;
+}
+
+std::string make_key(size_t i) { return "key:" + std::to_string(i); }
+
+// Heap bytes in use, including large blocks served by mmap
+size_t heap_size() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// Resident set size of the process in bytes
+size_t rss() {
+    size_t pages = 0, resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Counts hardware cache misses of the process, threads started after the counter included
+class CacheMisses {
+public:
+    CacheMisses() {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    ~CacheMisses() {
+        if (_fd >= 0) {
+            close(_fd);
+        }
+    }
+
+    // Number of misses so far, negative if the counter is unavailable
+    double read() const {
+        uint64_t count = 0;
+        if (_fd < 0 || ::read(_fd, &count, sizeof(count)) != sizeof(count)) {
+            return -1;
+        }
+        return double(count);
+    }
+
+private:
+    int _fd;
+};
+
+// Runs workload on the given storage, returns number of operations per second, 99th percentile
+// of Put latency in microseconds and cache misses per operation, negative if they can't be counted
+double run(Storage &storage, size_t threads_count, size_t ops, size_t keys, unsigned reads, size_t value_size,
+           size_t max_value_size, size_t batch, double &put_p99, double &misses) {
+    CacheMisses counter;
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    std::vector<std::vector<float>> put_latencies(threads_count);
+    for (size_t t = 0; t < threads_count; t++) {
+        threads.emplace_back([&, t]() {
+            XorShift rnd(t + 1);
+            std::string value, new_value(max_value_size, 'v');
+            std::vector<Storage::Entry> entries(batch);
+            std::vector<Storage::Entry *> pointers(batch);
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+
+            for (size_t i = 0; i < ops; i++) {
+                uint64_t r = rnd.next();
+                std::string key = make_key(r % keys);
+                if ((r >> 32) % 100 < reads && batch > 1) {
+                    for (size_t j = 0; j < batch; j++) {
+                        entries[j].key = make_key(rnd.next() % keys);
+                        pointers[j] = &entries[j];
+                    }
+                    storage.MultiGet(pointers.data(), batch);
+                    i += batch - 1;
+                } else if ((r >> 32) % 100 < reads) {
+                    storage.Get(key, value);
+                } else {
+                    size_t size = value_size + (r >> 16) % (max_value_size - value_size + 1);
+                    std::string put_value = new_value.substr(0, size);
+                    auto put_begin = std::chrono::steady_clock::now();
+                    storage.Put(key, put_value);
+                    std::chrono::duration<float, std::micro> put_time = std::chrono::steady_clock::now() - put_begin;
+                    put_latencies[t].push_back(put_time.count());
+                }
+            }
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    double misses_before = counter.read();
+    start.store(true);
+    for (auto &t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    misses = misses_before < 0 ? -1 : (counter.read() - misses_before) / (threads_count * ops);
+
+    std::vector<float> all;
+    for (auto &latencies : put_latencies) {
+        all.insert(all.end(), latencies.begin(), latencies.end());
+    }
+    put_p99 = 0;
+    if (!all.empty()) {
+        auto p99 = all.begin() + all.size() * 99 / 100;
+        std::nth_element(all.begin(), p99, all.end());
+        put_p99 = *p99;
+    }
+    return (threads_count * ops) / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("runStorageBench", "Storage throughput benchmark");
+    options.add_options()("storage", "Comma separated storage types to run",
+                          cxxopts::value<std::string>()->default_value("mt_lru,striped_lru,clock_lru,lockfree_lru"));
+    options.add_options()("threads", "Comma separated thread counts",
+                          cxxopts::value<std::string>()->default_value("1,2,4,8,16"));
+    options.add_options()("ops", "Operations per thread", cxxopts::value<size_t>()->default_value("1000000"));
+    options.add_options()("keys", "Number of distinct keys", cxxopts::value<size_t>()->default_value("100000"));
+    options.add_options()("reads", "Percent of Get operations", cxxopts::value<unsigned>()->default_value("95"));
+    options.add_options()("value-size", "Value size in bytes", cxxopts::value<size_t>()->default_value("100"));
+    options.add_options()("max-value-size", "Values written during the run have random size up to that",
+                          cxxopts::value<size_t>()->default_value("0"));
+    options.add_options()("stripes", "Number of shards for striped storages",
+                          cxxopts::value<size_t>()->default_value("16"));
+    options.add_options()("memory", "Storage memory limit in bytes, enough for all keys by default",
+                          cxxopts::value<size_t>()->default_value("0"));
+    options.add_options()("allocator", "Items allocator for LRU storages: malloc, slab, arena, small",
+                          cxxopts::value<std::string>()->default_value("malloc"));
+    options.add_options()("batch", "Number of keys looked up at once by each read",
+                          cxxopts::value<size_t>()->default_value("1"));
+    options.add_options()("watermarks", "Background eviction of mt_lru and striped_lru: LOW,HIGH percents of free memory",
+                          cxxopts::value<std::string>()->default_value("0,0"));
+    options.add_options()("h,help", "Print usage info");
+
+    try {
+        options.parse(argc, argv);
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (options.count("help") > 0) {
+        std::cerr << options.help() << std::endl;
+        return 0;
+    }
+
+    size_t ops = options["ops"].as<size_t>();
+    size_t keys = options["keys"].as<size_t>();
+    unsigned reads = options["reads"].as<unsigned>();
+    size_t value_size = options["value-size"].as<size_t>();
+    size_t max_value_size = std::max(value_size, options["max-value-size"].as<size_t>());
+    size_t stripes = options["stripes"].as<size_t>();
+    std::string allocator = options["allocator"].as<std::string>();
+    size_t batch = std::max<size_t>(1, options["batch"].as<size_t>());
+    std::vector<std::string> watermarks = split(options["watermarks"].as<std::string>());
+    if (watermarks.size() != 2) {
+        std::cerr << "Error: watermarks must be LOW,HIGH" << std::endl;
+        return 1;
+    }
+    size_t low_watermark = std::stoul(watermarks[0]), high_watermark = std::stoul(watermarks[1]);
+
+    // Enough room for all keys by default, so that benchmark measures access path but not eviction
+    size_t memory = options["memory"].as<size_t>();
+    if (memory == 0) {
+        memory = 2 * keys * (make_key(keys).size() + (value_size + max_value_size) / 2);
+    }
+
+    std::cout << std::left << std::setw(16) << "storage" << std::setw(10) << "threads" << std::setw(14)
+              << "bytes/item" << std::setw(14) << "ops/sec" << std::setw(14) << "put p99 us" << std::setw(10)
+              << "rss MB"
+              << "misses/op" << std::endl;
+    for (auto &type : split(options["storage"].as<std::string>())) {
+        for (auto &threads : split(options["threads"].as<std::string>())) {
+            size_t threads_count = std::stoul(threads);
+            if (threads_count > 1 && !is_thread_safe(type)) {
+                continue;
+            }
+
+            size_t heap_before = heap_size();
+            auto storage = make_storage(type, memory, stripes, allocator, low_watermark, high_watermark);
+            std::string value(value_size, 'v');
+            for (size_t i = 0; i < keys; i++) {
+                storage->Put(make_key(i), value);
+            }
+            double per_item = double(heap_size() - heap_before) / keys;
+
+            double put_p99, misses;
+            double rate =
+                run(*storage, threads_count, ops, keys, reads, value_size, max_value_size, batch, put_p99, misses);
+            std::cout << std::left << std::setw(16) << type << std::setw(10) << threads << std::fixed
+                      << std::setprecision(1) << std::setw(14) << per_item << std::setprecision(0) << std::setw(14)
+                      << rate << std::setprecision(1) << std::setw(14) << put_p99 << std::setw(10)
+                      << rss() / (1024 * 1024);
+            if (misses >= 0) {
+                std::cout << std::setprecision(2) << misses;
+            }
+            std::cout << std::endl;
+            storage->Stop();
+        }
+    }
+
+    return 0;
+}
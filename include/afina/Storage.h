@@ -1,6 +1,8 @@
 #ifndef AFINA_STORAGE_H
 #define AFINA_STORAGE_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 namespace Afina {
@@ -10,6 +12,18 @@ namespace Afina {
  */
 class Storage {
 public:
+    /**
+     * Key and result of the multi-key lookup, see MultiGet
+     */
+    struct Entry {
+        std::string key;
+        bool found;
+
+        // Value is copied unless it is shared, see Lookup
+        std::string value;
+        std::shared_ptr<const std::string> shared;
+    };
+
     Storage() {}
     virtual ~Storage() {}
 
@@ -30,6 +44,22 @@ public:
      */
     virtual bool Put(const std::string &key, const std::string &value) = 0;
 
+    /**
+     * Same as above, but the association expires in ttl seconds, zero ttl
+     * means it never does. Once association expires storage behaves as if
+     * it was deleted.
+     *
+     * Default implementation doesn't support expiration: with non-zero ttl
+     * it returns false and changes nothing, so ttl is never silently dropped
+     *
+     * @param key to be associated with value
+     * @param value to be assigned for the key
+     * @param ttl number of seconds association lives
+     */
+    virtual bool Put(const std::string &key, const std::string &value, uint32_t ttl) {
+        return ttl == 0 && Put(key, value);
+    }
+
     /**
      * Stores association between given key/value pair if key isn't present in
      * storage.
@@ -43,19 +73,35 @@ public:
      */
     virtual bool PutIfAbsent(const std::string &key, const std::string &value) = 0;
 
+    /**
+     * Same as above, but the association expires in ttl seconds, see Put.
+     * Expired association counts as absent one
+     */
+    virtual bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) {
+        return ttl == 0 && PutIfAbsent(key, value);
+    }
+
     /**
      * Updates existing association between given key/value pair
      * If requested key doesn't present in storage method returns false and
      * doesnt change anything.
      *
      * If given key found then existing association gets update to point to
-     * the given value.
+     * the given value. Association expires at the same time as before.
      *
      * @param key to be associated with value
      * @param value to be assigned for the key
      */
     virtual bool Set(const std::string &key, const std::string &value) = 0;
 
+    /**
+     * Same as above, but the association expires in ttl seconds from now on,
+     * see Put
+     */
+    virtual bool Set(const std::string &key, const std::string &value, uint32_t ttl) {
+        return ttl == 0 && Set(key, value);
+    }
+
     /**
      * Removes association for the given key
      * If requested key doesn't present in storage method returns false and
@@ -84,6 +130,73 @@ public:
      * @param value output parameter to copy value to
      */
     virtual bool Get(const std::string &key, std::string &value) const = 0;
+
+    /**
+     * Retrive value for the given key as an immutable shared buffer
+     * Buffer stays valid and unchanged after the association gets updated or
+     * deleted, so value could be sent to the client without copying it.
+     *
+     * In case if given key not found method returns false and doesn't perform
+     * any changes on the output parameter. Default implementation copies value
+     * into a new buffer
+     *
+     * @param key to retrive value for
+     * @param value output parameter to store buffer to
+     */
+    virtual bool GetShared(const std::string &key, std::shared_ptr<const std::string> &value) const {
+        auto copy = std::make_shared<std::string>();
+        if (!Get(key, *copy)) {
+            return false;
+        }
+        value = std::move(copy);
+        return true;
+    }
+
+    /**
+     * Retrive value for the given key either copying it or as an immutable
+     * shared buffer, whichever is cheaper for the storage. Value is copied
+     * into the value parameter if the shared one is left unset
+     *
+     * In case if given key not found method returns false and doesn't perform
+     * any changes on the output parameters. Default implementation always copies
+     *
+     * @param key to retrive value for
+     * @param value output parameter to copy value to
+     * @param shared output parameter to store buffer to
+     */
+    virtual bool Lookup(const std::string &key, std::string &value, std::shared_ptr<const std::string> &shared) const {
+        return Get(key, value);
+    }
+
+    /**
+     * Retrive values for a number of keys at once
+     * Same as Lookup called for each entry, but storage could take its locks
+     * once per batch and overlap memory accesses of different keys. Entries
+     * could be reordered, so that keys sharing a lock go together.
+     *
+     * @param entries keys to retrive values for, found flag and value are set
+     * for each of them
+     * @param count number of entries
+     */
+    virtual void MultiGet(Entry **entries, size_t count) const {
+        for (size_t i = 0; i < count; i++) {
+            Entry &entry = *entries[i];
+            entry.shared.reset();
+            entry.found = Lookup(entry.key, entry.value, entry.shared);
+        }
+    }
+
+    /**
+     * Changes memory limit of the storage at runtime. Once the new limit is
+     * less than memory in use, items are evicted gradually by the following
+     * operations rather than all at once.
+     *
+     * Default implementation keeps the limit as is
+     *
+     * @param max_size new memory limit in bytes
+     * @return false if storage doesn't support resizing
+     */
+    virtual bool Resize(size_t max_size) { return false; }
 };
 
 } // namespace Afina
@@ -0,0 +1,87 @@
+#ifndef AFINA_ALLOCATOR_ARENA_H
+#define AFINA_ALLOCATOR_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * Source of equal sized and aligned memory slabs, bottom level of Arena -> SlabCache -> MemPool
+ * hierarchy.
+ *
+ * Arena reserves continuous range of virtual memory up to the given limit once, physical memory is
+ * taken by the system on the first touch. Slabs are handed out from the reserved range and returned
+ * ones are kept in a lock-free stack, so any number of threads could map/unmap slabs concurrently
+ * without locks. Slabs are aligned by their size, so that any address inside of a slab could be
+ * turned into the slab address by masking lower bits.
+ */
+class Arena {
+public:
+    /**
+     * @param limit maximum number of bytes in all slabs
+     * @param slab_size size of each slab, power of two not less than system page
+     */
+    Arena(size_t limit, size_t slab_size = 64 * 1024);
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * Returns new slab or nullptr if the limit is reached. Thread safe
+     */
+    void *map();
+
+    /**
+     * Returns slab back to the arena. Thread safe
+     */
+    void unmap(void *slab);
+
+    /**
+     * Size of each slab
+     */
+    size_t slab_size() const { return _slab_size; }
+
+    /**
+     * Address of the slab given address belongs to
+     */
+    void *slab_of(const void *p) const {
+        return reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(p) & ~(uintptr_t(_slab_size) - 1));
+    }
+
+    /**
+     * Checks if the address belongs to one of arena slabs
+     */
+    bool contains(const void *p) const {
+        return _base <= static_cast<const char *>(p) && static_cast<const char *>(p) < _base + _slabs * _slab_size;
+    }
+
+private:
+    // Slabs are numbered from 1 in the free stack, so that 0 means empty one
+    char *slab(uint32_t index) const { return _base + size_t(index - 1) * _slab_size; }
+    std::atomic<uint32_t> &next(uint32_t index) const {
+        return *reinterpret_cast<std::atomic<uint32_t> *>(slab(index));
+    }
+
+    const size_t _slab_size;
+    const uint32_t _slabs;
+
+    // Reserved range, _base is aligned by slab size
+    void *_region;
+    size_t _region_size;
+    char *_base;
+
+    // Number of slabs ever handed out, they are taken in order
+    std::atomic<uint32_t> _used;
+
+    // Stack of returned slabs: ABA counter in the high half and slab number in the low one
+    std::atomic<uint64_t> _free;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_ARENA_H
@@ -0,0 +1,120 @@
+#ifndef AFINA_ALLOCATOR_MEM_POOL_H
+#define AFINA_ALLOCATOR_MEM_POOL_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Afina {
+namespace Allocator {
+
+class Arena;
+
+/**
+ * Thread safe pool of fixed size objects, top level of Arena -> SlabCache -> MemPool hierarchy.
+ *
+ * Each thread works with its own set of slabs taken from the arena through private slab cache,
+ * so allocation and free of objects allocated by the same thread take no locks and no atomic
+ * operations at all. Object freed by another thread is pushed to lock-free list of its slab and
+ * the slab is queued to the owner thread, owner takes such objects back once its own slabs run
+ * out.
+ *
+ * Thread state is created on the first pool access from the thread and is handed over to the next
+ * new thread once its owner exits, objects allocated by dead threads could be freed as usual.
+ *
+ * Pool must outlive all threads working with it, destruction returns all slabs back to the arena
+ * regardless of objects still allocated.
+ */
+class MemPool {
+public:
+    /**
+     * @param arena source of slabs
+     * @param object_size size of each object, must leave room for a few objects in a slab
+     */
+    MemPool(Arena &arena, size_t object_size);
+    ~MemPool();
+
+    MemPool(const MemPool &) = delete;
+    MemPool &operator=(const MemPool &) = delete;
+
+    /**
+     * Returns object_size bytes, nullptr if arena is exhausted
+     */
+    void *alloc();
+
+    /**
+     * Returns object back to the pool, could be called from any thread
+     */
+    void free(void *p);
+
+    /**
+     * Allocates object and constructs T there, nullptr if there is no memory
+     */
+    template <typename T, typename... Args> T *create(Args &&... args) {
+        assert(sizeof(T) <= _object_size);
+        void *p = alloc();
+        if (p == nullptr) {
+            return nullptr;
+        }
+
+        try {
+            return new (p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            free(p);
+            throw;
+        }
+    }
+
+    /**
+     * Destroys object created by create() and returns memory back
+     */
+    template <typename T> void destroy(T *p) {
+        p->~T();
+        free(p);
+    }
+
+    size_t object_size() const { return _object_size; }
+
+private:
+    struct slab;
+    struct local;
+
+    // State of the calling thread
+    local *Local();
+    local *Attach();
+
+    slab *NewSlab(local *l);
+    void *Take(slab *s);
+    void LocalFree(local *l, slab *s, void *p);
+    void RemoteFree(slab *s, void *p);
+
+    // Puts slab to the partial list or releases it once objects were returned
+    void Settle(local *l, slab *s);
+
+    // Moves objects freed by other threads back to their slabs
+    void Collect(local *l);
+
+    Arena &_arena;
+    const size_t _object_size;
+
+    // Offset of the first object in a slab
+    const size_t _first;
+
+    // Identity of the pool in thread local lookup table
+    uint32_t _id;
+    uint64_t _generation;
+
+    // States of all threads ever worked with pool
+    std::mutex _locals_mutex;
+    std::vector<std::unique_ptr<local>> _locals;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_MEM_POOL_H
@@ -0,0 +1,94 @@
+#ifndef AFINA_ALLOCATOR_MEMORY_RESOURCE_H
+#define AFINA_ALLOCATOR_MEMORY_RESOURCE_H
+
+#include <cstddef>
+
+namespace Afina {
+namespace Allocator {
+
+class Slab;
+class SmallAlloc;
+
+/**
+ * Polymorphic source of memory for containers, the same as std::pmr::memory_resource that isn't
+ * available in C++11. Containers keep a pointer to resource rather than a copy, so resource must
+ * outlive every container using it.
+ *
+ * Alignments up to alignof(std::max_align_t) are supported by all resources here, allocation
+ * failure is reported by std::bad_alloc as standard containers expect.
+ */
+class MemoryResource {
+public:
+    virtual ~MemoryResource() {}
+
+    void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        return do_allocate(bytes, alignment);
+    }
+
+    void deallocate(void *p, size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        do_deallocate(p, bytes, alignment);
+    }
+
+    /**
+     * Memory allocated from one resource could be released to another
+     */
+    bool is_equal(const MemoryResource &other) const noexcept { return this == &other || do_is_equal(other); }
+
+protected:
+    virtual void *do_allocate(size_t bytes, size_t alignment) = 0;
+    virtual void do_deallocate(void *p, size_t bytes, size_t alignment) = 0;
+    virtual bool do_is_equal(const MemoryResource &other) const noexcept { return false; }
+};
+
+/**
+ * Global heap, operator new/delete
+ */
+MemoryResource *new_delete_resource() noexcept;
+
+/**
+ * Resource used by StlAllocator constructed without one, new_delete_resource() unless changed
+ */
+MemoryResource *get_default_resource() noexcept;
+
+/**
+ * Replaces default resource, nullptr restores new_delete_resource(). Returns previous one
+ */
+MemoryResource *set_default_resource(MemoryResource *r) noexcept;
+
+/**
+ * Takes memory from the slab allocator, requests larger than slab page size can't be satisfied.
+ * Single threaded as the allocator is
+ */
+class SlabResource : public MemoryResource {
+public:
+    explicit SlabResource(Slab &slab) : _slab(slab) {}
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const MemoryResource &other) const noexcept override;
+
+private:
+    Slab &_slab;
+};
+
+/**
+ * Takes memory from the thread safe small objects allocator, large requests go to the heap
+ */
+class SmallAllocResource : public MemoryResource {
+public:
+    explicit SmallAllocResource(SmallAlloc &small) : _small(small) {}
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const MemoryResource &other) const noexcept override;
+
+private:
+    SmallAlloc &_small;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_MEMORY_RESOURCE_H
@@ -7,6 +7,15 @@ namespace Allocator {
 // to avoid expensive macros calculations and increase compile speed
 class Simple;
 
+/**
+ * Handle to the memory block allocated by Allocator::Simple.
+ *
+ * Allocator could move blocks, so pointer refers to a handle slot owned by the allocator rather
+ * than to a block itself. Slot always contains the actual block address, so get() result must not
+ * be kept across calls that could move blocks: alloc, realloc and defrag.
+ *
+ * Copies refer to the same block. Default constructed or freed pointer is empty, get() returns nullptr
+ */
 class Pointer {
 public:
     Pointer();
@@ -17,7 +26,15 @@ public:
     Pointer &operator=(const Pointer &);
     Pointer &operator=(Pointer &&);
 
-    void *get() const { return 0; }
+    void *get() const { return _handle != nullptr ? *_handle : nullptr; }
+
+private:
+    friend class Simple;
+
+    explicit Pointer(void **handle);
+
+    // Slot in the allocator handle table
+    void **_handle;
 };
 
 } // namespace Allocator
@@ -0,0 +1,72 @@
+#ifndef AFINA_ALLOCATOR_REGION_H
+#define AFINA_ALLOCATOR_REGION_H
+
+#include <cstddef>
+
+#include <afina/allocator/MemoryResource.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * Bump allocator for short living objects, e.g everything created while a single request is
+ * processed. Memory is taken by moving a pointer through chunks, deallocate does nothing except
+ * for the most recent block, and everything is released at once by reset().
+ *
+ * Chunks are taken from the heap on demand and kept until the region is destroyed, so once
+ * the region has seen the largest request all following ones take no memory from the system.
+ *
+ * That is NOT thread safe, region is supposed to be owned by a single connection.
+ */
+class Region : public MemoryResource {
+public:
+    /**
+     * @param chunk_size size of memory block taken from the heap at once, larger requests get
+     * a chunk of their own
+     */
+    explicit Region(size_t chunk_size = 4096);
+    ~Region();
+
+    Region(const Region &) = delete;
+    Region &operator=(const Region &) = delete;
+
+    /**
+     * Makes all memory available again, every object allocated before must be already destroyed
+     */
+    void reset();
+
+    /**
+     * Number of bytes taken from the heap
+     */
+    size_t capacity() const { return _capacity; }
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+
+private:
+    struct chunk {
+        chunk *next;
+        size_t size;
+    };
+
+    // Moves to the next chunk having at least bytes available, takes a new one if there is no such
+    void NextChunk(size_t bytes);
+
+    const size_t _chunk_size;
+
+    // All chunks, the ones before the current one are used
+    chunk *_first;
+    chunk *_current;
+
+    // Free part of the current chunk
+    char *_top;
+    char *_end;
+
+    size_t _capacity;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_REGION_H
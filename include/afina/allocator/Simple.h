@@ -18,44 +18,93 @@ class Pointer;
  * Allocator instance doesn't take ownership of wrapped memmory and do not delete it
  * on destruction. So caller must take care of resource cleaup after allocator stop
  * being needs
+ *
+ * Blocks are placed one after another from the beginning of the area, each one is prefixed
+ * by a header with block size and a back reference to the handle slot. Handle table grows down
+ * from the end of the area. Freed blocks are kept in power of two size bins, so that a fitting one
+ * is found in constant time. defrag() moves all alive blocks
+ * to the beginning of the area and fixes their handles, so all free memory becomes one piece.
+ *
+ * Because blocks move, raw addresses can't be handed out to standard containers, see
+ * MemoryResource.h and StlAllocator.h for resources containers could work with.
  */
-// TODO: Implements interface to allow usage as C++ allocators
 class Simple {
 public:
     Simple(void *base, const size_t size);
 
     /**
-     * TODO: semantics
+     * Allocates block of at least N bytes, throws AllocError(NoMemory) if there is no continuous
+     * free space of that size. Call defrag() to collect free space together
      * @param N size_t
      */
     Pointer alloc(size_t N);
 
     /**
-     * TODO: semantics
+     * Changes block size keeping its content up to the minimum of old and new sizes. Block is
+     * resized in place if possible, otherwise it is moved and p keeps pointing to it. Empty p
+     * gets a new block. If there is no memory then AllocError(NoMemory) thrown and p is left as is
      * @param p Pointer
      * @param N size_t
      */
     void realloc(Pointer &p, size_t N);
 
     /**
-     * TODO: semantics
+     * Releases block and makes p empty, other copies of p become invalid. Empty p is ignored,
+     * AllocError(InvalidFree) thrown if p doesn't refer to an alive block of this allocator
      * @param p Pointer
      */
     void free(Pointer &p);
 
     /**
-     * TODO: semantics
+     * Moves all alive blocks to the beginning of the area, so that all free space could be used
+     * by a single allocation. Invalidates addresses previously returned by Pointer::get()
      */
     void defrag();
 
     /**
-     * TODO: semantics
+     * Number of free bytes in the area, including space in between of blocks which is only
+     * available after defrag() for large allocations
+     */
+    size_t available() const;
+
+    /**
+     * Human readable list of blocks
      */
     std::string dump() const;
 
 private:
+    struct block;
+
+    // Handle slot management, free slots are linked through themselves
+    void **take_slot();
+    void release_slot(void **slot);
+
+    // Returns block the pointer refers to or throws InvalidFree
+    block *checked_block(const Pointer &p) const;
+
+    // Splits tail of the block into a separate free one if it is big enough
+    void shrink(block *b, size_t size);
+
+    // Puts block to the free bin or gives it back to the top
+    void release(block *b);
+
     void *_base;
     const size_t _base_len;
+
+    // Blocks area: [_begin, _top), everything above up to _table is free
+    char *_begin;
+    char *_top;
+
+    // Handle table: [_table, _end)
+    void **_table;
+    void **_end;
+
+    void **_free_slots;
+
+    // Free blocks of size [2^i, 2^(i+1)) in bin i
+    static constexpr size_t kBins = 8 * sizeof(size_t);
+    block *_free_blocks[kBins];
+    size_t _free_bytes;
 };
 
 } // namespace Allocator
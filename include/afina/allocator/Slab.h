@@ -0,0 +1,110 @@
+#ifndef AFINA_ALLOCATOR_SLAB_H
+#define AFINA_ALLOCATOR_SLAB_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * Slab allocator with geometric size classes.
+ *
+ * Memory is taken from the system by pages of fixed size, up to the given limit. Each page is
+ * assigned to a single size class once and then split into equal chunks of that class, chunk sizes
+ * grow by the given factor starting from the minimal one, the largest chunk is the whole page.
+ * Pages are never returned back or moved between classes, so once the limit is reached each
+ * class could only reuse chunks freed before.
+ *
+ * Because any request is rounded up to the chunk size and freed chunks are reused by the same class
+ * only, allocator doesn't fragment under random size churn: memory footprint is bounded by the limit.
+ */
+class Slab {
+public:
+    /**
+     * @param limit maximum number of bytes allocator takes from the system, must be enough for at
+     * least one page
+     * @param page_size size of memory block assigned to a class at once, also a maximum allocation size
+     * @param factor growth factor between neighbour size classes, must be greater than 1
+     * @param min_chunk size of the smallest class
+     */
+    Slab(size_t limit, size_t page_size = 1024 * 1024, double factor = 1.25, size_t min_chunk = 64);
+    ~Slab();
+
+    Slab(const Slab &) = delete;
+    Slab &operator=(const Slab &) = delete;
+
+    /**
+     * Returns chunk of the smallest class that fits N bytes. If there are no free chunks in that
+     * class and no more pages could be taken from the system then nullptr returns, caller could free
+     * something of the same class and retry.
+     *
+     * Requests larger than page size are never satisfied.
+     */
+    void *alloc(size_t N);
+
+    /**
+     * Returns chunk back to its class. N must be the same size that was passed to alloc
+     */
+    void free(void *p, size_t N);
+
+    /**
+     * Number of size classes
+     */
+    size_t classes() const { return _classes.size(); }
+
+    /**
+     * Class index for N bytes allocation, classes() if N is larger than any chunk
+     */
+    size_t class_of(size_t N) const;
+
+    /**
+     * Actual number of bytes available in the chunk of given class
+     */
+    size_t chunk_size(size_t cls) const { return _classes[cls].chunk_size; }
+
+    /**
+     * Largest allocation allocator could satisfy
+     */
+    size_t max_size() const { return _page_size; }
+
+    /**
+     * Maximum number of bytes allocator takes from the system
+     */
+    size_t limit() const { return _max_pages * _page_size; }
+
+    /**
+     * Human readable per class statistics
+     */
+    std::string dump() const;
+
+private:
+    struct size_class {
+        size_t chunk_size;
+
+        // Chunks returned by free, linked through their first word
+        void *free_list;
+
+        // Not yet used tail of the last page taken by the class
+        char *page_end;
+        size_t page_left;
+
+        // Statistics
+        size_t pages;
+        size_t used;
+    };
+
+    const size_t _page_size;
+    const size_t _max_pages;
+
+    std::vector<size_class> _classes;
+
+    // All pages taken from the system
+    std::vector<char *> _pages;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_SLAB_H
@@ -0,0 +1,53 @@
+#ifndef AFINA_ALLOCATOR_SLAB_CACHE_H
+#define AFINA_ALLOCATOR_SLAB_CACHE_H
+
+#include <cstddef>
+
+namespace Afina {
+namespace Allocator {
+
+class Arena;
+
+/**
+ * Small stash of empty slabs in front of the arena, so that a pool which allocates and releases
+ * a slab back and forth doesn't hit shared arena each time.
+ *
+ * That is NOT thread safe, each cache is supposed to be used by a single thread.
+ */
+class SlabCache {
+public:
+    /**
+     * @param arena source of slabs
+     * @param keep maximum number of empty slabs kept locally
+     */
+    SlabCache(Arena &arena, size_t keep = 2);
+    ~SlabCache();
+
+    SlabCache(const SlabCache &) = delete;
+    SlabCache &operator=(const SlabCache &) = delete;
+
+    /**
+     * Returns empty slab, nullptr if arena is exhausted
+     */
+    void *get();
+
+    /**
+     * Takes slab back, extra ones go to the arena
+     */
+    void put(void *slab);
+
+    Arena &arena() const { return _arena; }
+
+private:
+    Arena &_arena;
+    const size_t _keep;
+
+    // Cached slabs are linked through their first word
+    void *_slabs;
+    size_t _count;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_SLAB_CACHE_H
@@ -0,0 +1,58 @@
+#ifndef AFINA_ALLOCATOR_SMALL_ALLOC_H
+#define AFINA_ALLOCATOR_SMALL_ALLOC_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/MemPool.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * Thread safe general purpose allocator on top of the set of memory pools with geometric size
+ * classes sharing the same arena. Requests larger than the largest class go to the global heap.
+ */
+class SmallAlloc {
+public:
+    /**
+     * @param limit maximum number of bytes taken by pools
+     * @param slab_size arena slab size, largest class is a quarter of it
+     * @param factor growth factor between neighbour size classes, must be greater than 1
+     * @param min_object size of the smallest class
+     */
+    SmallAlloc(size_t limit, size_t slab_size = 64 * 1024, double factor = 1.25, size_t min_object = 32);
+
+    SmallAlloc(const SmallAlloc &) = delete;
+    SmallAlloc &operator=(const SmallAlloc &) = delete;
+
+    /**
+     * Returns at least N bytes, nullptr if the pool of that size has run out of arena
+     */
+    void *alloc(size_t N);
+
+    /**
+     * Returns memory back, N must be the same size that was passed to alloc. Could be called from
+     * any thread
+     */
+    void free(void *p, size_t N);
+
+    /**
+     * Largest size served by pools
+     */
+    size_t max_size() const { return _pools.back()->object_size(); }
+
+private:
+    MemPool *PoolOf(size_t N) const;
+
+    // Pools use the arena, so it is destroyed last
+    Arena _arena;
+    std::vector<std::unique_ptr<MemPool>> _pools;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_SMALL_ALLOC_H
@@ -0,0 +1,59 @@
+#ifndef AFINA_ALLOCATOR_STL_ALLOCATOR_H
+#define AFINA_ALLOCATOR_STL_ALLOCATOR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <afina/allocator/MemoryResource.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * Standard allocator taking memory from the given resource, so that standard containers could be
+ * pointed at afina allocators, e.g:
+ *
+ * SlabResource resource(slab);
+ * std::vector<int, StlAllocator<int>> v(StlAllocator<int>(&resource));
+ *
+ * Allocator is just a pointer to the resource, copies of the container keep the same resource,
+ * while assignment and swap keep resources of the containers as they are.
+ */
+template <typename T> class StlAllocator {
+public:
+    using value_type = T;
+
+    StlAllocator() noexcept : _resource(get_default_resource()) {}
+    StlAllocator(MemoryResource *resource) noexcept : _resource(resource ? resource : get_default_resource()) {}
+
+    template <typename U> StlAllocator(const StlAllocator<U> &other) noexcept : _resource(other.resource()) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(_resource->allocate(n * sizeof(T), alignof(T))); }
+
+    void deallocate(T *p, size_t n) { _resource->deallocate(p, n * sizeof(T), alignof(T)); }
+
+    MemoryResource *resource() const noexcept { return _resource; }
+
+private:
+    MemoryResource *_resource;
+};
+
+template <typename T, typename U> bool operator==(const StlAllocator<T> &a, const StlAllocator<U> &b) noexcept {
+    return a.resource()->is_equal(*b.resource());
+}
+
+template <typename T, typename U> bool operator!=(const StlAllocator<T> &a, const StlAllocator<U> &b) noexcept {
+    return !(a == b);
+}
+
+/**
+ * Commonly used containers over the resource
+ */
+using String = std::basic_string<char, std::char_traits<char>, StlAllocator<char>>;
+template <typename T> using Vector = std::vector<T, StlAllocator<T>>;
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_STL_ALLOCATOR_H
@@ -0,0 +1,59 @@
+#ifndef AFINA_CONCURRENCY_ALIGNED_ARRAY_H
+#define AFINA_CONCURRENCY_ALIGNED_ARRAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Fixed size array of over-aligned elements
+ * Type declared with alignas(64) keeps each element on its own cache line, but C++11 new doesn't respect
+ * alignment above the fundamental one, so array allocated by new[] could start in the middle of a line.
+ * This array takes one element more memory and places elements at the alignment of the type.
+ *
+ * Elements are default constructed in order and destroyed along with array, they never move
+ */
+template <typename T> class AlignedArray {
+public:
+    explicit AlignedArray(size_t size) : _memory(new char[(size + 1) * sizeof(T)]), _size(0) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(_memory.get());
+        _data = reinterpret_cast<T *>((address + alignof(T) - 1) & ~uintptr_t(alignof(T) - 1));
+        try {
+            for (; _size < size; _size++) {
+                new (&_data[_size]) T();
+            }
+        } catch (...) {
+            Destroy();
+            throw;
+        }
+    }
+    ~AlignedArray() { Destroy(); }
+
+    T &operator[](size_t i) { return _data[i]; }
+    const T &operator[](size_t i) const { return _data[i]; }
+
+    size_t size() const { return _size; }
+
+private:
+    AlignedArray(const AlignedArray &) = delete;
+    AlignedArray &operator=(const AlignedArray &) = delete;
+
+    void Destroy() {
+        while (_size > 0) {
+            _data[--_size].~T();
+        }
+    }
+
+    std::unique_ptr<char[]> _memory;
+    T *_data;
+    size_t _size;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_ALIGNED_ARRAY_H
@@ -0,0 +1,64 @@
+#ifndef AFINA_CONCURRENCY_EPOCH_H
+#define AFINA_CONCURRENCY_EPOCH_H
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Epoch based memory reclamation
+ * Lets readers traverse shared nodes without any locks while writers unlink and free them. Reader
+ * wraps all accesses to shared nodes with Epoch::Guard. Writer unlinks node, so that no new reader
+ * could reach it, and passes it to Retire, node is freed once every thread which could have seen it
+ * leaves its guard.
+ *
+ * There is a global epoch counter, each thread announces the epoch it has seen on entering the guard.
+ * Counter moves forward only when all threads inside guards have announced its current value, so
+ * node retired at epoch E is unreachable for everyone once the counter gets to E + 2. Nodes are kept
+ * in per-thread lists and freed by the retiring thread itself, nothing is shared but the counter
+ * and the list of announcements. Nodes not safe to free yet when their thread exits are moved to a
+ * global list, any thread moving the epoch forward frees them later.
+ *
+ * Thread stuck inside a guard stops reclamation, so guards must be short and never block.
+ */
+class Epoch {
+public:
+    /**
+     * Scope of the thread accessing shared nodes, guards could be nested
+     */
+    class Guard {
+    public:
+        Guard() { Enter(); }
+        ~Guard() { Leave(); }
+
+    private:
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+    };
+
+    static void Enter();
+    static void Leave();
+
+    /**
+     * Frees node with the given function once no thread could access it. Node must be unreachable
+     * for new readers already. Deleter could be called from any thread retiring nodes and must not
+     * depend on the structure the node was removed from, as it could be gone by then
+     */
+    static void Retire(void *node, void (*deleter)(void *));
+
+    /**
+     * Same as above, but deleter also gets the given context, e.g. to account freed memory. Context
+     * must stay valid until the node is freed
+     */
+    static void Retire(void *node, void (*deleter)(void *, void *), void *context);
+
+    /**
+     * Tries to move epoch forward and frees nodes retired by the calling thread which are safe to
+     * free. Retire does the same every few calls, so it is only needed to speed reclamation up
+     */
+    static void Collect();
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_EPOCH_H
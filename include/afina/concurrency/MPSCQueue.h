@@ -0,0 +1,66 @@
+#ifndef AFINA_CONCURRENCY_MPSC_QUEUE_H
+#define AFINA_CONCURRENCY_MPSC_QUEUE_H
+
+#include <atomic>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Intrusive multi-producer single-consumer queue
+ * Any number of threads push items, the only consumer takes all of them at once. Items are linked
+ * through their own Next field, so queue never allocates memory and push never blocks: producers
+ * race on a single CAS of the head, consumer swaps the whole list out. As consumer never takes
+ * single items there is no ABA problem.
+ *
+ * Item belongs to the queue from Push until it is returned by PopAll, Next field must not be
+ * touched meanwhile
+ */
+template <typename T, T *T::*Next> class MPSCQueue {
+public:
+    MPSCQueue() : _head(nullptr) {}
+
+    /**
+     * Adds item to the queue, could be called from any thread
+     */
+    void Push(T *item) {
+        T *head = _head.load(std::memory_order_relaxed);
+        do {
+            item->*Next = head;
+        } while (!_head.compare_exchange_weak(head, item, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * Takes all items pushed so far, returns them linked through Next in push order or nullptr
+     * if queue is empty. Must be called by the consumer thread only
+     */
+    T *PopAll() {
+        T *list = _head.exchange(nullptr, std::memory_order_acquire);
+
+        // Stack gives items in reverse order
+        T *result = nullptr;
+        while (list != nullptr) {
+            T *next = list->*Next;
+            list->*Next = result;
+            result = list;
+            list = next;
+        }
+        return result;
+    }
+
+    /**
+     * Hint whether queue has no items, exact only if producers are quiescent
+     */
+    bool Empty() const { return _head.load(std::memory_order_relaxed) == nullptr; }
+
+private:
+    MPSCQueue(const MPSCQueue &) = delete;
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+    std::atomic<T *> _head;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_MPSC_QUEUE_H
@@ -0,0 +1,140 @@
+#ifndef AFINA_CONCURRENCY_SHARED_MUTEX_H
+#define AFINA_CONCURRENCY_SHARED_MUTEX_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+
+#include <pthread.h>
+
+#include <afina/concurrency/AlignedArray.h>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Readers-writer lock
+ * Thin wrapper over pthread rwlock, C++11 has no std::shared_mutex. Exclusive side satisfies
+ * Lockable concept so could be used with std::lock_guard and std::unique_lock, shared side is
+ * meant to be used with SharedLock below.
+ *
+ * Writers are preferred: once writer is waiting new readers are blocked, so that writer
+ * doesn't starve on a read-heavy load
+ */
+class SharedMutex {
+public:
+    SharedMutex() {
+        pthread_rwlockattr_t attr;
+        pthread_rwlockattr_init(&attr);
+        pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+        int err = pthread_rwlock_init(&_lock, &attr);
+        pthread_rwlockattr_destroy(&attr);
+        if (err != 0) {
+            throw std::runtime_error("Failed to initialize rwlock");
+        }
+    }
+    ~SharedMutex() { pthread_rwlock_destroy(&_lock); }
+
+    void lock() { pthread_rwlock_wrlock(&_lock); }
+    bool try_lock() { return pthread_rwlock_trywrlock(&_lock) == 0; }
+    void unlock() { pthread_rwlock_unlock(&_lock); }
+
+    void lock_shared() { pthread_rwlock_rdlock(&_lock); }
+    bool try_lock_shared() { return pthread_rwlock_tryrdlock(&_lock) == 0; }
+    void unlock_shared() { pthread_rwlock_unlock(&_lock); }
+
+private:
+    SharedMutex(const SharedMutex &) = delete;
+    SharedMutex &operator=(const SharedMutex &) = delete;
+
+    pthread_rwlock_t _lock;
+};
+
+/**
+ * # Readers-writer lock with per-thread reader slots
+ * Readers of SharedMutex never wait for each other, but all of them modify the same counter, so its
+ * cache line moves between cores on every shared lock. This lock consists of a number of
+ * SharedMutex slots, each on its own cache line: reader takes the slot of its thread only, writer
+ * takes all of them in order. So readers running on different cores touch different memory, for
+ * the price of writer taking one lock per slot.
+ *
+ * Threads get slots round robin on their first use of any sharded lock, by default there is a slot
+ * per core. Writers are preferred the same way as by SharedMutex.
+ */
+class ShardedSharedMutex {
+public:
+    explicit ShardedSharedMutex(size_t slots = 0)
+        : _slots(slots != 0 ? slots : std::max(1u, std::thread::hardware_concurrency())),
+          _count(_slots.size()) {}
+
+    void lock() {
+        for (size_t i = 0; i < _count; i++) {
+            _slots[i].mutex.lock();
+        }
+    }
+    bool try_lock() {
+        for (size_t i = 0; i < _count; i++) {
+            if (!_slots[i].mutex.try_lock()) {
+                while (i-- > 0) {
+                    _slots[i].mutex.unlock();
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+    void unlock() {
+        for (size_t i = _count; i-- > 0;) {
+            _slots[i].mutex.unlock();
+        }
+    }
+
+    void lock_shared() { Local().lock_shared(); }
+    bool try_lock_shared() { return Local().try_lock_shared(); }
+    void unlock_shared() { Local().unlock_shared(); }
+
+    // Number of reader slots
+    size_t slots() const { return _count; }
+
+private:
+    ShardedSharedMutex(const ShardedSharedMutex &) = delete;
+    ShardedSharedMutex &operator=(const ShardedSharedMutex &) = delete;
+
+    struct alignas(64) slot {
+        SharedMutex mutex;
+    };
+
+    // Slot of the calling thread, it never changes, so unlock_shared gets the same one as lock_shared
+    SharedMutex &Local() {
+        static std::atomic<size_t> next_thread(0);
+        static thread_local size_t thread = next_thread.fetch_add(1, std::memory_order_relaxed);
+        return _slots[thread % _count].mutex;
+    }
+
+    AlignedArray<slot> _slots;
+    size_t _count;
+};
+
+/**
+ * # Scoped shared ownership of SharedMutex
+ * Same as std::lock_guard, but acquires lock in shared mode. Works with any lock having
+ * lock_shared and unlock_shared, e.g. ShardedSharedMutex
+ */
+template <typename Mutex = SharedMutex> class SharedLock {
+public:
+    explicit SharedLock(Mutex &m) : _mutex(m) { _mutex.lock_shared(); }
+    ~SharedLock() { _mutex.unlock_shared(); }
+
+private:
+    SharedLock(const SharedLock &) = delete;
+    SharedLock &operator=(const SharedLock &) = delete;
+
+    Mutex &_mutex;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_SHARED_MUTEX_H
@@ -20,7 +20,7 @@ namespace Execute {
  */
 class Add : public InsertCommand {
 public:
-    Add(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Add(const Allocator::String &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
     ~Add() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
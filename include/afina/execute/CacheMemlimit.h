@@ -0,0 +1,36 @@
+#ifndef AFINA_EXECUTE_CACHE_MEMLIMIT_H
+#define AFINA_EXECUTE_CACHE_MEMLIMIT_H
+
+#include <cstdint>
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Change memory limit of the storage
+ * Limit is given in megabytes. Once it gets less than memory in use, items are
+ * evicted gradually by the following operations, so that nothing is restarted
+ * and no single request waits for the whole excess to be evicted.
+ *
+ * Command must write result to the output, which could be:
+ * - "OK" to indicate success
+ * - "SERVER_ERROR ..." if the storage can't be resized
+ */
+class CacheMemlimit : public Command {
+public:
+    explicit CacheMemlimit(uint32_t megabytes) : _megabytes(megabytes) {}
+    ~CacheMemlimit() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    uint32_t _megabytes;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_CACHE_MEMLIMIT_H
@@ -1,17 +1,24 @@
 #ifndef AFINA_EXECUTE_COMMAND_H
 #define AFINA_EXECUTE_COMMAND_H
 
+#include <cstddef>
 #include <string>
 
+#include <afina/allocator/StlAllocator.h>
+
 namespace Afina {
 
 class Storage;
 
 namespace Execute {
 
+class Output;
+
 /**
- *
- *
+ * # Command parsed out from the client request
+ * Command could be placed in the request memory together with its keys, new (resource) Command(...)
+ * takes memory from the resource, which is remembered next to the object, so that the command is
+ * deleted the usual way
  */
 class Command {
 public:
@@ -19,6 +26,24 @@ public:
     virtual ~Command() {}
 
     virtual void Execute(Storage &storage, const std::string &args, std::string &out) = 0;
+
+    /**
+     * Executes command appending response to the connection output, so that response could reference
+     * values instead of copying them. By default response built by the method above is copied
+     */
+    virtual void Execute(Storage &storage, const std::string &args, Output &out);
+
+    static void *operator new(size_t size, Allocator::MemoryResource *resource);
+    static void *operator new(size_t size) { return operator new(size, nullptr); }
+    static void operator delete(void *p);
+    static void operator delete(void *p, Allocator::MemoryResource *resource) { operator delete(p); }
+
+protected:
+    // Storage works with std::string, so key is copied to the buffer reused by all commands of the thread
+    static const std::string &StorageKey(const Allocator::String &key);
+
+    // Buffer for values read from the storage, reused by all commands of the thread
+    static std::string &ValueBuffer();
 };
 
 } // namespace Execute
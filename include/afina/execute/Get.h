@@ -34,15 +34,25 @@ namespace Execute {
  */
 class Get : public Command {
 public:
-    Get(const std::vector<std::string> &keys) : _keys(keys) {}
+    Get(const Allocator::Vector<Allocator::String> &keys) : _keys(keys) {}
     ~Get() {}
 
-    inline const std::vector<std::string> &keys() const { return _keys; }
+    // Copy of the keys, command keeps them in the request memory
+    std::vector<std::string> keys() const {
+        std::vector<std::string> result;
+        for (auto &key : _keys) {
+            result.emplace_back(key.data(), key.size());
+        }
+        return result;
+    }
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
 
+    // Values are referenced by the output rather than copied
+    void Execute(Storage &storage, const std::string &args, Output &out) override;
+
 private:
-    std::vector<std::string> _keys;
+    Allocator::Vector<Allocator::String> _keys;
 };
 
 } // namespace Execute
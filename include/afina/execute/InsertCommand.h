@@ -15,15 +15,23 @@ namespace Execute {
  */
 class InsertCommand : public Command {
 public:
-    InsertCommand(const std::string &key, uint32_t flags, int32_t expire) : _key(key), _flags(flags), _expire(expire) {}
+    InsertCommand(const Allocator::String &key, uint32_t flags, int32_t expire)
+        : _key(key), _flags(flags), _expire(expire) {}
     ~InsertCommand() {}
 
-    inline const std::string &key() const { return _key; }
+    inline const Allocator::String &key() const { return _key; }
     inline const uint32_t flags() const { return _flags; }
     inline const int32_t expire() const { return _expire; }
 
 protected:
-    const std::string _key;
+    /**
+     * Converts expire field to the number of seconds item lives, zero means forever. Expire time longer
+     * than 30 days is an absolute unix time, negative one means item is expired at once. Returns false
+     * if item is expired already
+     */
+    bool TTL(uint32_t &ttl) const;
+
+    const Allocator::String _key;
     const uint32_t _flags;
     const int32_t _expire;
 };
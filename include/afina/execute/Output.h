@@ -0,0 +1,77 @@
+#ifndef AFINA_EXECUTE_OUTPUT_H
+#define AFINA_EXECUTE_OUTPUT_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include <sys/uio.h>
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Scatter-gather output of the connection
+ * Responses waiting to be sent. Text is copied into the single buffer, while large values taken
+ * from the storage are only referenced, so that value bytes go from the storage right to the socket
+ * with writev. Referenced value stays alive until it is sent, even if the storage drops it meanwhile.
+ *
+ * Output is a sequence of pieces, each is either a range of the text buffer or a value, Prepare()
+ * describes pending pieces with iovec array and Consume() drops what was sent.
+ */
+class Output {
+public:
+    // Values of at least that size are referenced rather than copied
+    static constexpr size_t kMinReferenced = 2048;
+
+    Output() : _size(0) {}
+
+    void Append(const char *data, size_t size);
+    void Append(const std::string &text) { Append(text.data(), text.size()); }
+
+    /**
+     * Appends value, large one is referenced instead of being copied
+     */
+    void Append(std::shared_ptr<const std::string> value);
+
+    // Number of bytes pending
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    /**
+     * Fills at most count entries of iov with the pending data, returns number of entries filled
+     */
+    size_t Prepare(struct iovec *iov, size_t count) const;
+
+    /**
+     * Drops first size bytes, e.g once they are sent
+     */
+    void Consume(size_t size);
+
+    void Clear();
+
+private:
+    struct Piece {
+        // Referenced value, text buffer piece if not set
+        std::shared_ptr<const std::string> value;
+
+        // Pending bytes of the value or of the text buffer
+        size_t offset;
+        size_t size;
+    };
+
+    const char *Data(const Piece &piece) const {
+        return (piece.value ? piece.value->data() : _text.data()) + piece.offset;
+    }
+
+    // Text pieces point into the buffer, it keeps capacity between responses
+    std::string _text;
+    std::deque<Piece> _pieces;
+    size_t _size;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_OUTPUT_H
@@ -21,7 +21,7 @@ namespace Execute {
  */
 class Set : public InsertCommand {
 public:
-    Set(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Set(const Allocator::String &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
     ~Set() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
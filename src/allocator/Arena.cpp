@@ -0,0 +1,69 @@
+#include <afina/allocator/Arena.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Allocator {
+
+// See Arena.h
+Arena::Arena(size_t limit, size_t slab_size)
+    : _slab_size(slab_size), _slabs(slab_size > 0 ? limit / slab_size : 0), _used(0), _free(0) {
+    if ((slab_size & (slab_size - 1)) != 0 || slab_size < size_t(sysconf(_SC_PAGESIZE))) {
+        throw std::runtime_error("Arena slab size must be a power of two not less than page size");
+    }
+    if (_slabs == 0) {
+        throw std::runtime_error("Arena limit must fit at least one slab");
+    }
+
+    // Reserve one more slab to align the base
+    _region_size = (size_t(_slabs) + 1) * _slab_size;
+    _region = mmap(nullptr, _region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (_region == MAP_FAILED) {
+        throw std::runtime_error("Failed to reserve arena memory: " + std::string(strerror(errno)));
+    }
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(_region);
+    _base = reinterpret_cast<char *>((base + _slab_size - 1) & ~(uintptr_t(_slab_size) - 1));
+}
+
+// See Arena.h
+Arena::~Arena() { munmap(_region, _region_size); }
+
+// See Arena.h
+void *Arena::map() {
+    uint64_t head = _free.load(std::memory_order_acquire);
+    while (uint32_t(head) != 0) {
+        // Slab could be taken and reused by other thread meanwhile, then next is garbage but the
+        // counter doesn't match anymore and exchange fails
+        uint64_t new_head = ((head >> 32) + 1) << 32 | next(uint32_t(head)).load(std::memory_order_relaxed);
+        if (_free.compare_exchange_weak(head, new_head, std::memory_order_acquire)) {
+            return slab(uint32_t(head));
+        }
+    }
+
+    uint32_t used = _used.load(std::memory_order_relaxed);
+    while (used < _slabs) {
+        if (_used.compare_exchange_weak(used, used + 1, std::memory_order_relaxed)) {
+            return slab(used + 1);
+        }
+    }
+    return nullptr;
+}
+
+// See Arena.h
+void Arena::unmap(void *p) {
+    uint32_t index = uint32_t((static_cast<char *>(p) - _base) / _slab_size) + 1;
+    uint64_t head = _free.load(std::memory_order_relaxed);
+    do {
+        next(index).store(uint32_t(head), std::memory_order_relaxed);
+    } while (!_free.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | index, std::memory_order_release,
+                                          std::memory_order_relaxed));
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -0,0 +1,350 @@
+#include <afina/allocator/MemPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/SlabCache.h>
+
+namespace Afina {
+namespace Allocator {
+
+namespace {
+
+constexpr size_t kAlign = 16;
+
+size_t align_up(size_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+
+// Live pools by id, so that exiting thread could tell if its pool states are still there
+struct Registry {
+    std::mutex mutex;
+    std::vector<uint64_t> generations;
+    std::vector<uint32_t> free_ids;
+    uint64_t next_generation = 1;
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Per thread lookup table: pool id -> thread state in that pool
+struct ThreadEntry {
+    uint64_t generation;
+    void *local;
+    std::atomic<bool> *owned;
+};
+
+struct ThreadLocals {
+    std::vector<ThreadEntry> entries;
+
+    // Thread states of alive pools become free for the next new thread
+    ~ThreadLocals() {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (size_t id = 0; id < entries.size(); id++) {
+            if (entries[id].generation != 0 && r.generations[id] == entries[id].generation) {
+                entries[id].owned->store(false, std::memory_order_release);
+            }
+        }
+    }
+};
+
+thread_local ThreadLocals thread_locals;
+
+} // namespace
+
+struct MemPool::slab {
+    local *owner;
+
+    // Owner only part
+    void *free_list;
+    char *bump;
+    char *end;
+    size_t used;
+
+    bool in_partial;
+    slab *partial_prev;
+    slab *partial_next;
+
+    slab *all_prev;
+    slab *all_next;
+
+    // Objects freed by other threads
+    std::atomic<void *> remote_free;
+
+    // Slab is in the owner pending list or is about to be there
+    std::atomic<bool> queued;
+    slab *pending_next;
+};
+
+struct MemPool::local {
+    explicit local(Arena &arena)
+        : cache(arena), current(nullptr), partial(nullptr), all(nullptr), pending(nullptr), owned(true) {}
+
+    SlabCache cache;
+
+    // Slab objects are allocated from
+    slab *current;
+
+    // Slabs having free objects
+    slab *partial;
+
+    // Every slab of this thread
+    slab *all;
+
+    // Slabs having objects freed by other threads
+    std::atomic<slab *> pending;
+
+    // Some thread works with this state
+    std::atomic<bool> owned;
+};
+
+namespace {
+
+template <typename T> void list_insert(T *&head, T *s, T *T::*prev, T *T::*next) {
+    s->*prev = nullptr;
+    s->*next = head;
+    if (head != nullptr) {
+        head->*prev = s;
+    }
+    head = s;
+}
+
+template <typename T> void list_remove(T *&head, T *s, T *T::*prev, T *T::*next) {
+    if (s->*prev != nullptr) {
+        (s->*prev)->*next = s->*next;
+    } else {
+        head = s->*next;
+    }
+    if (s->*next != nullptr) {
+        (s->*next)->*prev = s->*prev;
+    }
+}
+
+} // namespace
+
+// See MemPool.h
+MemPool::MemPool(Arena &arena, size_t object_size)
+    : _arena(arena), _object_size(align_up(std::max(object_size, sizeof(void *)))), _first(align_up(sizeof(slab))) {
+    if (_first + 4 * _object_size > arena.slab_size()) {
+        throw std::runtime_error("Pool object is too large for the arena slab");
+    }
+
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (r.free_ids.empty()) {
+        _id = r.generations.size();
+        r.generations.push_back(0);
+    } else {
+        _id = r.free_ids.back();
+        r.free_ids.pop_back();
+    }
+    _generation = r.next_generation++;
+    r.generations[_id] = _generation;
+}
+
+// See MemPool.h
+MemPool::~MemPool() {
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.generations[_id] = 0;
+        r.free_ids.push_back(_id);
+    }
+
+    for (auto &l : _locals) {
+        while (l->all != nullptr) {
+            slab *s = l->all;
+            l->all = s->all_next;
+            _arena.unmap(s);
+        }
+    }
+}
+
+// See MemPool.h
+void *MemPool::alloc() {
+    local *l = Local();
+    void *p;
+    if (l->current != nullptr && (p = Take(l->current)) != nullptr) {
+        return p;
+    }
+
+    // Current slab is exhausted, see if other threads have returned something
+    Collect(l);
+    if (l->current != nullptr && (p = Take(l->current)) != nullptr) {
+        return p;
+    }
+
+    slab *s = l->partial;
+    if (s != nullptr) {
+        list_remove(l->partial, s, &slab::partial_prev, &slab::partial_next);
+        s->in_partial = false;
+    } else if ((s = NewSlab(l)) == nullptr) {
+        return nullptr;
+    }
+
+    l->current = s;
+    return Take(s);
+}
+
+// See MemPool.h
+void MemPool::free(void *p) {
+    if (p == nullptr) {
+        return;
+    }
+
+    slab *s = static_cast<slab *>(_arena.slab_of(p));
+    local *l = Local();
+    if (s->owner == l) {
+        LocalFree(l, s, p);
+    } else {
+        RemoteFree(s, p);
+    }
+}
+
+// See MemPool.h
+MemPool::local *MemPool::Local() {
+    std::vector<ThreadEntry> &entries = thread_locals.entries;
+    if (_id < entries.size() && entries[_id].generation == _generation) {
+        return static_cast<local *>(entries[_id].local);
+    }
+    return Attach();
+}
+
+// See MemPool.h
+MemPool::local *MemPool::Attach() {
+    local *result = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_locals_mutex);
+        for (auto &l : _locals) {
+            bool owned = false;
+            if (l->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+                result = l.get();
+                break;
+            }
+        }
+
+        if (result == nullptr) {
+            _locals.emplace_back(new local(_arena));
+            result = _locals.back().get();
+        }
+    }
+
+    std::vector<ThreadEntry> &entries = thread_locals.entries;
+    if (entries.size() <= _id) {
+        entries.resize(_id + 1, ThreadEntry{0, nullptr, nullptr});
+    }
+    entries[_id] = ThreadEntry{_generation, result, &result->owned};
+    return result;
+}
+
+// See MemPool.h
+MemPool::slab *MemPool::NewSlab(local *l) {
+    void *mem = l->cache.get();
+    if (mem == nullptr) {
+        return nullptr;
+    }
+
+    slab *s = new (mem) slab();
+    s->owner = l;
+    s->free_list = nullptr;
+    s->bump = static_cast<char *>(mem) + _first;
+    s->end = static_cast<char *>(mem) + _arena.slab_size();
+    s->used = 0;
+    s->in_partial = false;
+    s->remote_free.store(nullptr, std::memory_order_relaxed);
+    s->queued.store(false, std::memory_order_relaxed);
+    s->pending_next = nullptr;
+    list_insert(l->all, s, &slab::all_prev, &slab::all_next);
+    return s;
+}
+
+// See MemPool.h
+void *MemPool::Take(slab *s) {
+    void *p = s->free_list;
+    if (p != nullptr) {
+        s->free_list = *static_cast<void **>(p);
+    } else if (s->bump + _object_size <= s->end) {
+        p = s->bump;
+        s->bump += _object_size;
+    } else {
+        return nullptr;
+    }
+
+    s->used++;
+    return p;
+}
+
+// See MemPool.h
+void MemPool::LocalFree(local *l, slab *s, void *p) {
+    *static_cast<void **>(p) = s->free_list;
+    s->free_list = p;
+    s->used--;
+    Settle(l, s);
+}
+
+// See MemPool.h
+void MemPool::Settle(local *l, slab *s) {
+    if (s == l->current) {
+        return;
+    }
+
+    // Slab queued to the owner could still be touched by other thread, it goes away on the next collect
+    if (s->used == 0 && !s->queued.load()) {
+        if (s->in_partial) {
+            list_remove(l->partial, s, &slab::partial_prev, &slab::partial_next);
+        }
+        list_remove(l->all, s, &slab::all_prev, &slab::all_next);
+        l->cache.put(s);
+    } else if (!s->in_partial) {
+        list_insert(l->partial, s, &slab::partial_prev, &slab::partial_next);
+        s->in_partial = true;
+    }
+}
+
+// See MemPool.h
+void MemPool::RemoteFree(slab *s, void *p) {
+    // Flag goes first: owner never releases flagged slab, so it is safe to touch the slab until it
+    // gets to the pending list
+    bool enqueue = !s->queued.exchange(true);
+
+    void *head = s->remote_free.load(std::memory_order_relaxed);
+    do {
+        *static_cast<void **>(p) = head;
+    } while (!s->remote_free.compare_exchange_weak(head, p, std::memory_order_release, std::memory_order_relaxed));
+
+    if (enqueue) {
+        local *owner = s->owner;
+        slab *pending = owner->pending.load(std::memory_order_relaxed);
+        do {
+            s->pending_next = pending;
+        } while (!owner->pending.compare_exchange_weak(pending, s, std::memory_order_release,
+                                                       std::memory_order_relaxed));
+    }
+}
+
+// See MemPool.h
+void MemPool::Collect(local *l) {
+    slab *s = l->pending.exchange(nullptr, std::memory_order_acquire);
+    while (s != nullptr) {
+        slab *next = s->pending_next;
+        s->queued.store(false);
+
+        void *p = s->remote_free.exchange(nullptr, std::memory_order_acquire);
+        while (p != nullptr) {
+            void *next_object = *static_cast<void **>(p);
+            *static_cast<void **>(p) = s->free_list;
+            s->free_list = p;
+            s->used--;
+            p = next_object;
+        }
+
+        Settle(l, s);
+        s = next;
+    }
+}
+
+} // namespace Allocator
+} // namespace Afina
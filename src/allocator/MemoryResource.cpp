@@ -0,0 +1,89 @@
+#include <afina/allocator/MemoryResource.h>
+
+#include <atomic>
+#include <new>
+
+#include <afina/allocator/Slab.h>
+#include <afina/allocator/SmallAlloc.h>
+
+namespace Afina {
+namespace Allocator {
+
+namespace {
+
+class NewDeleteResource : public MemoryResource {
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        if (alignment > alignof(std::max_align_t)) {
+            throw std::bad_alloc();
+        }
+        return ::operator new(bytes);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override { ::operator delete(p); }
+};
+
+NewDeleteResource new_delete;
+
+std::atomic<MemoryResource *> default_resource(&new_delete);
+
+} // namespace
+
+// See MemoryResource.h
+MemoryResource *new_delete_resource() noexcept { return &new_delete; }
+
+// See MemoryResource.h
+MemoryResource *get_default_resource() noexcept { return default_resource.load(std::memory_order_acquire); }
+
+// See MemoryResource.h
+MemoryResource *set_default_resource(MemoryResource *r) noexcept {
+    if (r == nullptr) {
+        r = &new_delete;
+    }
+    return default_resource.exchange(r, std::memory_order_acq_rel);
+}
+
+// See MemoryResource.h
+void *SlabResource::do_allocate(size_t bytes, size_t alignment) {
+    void *p = nullptr;
+    if (alignment <= alignof(std::max_align_t) && bytes <= _slab.max_size()) {
+        p = _slab.alloc(bytes);
+    }
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// See MemoryResource.h
+void SlabResource::do_deallocate(void *p, size_t bytes, size_t alignment) { _slab.free(p, bytes); }
+
+// See MemoryResource.h
+bool SlabResource::do_is_equal(const MemoryResource &other) const noexcept {
+    const SlabResource *o = dynamic_cast<const SlabResource *>(&other);
+    return o != nullptr && &o->_slab == &_slab;
+}
+
+// See MemoryResource.h
+void *SmallAllocResource::do_allocate(size_t bytes, size_t alignment) {
+    void *p = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        p = _small.alloc(bytes);
+    }
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// See MemoryResource.h
+void SmallAllocResource::do_deallocate(void *p, size_t bytes, size_t alignment) { _small.free(p, bytes); }
+
+// See MemoryResource.h
+bool SmallAllocResource::do_is_equal(const MemoryResource &other) const noexcept {
+    const SmallAllocResource *o = dynamic_cast<const SmallAllocResource *>(&other);
+    return o != nullptr && &o->_small == &_small;
+}
+
+} // namespace Allocator
+} // namespace Afina
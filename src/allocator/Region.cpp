@@ -0,0 +1,94 @@
+#include <afina/allocator/Region.h>
+
+#include <cstdint>
+#include <new>
+
+namespace Afina {
+namespace Allocator {
+
+namespace {
+
+constexpr size_t kHeader = alignof(std::max_align_t);
+
+char *align_up(char *p, size_t alignment) {
+    return reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(p) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+}
+
+} // namespace
+
+// See Region.h
+Region::Region(size_t chunk_size)
+    : _chunk_size(chunk_size), _first(nullptr), _current(nullptr), _top(nullptr), _end(nullptr), _capacity(0) {}
+
+// See Region.h
+Region::~Region() {
+    while (_first != nullptr) {
+        chunk *next = _first->next;
+        ::operator delete(_first);
+        _first = next;
+    }
+}
+
+// See Region.h
+void Region::reset() {
+    _current = _first;
+    if (_current != nullptr) {
+        _top = reinterpret_cast<char *>(_current) + kHeader;
+        _end = reinterpret_cast<char *>(_current) + _current->size;
+    }
+}
+
+// See Region.h
+void *Region::do_allocate(size_t bytes, size_t alignment) {
+    if (alignment > alignof(std::max_align_t)) {
+        throw std::bad_alloc();
+    }
+
+    char *p = align_up(_top, alignment);
+    if (_current == nullptr || p + bytes > _end) {
+        NextChunk(bytes);
+        p = _top;
+    }
+
+    _top = p + bytes;
+    return p;
+}
+
+// See Region.h
+void Region::do_deallocate(void *p, size_t bytes, size_t alignment) {
+    // The last block is given back, so that growing container doesn't waste a region
+    if (static_cast<char *>(p) + bytes == _top) {
+        _top = static_cast<char *>(p);
+    }
+}
+
+// See Region.h
+void Region::NextChunk(size_t bytes) {
+    chunk *next = _current != nullptr ? _current->next : _first;
+    while (next != nullptr && next->size - kHeader < bytes) {
+        next = next->next;
+    }
+
+    if (next == nullptr) {
+        size_t size = kHeader + bytes > _chunk_size ? kHeader + bytes : _chunk_size;
+        next = static_cast<chunk *>(::operator new(size));
+        next->size = size;
+        _capacity += size;
+
+        // New chunk goes right after the current one, so it is the first to be reused after reset
+        if (_current != nullptr) {
+            next->next = _current->next;
+            _current->next = next;
+        } else {
+            next->next = _first;
+            _first = next;
+        }
+    }
+
+    _current = next;
+    _top = reinterpret_cast<char *>(next) + kHeader;
+    _end = reinterpret_cast<char *>(next) + next->size;
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -1,40 +1,259 @@
 #include <afina/allocator/Simple.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+#include <afina/allocator/Error.h>
 #include <afina/allocator/Pointer.h>
 
 namespace Afina {
 namespace Allocator {
 
-Simple::Simple(void *base, size_t size) : _base(base), _base_len(size) {}
+namespace {
+
+// Alignment of the blocks data
+constexpr size_t kAlign = 16;
+
+size_t align_up(size_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+
+// Number of blocks checked in the bin that could be too small
+constexpr size_t kBinLookup = 16;
+
+// Index of the highest bit set, n must be positive
+size_t log2(size_t n) { return 8 * sizeof(unsigned long) - 1 - __builtin_clzl(n); }
+
+} // namespace
+
+struct Simple::block {
+    // Number of data bytes following the header
+    size_t size;
+
+    // Handle slot referring to the block, nullptr once block is free
+    void **handle;
+
+    char *data() { return reinterpret_cast<char *>(this + 1); }
+    char *end() { return data() + size; }
+
+    // Free blocks are linked through their data
+    block *&next_free() { return *reinterpret_cast<block **>(data()); }
+};
+
+static_assert(sizeof(void *) <= kAlign, "Free list link must fit into the smallest block");
+
+Simple::Simple(void *base, size_t size)
+    : _base(base), _base_len(size), _free_slots(nullptr), _free_blocks(), _free_bytes(0) {
+    uintptr_t begin = align_up(reinterpret_cast<uintptr_t>(base));
+    uintptr_t end = (reinterpret_cast<uintptr_t>(base) + size) & ~(sizeof(void *) - 1);
+
+    _begin = _top = reinterpret_cast<char *>(begin);
+    _table = _end = reinterpret_cast<void **>(std::max(begin, end));
+}
 
 /**
- * TODO: semantics
+ * Takes free block from the smallest bin where any block fits and splits it, then tries a few
+ * blocks of the request bin, then the space right after the last block
  * @param N size_t
  */
-Pointer Simple::alloc(size_t N) { return Pointer(); }
+Pointer Simple::alloc(size_t N) {
+    size_t size = align_up(std::max<size_t>(N, 1));
+    void **slot = take_slot();
+
+    block *b = nullptr;
+    for (size_t bin = log2(size) + 1; bin < kBins && b == nullptr; bin++) {
+        if (_free_blocks[bin] != nullptr) {
+            b = _free_blocks[bin];
+            _free_blocks[bin] = b->next_free();
+        }
+    }
+
+    // Blocks of the same bin could be smaller, look through a few of them
+    block **prev = &_free_blocks[log2(size)];
+    for (size_t i = 0; i < kBinLookup && b == nullptr && *prev != nullptr; i++, prev = &(*prev)->next_free()) {
+        if ((*prev)->size >= size) {
+            b = *prev;
+            *prev = b->next_free();
+        }
+    }
+
+    if (b != nullptr) {
+        _free_bytes -= b->size;
+        shrink(b, size);
+    }
+
+    if (b == nullptr) {
+        if (reinterpret_cast<char *>(_table) - _top < ptrdiff_t(sizeof(block) + size)) {
+            release_slot(slot);
+            throw AllocError(AllocErrorType::NoMemory, "No continuous free space for " + std::to_string(N) + " bytes");
+        }
+
+        b = reinterpret_cast<block *>(_top);
+        b->size = size;
+        _top = b->end();
+    }
+
+    b->handle = slot;
+    *slot = b->data();
+    return Pointer(slot);
+}
 
 /**
- * TODO: semantics
+ * Shrinks block in place, grows in place if it is the last one, moves it otherwise
  * @param p Pointer
  * @param N size_t
  */
-void Simple::realloc(Pointer &p, size_t N) {}
+void Simple::realloc(Pointer &p, size_t N) {
+    if (p._handle == nullptr) {
+        p = alloc(N);
+        return;
+    }
+
+    block *b = checked_block(p);
+    size_t size = align_up(std::max<size_t>(N, 1));
+    if (size <= b->size) {
+        shrink(b, size);
+        return;
+    }
+
+    if (b->end() == _top && b->data() + size <= reinterpret_cast<char *>(_table)) {
+        b->size = size;
+        _top = b->end();
+        return;
+    }
+
+    Pointer moved = alloc(N);
+    block *nb = reinterpret_cast<block *>(moved.get()) - 1;
+    std::memcpy(nb->data(), b->data(), b->size);
+
+    // Exchange handles, so that p refers to the new block and the old one gets released
+    std::swap(b->handle, nb->handle);
+    *nb->handle = nb->data();
+    *b->handle = b->data();
+    free(moved);
+}
 
 /**
- * TODO: semantics
+ * Returns handle slot back to the table and block to the free list
  * @param p Pointer
  */
-void Simple::free(Pointer &p) {}
+void Simple::free(Pointer &p) {
+    if (p._handle == nullptr) {
+        return;
+    }
+
+    block *b = checked_block(p);
+    release_slot(b->handle);
+    b->handle = nullptr;
+    p._handle = nullptr;
+    release(b);
+}
 
 /**
- * TODO: semantics
+ * Slides alive blocks down one by one preserving their order
  */
-void Simple::defrag() {}
+void Simple::defrag() {
+    char *dst = _begin;
+    for (char *src = _begin; src < _top;) {
+        block *b = reinterpret_cast<block *>(src);
+        size_t len = sizeof(block) + b->size;
+        if (b->handle != nullptr) {
+            if (src != dst) {
+                std::memmove(dst, src, len);
+                b = reinterpret_cast<block *>(dst);
+                *b->handle = b->data();
+            }
+            dst += len;
+        }
+        src += len;
+    }
+
+    _top = dst;
+    std::fill(_free_blocks, _free_blocks + kBins, nullptr);
+    _free_bytes = 0;
+}
+
+// See Simple.h
+size_t Simple::available() const { return (reinterpret_cast<char *>(_table) - _top) + _free_bytes; }
 
 /**
- * TODO: semantics
+ * One line per block: offset, size and state
  */
-std::string Simple::dump() const { return ""; }
+std::string Simple::dump() const {
+    std::stringstream ss;
+    for (char *pos = _begin; pos < _top;) {
+        block *b = reinterpret_cast<block *>(pos);
+        ss << (pos - _begin) << ": " << b->size << (b->handle != nullptr ? " used" : " free") << "\n";
+        pos = b->end();
+    }
+    ss << (_top - _begin) << ": " << (reinterpret_cast<char *>(_table) - _top) << " top\n";
+    ss << (_end - _table) << " handles\n";
+    return ss.str();
+}
+
+// See Simple.h
+void **Simple::take_slot() {
+    if (_free_slots != nullptr) {
+        void **slot = _free_slots;
+        _free_slots = static_cast<void **>(*slot);
+        return slot;
+    }
+
+    if (reinterpret_cast<char *>(_table) - _top < ptrdiff_t(sizeof(void *))) {
+        throw AllocError(AllocErrorType::NoMemory, "No space for a handle");
+    }
+    return --_table;
+}
+
+// See Simple.h
+void Simple::release_slot(void **slot) {
+    *slot = _free_slots;
+    _free_slots = slot;
+}
+
+// See Simple.h
+Simple::block *Simple::checked_block(const Pointer &p) const {
+    void **handle = p._handle;
+    if (handle < _table || handle >= _end) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't belong to the allocator");
+    }
+
+    char *data = static_cast<char *>(*handle);
+    if (data < _begin + sizeof(block) || data >= _top) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer refers to a released block");
+    }
+
+    block *b = reinterpret_cast<block *>(data) - 1;
+    if (b->handle != handle) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer refers to a released block");
+    }
+    return b;
+}
+
+// See Simple.h
+void Simple::shrink(block *b, size_t size) {
+    if (b->size < size + sizeof(block) + kAlign) {
+        return;
+    }
+
+    block *rest = reinterpret_cast<block *>(b->data() + size);
+    rest->size = b->size - size - sizeof(block);
+    rest->handle = nullptr;
+    b->size = size;
+    release(rest);
+}
+
+// See Simple.h
+void Simple::release(block *b) {
+    if (b->end() == _top) {
+        _top = reinterpret_cast<char *>(b);
+    } else {
+        size_t bin = log2(b->size);
+        b->next_free() = _free_blocks[bin];
+        _free_blocks[bin] = b;
+        _free_bytes += b->size;
+    }
+}
 
 } // namespace Allocator
 } // namespace Afina
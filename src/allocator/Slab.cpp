@@ -0,0 +1,117 @@
+#include <afina/allocator/Slab.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+namespace Afina {
+namespace Allocator {
+
+namespace {
+
+// All chunks are aligned for any object, so that item header or a container node could be placed
+// at the chunk start
+constexpr size_t kAlign = alignof(std::max_align_t);
+
+size_t align_up(size_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+
+} // namespace
+
+// See Slab.h
+Slab::Slab(size_t limit, size_t page_size, double factor, size_t min_chunk)
+    : _page_size(page_size), _max_pages(page_size > 0 ? limit / page_size : 0) {
+    if (_max_pages == 0) {
+        throw std::runtime_error("Slab limit must fit at least one page");
+    }
+    if (factor <= 1.0) {
+        throw std::runtime_error("Slab growth factor must be greater than 1");
+    }
+
+    size_t size = align_up(std::max(min_chunk, sizeof(void *)));
+    while (size <= _page_size / factor) {
+        _classes.push_back(size_class{size, nullptr, nullptr, 0, 0, 0});
+        size = std::max(align_up(size_t(size * factor)), size + kAlign);
+    }
+    _classes.push_back(size_class{_page_size, nullptr, nullptr, 0, 0, 0});
+}
+
+// See Slab.h
+Slab::~Slab() {
+    for (char *page : _pages) {
+        std::free(page);
+    }
+}
+
+// See Slab.h
+size_t Slab::class_of(size_t N) const {
+    auto it = std::lower_bound(_classes.begin(), _classes.end(), N,
+                               [](const size_class &c, size_t n) { return c.chunk_size < n; });
+    return it - _classes.begin();
+}
+
+// See Slab.h
+void *Slab::alloc(size_t N) {
+    size_t cls = class_of(N);
+    if (cls == _classes.size()) {
+        return nullptr;
+    }
+
+    size_class &c = _classes[cls];
+    void *result = c.free_list;
+    if (result != nullptr) {
+        c.free_list = *static_cast<void **>(result);
+        c.used++;
+        return result;
+    }
+
+    if (c.page_left == 0) {
+        if (_pages.size() == _max_pages) {
+            return nullptr;
+        }
+
+        // Page gets split lazily, so untouched chunks don't take physical memory
+        char *page = static_cast<char *>(std::malloc(_page_size));
+        if (page == nullptr) {
+            return nullptr;
+        }
+        _pages.push_back(page);
+        c.pages++;
+        c.page_end = page;
+        c.page_left = _page_size / c.chunk_size;
+    }
+
+    result = c.page_end;
+    c.page_end += c.chunk_size;
+    c.page_left--;
+    c.used++;
+    return result;
+}
+
+// See Slab.h
+void Slab::free(void *p, size_t N) {
+    if (p == nullptr) {
+        return;
+    }
+
+    size_class &c = _classes[class_of(N)];
+    *static_cast<void **>(p) = c.free_list;
+    c.free_list = p;
+    c.used--;
+}
+
+// See Slab.h
+std::string Slab::dump() const {
+    std::stringstream ss;
+    ss << "pages " << _pages.size() << "/" << _max_pages << " of " << _page_size << " bytes\n";
+    for (size_t i = 0; i < _classes.size(); i++) {
+        const size_class &c = _classes[i];
+        if (c.pages > 0) {
+            ss << "class " << i << ": chunk " << c.chunk_size << ", pages " << c.pages << ", used " << c.used << "\n";
+        }
+    }
+    return ss.str();
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -0,0 +1,45 @@
+#include <afina/allocator/SlabCache.h>
+
+#include <afina/allocator/Arena.h>
+
+namespace Afina {
+namespace Allocator {
+
+// See SlabCache.h
+SlabCache::SlabCache(Arena &arena, size_t keep) : _arena(arena), _keep(keep), _slabs(nullptr), _count(0) {}
+
+// See SlabCache.h
+SlabCache::~SlabCache() {
+    while (_slabs != nullptr) {
+        void *next = *static_cast<void **>(_slabs);
+        _arena.unmap(_slabs);
+        _slabs = next;
+    }
+}
+
+// See SlabCache.h
+void *SlabCache::get() {
+    if (_slabs == nullptr) {
+        return _arena.map();
+    }
+
+    void *result = _slabs;
+    _slabs = *static_cast<void **>(result);
+    _count--;
+    return result;
+}
+
+// See SlabCache.h
+void SlabCache::put(void *slab) {
+    if (_count == _keep) {
+        _arena.unmap(slab);
+        return;
+    }
+
+    *static_cast<void **>(slab) = _slabs;
+    _slabs = slab;
+    _count++;
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -0,0 +1,52 @@
+#include <afina/allocator/SmallAlloc.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Afina {
+namespace Allocator {
+
+// See SmallAlloc.h
+SmallAlloc::SmallAlloc(size_t limit, size_t slab_size, double factor, size_t min_object) : _arena(limit, slab_size) {
+    if (factor <= 1.0) {
+        throw std::runtime_error("Size classes growth factor must be greater than 1");
+    }
+
+    // Leave room for the slab header, so that at least four largest objects fit a slab
+    size_t max = slab_size / 4 - 64;
+    size_t size = min_object;
+    while (size < max) {
+        _pools.emplace_back(new MemPool(_arena, size));
+        size = std::max(size_t(_pools.back()->object_size() * factor), _pools.back()->object_size() + 1);
+    }
+    _pools.emplace_back(new MemPool(_arena, max));
+}
+
+// See SmallAlloc.h
+MemPool *SmallAlloc::PoolOf(size_t N) const {
+    auto it = std::lower_bound(_pools.begin(), _pools.end(), N,
+                               [](const std::unique_ptr<MemPool> &p, size_t n) { return p->object_size() < n; });
+    return it != _pools.end() ? it->get() : nullptr;
+}
+
+// See SmallAlloc.h
+void *SmallAlloc::alloc(size_t N) {
+    MemPool *pool = PoolOf(N);
+    if (pool == nullptr) {
+        return ::operator new(N);
+    }
+    return pool->alloc();
+}
+
+// See SmallAlloc.h
+void SmallAlloc::free(void *p, size_t N) {
+    MemPool *pool = PoolOf(N);
+    if (pool == nullptr) {
+        ::operator delete(p);
+        return;
+    }
+    pool->free(p);
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -0,0 +1,208 @@
+#include <afina/concurrency/Epoch.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Afina {
+namespace Concurrency {
+
+namespace {
+
+// Number of retired nodes between attempts to move epoch forward
+constexpr size_t kCollectEvery = 64;
+
+// Announced epoch of the thread out of any guard
+constexpr uint64_t kInactive = ~uint64_t(0);
+
+struct Retired {
+    void *node;
+    void (*deleter)(void *, void *);
+    void *context;
+};
+
+// Deleter of the nodes retired without context, the deleter itself is passed as the context
+void CallDeleter(void *node, void *deleter) { reinterpret_cast<void (*)(void *)>(deleter)(node); }
+
+// Announcement and retired nodes of a thread, records are never freed but reused by new threads
+struct Record {
+    std::atomic<uint64_t> epoch{kInactive};
+    std::atomic<bool> used{true};
+    Record *next = nullptr;
+
+    // Guards nesting depth
+    unsigned depth = 0;
+
+    // Nodes retired at the last three epochs, slot is epoch % 3
+    std::vector<Retired> retired[3];
+    uint64_t retired_epoch[3] = {0, 0, 0};
+    size_t since_collect = 0;
+};
+
+// Nodes retired at the same epoch by a thread which has exited before they became safe to free
+struct Orphans {
+    uint64_t epoch;
+    std::vector<Retired> retired;
+    Orphans *next;
+};
+
+std::atomic<uint64_t> global_epoch{1};
+std::atomic<Record *> records{nullptr};
+std::atomic<Orphans *> orphans{nullptr};
+
+void FreeAll(std::vector<Retired> &retired) {
+    for (Retired &r : retired) {
+        r.deleter(r.node, r.context);
+    }
+    retired.clear();
+}
+
+// Frees nodes retired two epochs before the given one or earlier
+void Free(Record &record, uint64_t epoch) {
+    for (size_t i = 0; i < 3; i++) {
+        if (!record.retired[i].empty() && record.retired_epoch[i] + 2 <= epoch) {
+            FreeAll(record.retired[i]);
+        }
+    }
+}
+
+void PushOrphans(Orphans *batch) {
+    Orphans *head = orphans.load(std::memory_order_relaxed);
+    do {
+        batch->next = head;
+    } while (!orphans.compare_exchange_weak(head, batch, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// Frees orphaned nodes retired two epochs before the given one or earlier. The whole list is taken
+// at once, so that threads draining it concurrently never see the same batch
+void FreeOrphans(uint64_t epoch) {
+    if (orphans.load(std::memory_order_relaxed) == nullptr) {
+        return;
+    }
+
+    Orphans *batch = orphans.exchange(nullptr, std::memory_order_acquire);
+    while (batch != nullptr) {
+        Orphans *next = batch->next;
+        if (batch->epoch + 2 <= epoch) {
+            FreeAll(batch->retired);
+            delete batch;
+        } else {
+            PushOrphans(batch);
+        }
+        batch = next;
+    }
+}
+
+// Moves epoch forward if every thread inside guard has seen the current one and frees orphaned
+// nodes that are safe to free, returns the epoch
+uint64_t TryAdvance() {
+    uint64_t epoch = global_epoch.load();
+    for (Record *r = records.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        uint64_t seen = r->epoch.load();
+        if (seen != kInactive && seen != epoch) {
+            FreeOrphans(epoch);
+            return epoch;
+        }
+    }
+
+    global_epoch.compare_exchange_strong(epoch, epoch + 1);
+    epoch = global_epoch.load();
+    FreeOrphans(epoch);
+    return epoch;
+}
+
+// Owns the record of the thread until it exits
+class Holder {
+public:
+    Holder() {
+        for (Record *r = records.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+            bool used = false;
+            if (!r->used.load(std::memory_order_relaxed) && r->used.compare_exchange_strong(used, true)) {
+                record = r;
+                return;
+            }
+        }
+
+        record = new Record();
+        Record *head = records.load(std::memory_order_relaxed);
+        do {
+            record->next = head;
+        } while (!records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    ~Holder() {
+        // Nodes not safe to free yet are handed over to whoever moves the epoch forward, next thread
+        // taking the record might never come
+        Free(*record, TryAdvance());
+        for (size_t i = 0; i < 3; i++) {
+            if (!record->retired[i].empty()) {
+                Orphans *batch = new Orphans();
+                batch->epoch = record->retired_epoch[i];
+                batch->retired.swap(record->retired[i]);
+                PushOrphans(batch);
+            }
+        }
+        record->used.store(false, std::memory_order_release);
+    }
+
+    Record *record;
+};
+
+Record &Local() {
+    static thread_local Holder holder;
+    return *holder.record;
+}
+
+} // namespace
+
+// See Epoch.h
+void Epoch::Enter() {
+    Record &record = Local();
+    if (record.depth++ == 0) {
+        // Announcement must be visible before any shared node is read, hence sequential consistency
+        record.epoch.store(global_epoch.load());
+    }
+}
+
+// See Epoch.h
+void Epoch::Leave() {
+    Record &record = Local();
+    if (--record.depth == 0) {
+        record.epoch.store(kInactive, std::memory_order_release);
+    }
+}
+
+// See Epoch.h
+void Epoch::Retire(void *node, void (*deleter)(void *)) {
+    Retire(node, &CallDeleter, reinterpret_cast<void *>(deleter));
+}
+
+// See Epoch.h
+void Epoch::Retire(void *node, void (*deleter)(void *, void *), void *context) {
+    Record &record = Local();
+    uint64_t epoch = global_epoch.load();
+
+    // Slot still holds nodes of three epochs ago at least, they are safe to free
+    size_t slot = epoch % 3;
+    if (record.retired_epoch[slot] != epoch) {
+        Free(record, epoch);
+        record.retired_epoch[slot] = epoch;
+    }
+    record.retired[slot].push_back(Retired{node, deleter, context});
+
+    if (++record.since_collect >= kCollectEvery) {
+        record.since_collect = 0;
+        Free(record, TryAdvance());
+    }
+}
+
+// See Epoch.h
+void Epoch::Collect() {
+    Record &record = Local();
+    record.since_collect = 0;
+    Free(record, TryAdvance());
+}
+
+} // namespace Concurrency
+} // namespace Afina
@@ -1,16 +1,19 @@
 #include <afina/Storage.h>
 #include <afina/execute/Add.h>
 
-#include <iostream>
-
 namespace Afina {
 namespace Execute {
 
 // memcached protocol:  "add" means "store this data, but only if the server *doesn't* already
 // hold data for this key".
 void Add::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Add(" << _key << ")" << args << std::endl;
-    out = storage.PutIfAbsent(_key, args) ? "STORED" : "NOT_STORED";
+    uint32_t ttl;
+    if (TTL(ttl)) {
+        out.assign(storage.PutIfAbsent(StorageKey(_key), args, ttl) ? "STORED" : "NOT_STORED");
+    } else {
+        // Item stored expired is never seen, so only the answer matters
+        out.assign(storage.Get(StorageKey(_key), ValueBuffer()) ? "NOT_STORED" : "STORED");
+    }
 }
 
 } // namespace Execute
@@ -0,0 +1,17 @@
+#include <afina/Storage.h>
+#include <afina/execute/CacheMemlimit.h>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "cache_memlimit" changes memory limit in megabytes
+void CacheMemlimit::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (_megabytes == 0 || !storage.Resize(size_t(_megabytes) << 20)) {
+        out.assign("SERVER_ERROR storage can't be resized");
+        return;
+    }
+    out.assign("OK");
+}
+
+} // namespace Execute
+} // namespace Afina
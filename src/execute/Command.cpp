@@ -1 +1,63 @@
 #include <afina/execute/Command.h>
+#include <afina/execute/Output.h>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// Memory block of the command starts with the header
+struct header {
+    Allocator::MemoryResource *resource;
+    size_t size;
+};
+
+constexpr size_t kHeader = alignof(std::max_align_t);
+static_assert(sizeof(header) <= kHeader, "Command header must keep object aligned");
+
+} // namespace
+
+// See Command.h
+void *Command::operator new(size_t size, Allocator::MemoryResource *resource) {
+    if (resource == nullptr) {
+        resource = Allocator::new_delete_resource();
+    }
+
+    header *h = static_cast<header *>(resource->allocate(kHeader + size));
+    h->resource = resource;
+    h->size = kHeader + size;
+    return reinterpret_cast<char *>(h) + kHeader;
+}
+
+// See Command.h
+void Command::operator delete(void *p) {
+    if (p == nullptr) {
+        return;
+    }
+
+    header *h = reinterpret_cast<header *>(static_cast<char *>(p) - kHeader);
+    h->resource->deallocate(h, h->size);
+}
+
+// See Command.h
+void Command::Execute(Storage &storage, const std::string &args, Output &out) {
+    static thread_local std::string result;
+    Execute(storage, args, result);
+    out.Append(result);
+}
+
+// See Command.h
+const std::string &Command::StorageKey(const Allocator::String &key) {
+    static thread_local std::string buffer;
+    buffer.assign(key.data(), key.size());
+    return buffer;
+}
+
+// See Command.h
+std::string &Command::ValueBuffer() {
+    static thread_local std::string buffer;
+    return buffer;
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -1,9 +1,9 @@
 #include <afina/Storage.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Output.h>
 
-#include <iostream>
-#include <iterator>
-#include <sstream>
+#include <cstdio>
+#include <vector>
 
 namespace Afina {
 namespace Execute {
@@ -21,23 +21,76 @@ to indicate the end of response.
 
 */
 
-void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::stringstream keyStream;
-    copy(_keys.begin(), _keys.end(), std::ostream_iterator<std::string>(keyStream, " "));
-    std::cout << "Get(" << keyStream.str() << ")" << std::endl;
+namespace {
+
+// Lookup entries reused by all get commands of the thread, so that they keep memory for keys and values
+struct Lookups {
+    std::vector<Storage::Entry> entries;
+    std::vector<Storage::Entry *> batch;
+};
+
+// Looks up all keys with a single storage call, returns entries in the order of keys
+Storage::Entry *LookupAll(Storage &storage, const Allocator::Vector<Allocator::String> &keys) {
+    static thread_local Lookups lookups;
+    if (lookups.entries.size() < keys.size()) {
+        lookups.entries.resize(keys.size());
+    }
+
+    // Storage could reorder the batch, entries stay in place
+    lookups.batch.clear();
+    for (size_t i = 0; i < keys.size(); i++) {
+        Storage::Entry &entry = lookups.entries[i];
+        entry.key.assign(keys[i].data(), keys[i].size());
+        lookups.batch.push_back(&entry);
+    }
+    storage.MultiGet(lookups.batch.data(), lookups.batch.size());
+    return lookups.entries.data();
+}
 
-    std::stringstream outStream;
+} // namespace
 
-    std::string value;
-    for (auto &key : _keys) {
-        if (!storage.Get(key, value))
+void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
+    // Output is built in place, so that buffer given by the caller is reused from request to request
+    out.clear();
+
+    Storage::Entry *entries = LookupAll(storage, _keys);
+    for (size_t i = 0; i < _keys.size(); i++) {
+        Storage::Entry &entry = entries[i];
+        if (!entry.found)
             continue;
-        outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
-        outStream << value << "\r\n";
+
+        const std::string &value = entry.shared ? *entry.shared : entry.value;
+        char size[24];
+        int size_len = snprintf(size, sizeof(size), " 0 %zu\r\n", value.size());
+        out.append("VALUE ").append(_keys[i].data(), _keys[i].size()).append(size, size_len);
+        out.append(value).append("\r\n");
+        entry.shared.reset();
     }
-    outStream << "END"; // networking layer should add the last \r\n
+    out.append("END"); // networking layer should add the last \r\n
+}
 
-    out = outStream.str();
+void Get::Execute(Storage &storage, const std::string &args, Output &out) {
+    // Storage shares large values and copies small ones, which output would copy anyway
+    Storage::Entry *entries = LookupAll(storage, _keys);
+    for (size_t i = 0; i < _keys.size(); i++) {
+        Storage::Entry &entry = entries[i];
+        if (!entry.found)
+            continue;
+
+        char header[24];
+        size_t size = entry.shared ? entry.shared->size() : entry.value.size();
+        int header_len = snprintf(header, sizeof(header), " 0 %zu\r\n", size);
+        out.Append("VALUE ", 6);
+        out.Append(_keys[i].data(), _keys[i].size());
+        out.Append(header, header_len);
+        if (entry.shared) {
+            out.Append(std::move(entry.shared));
+        } else {
+            out.Append(entry.value);
+        }
+        out.Append("\r\n", 2);
+    }
+    out.Append("END", 3); // networking layer should add the last \r\n
 }
 
 } // namespace Execute
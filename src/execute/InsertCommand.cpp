@@ -0,0 +1,35 @@
+#include <afina/execute/InsertCommand.h>
+
+#include <ctime>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// memcached protocol: expire time of more than that is an absolute unix time
+constexpr int32_t kMaxRelativeExpire = 60 * 60 * 24 * 30;
+
+} // namespace
+
+// See InsertCommand.h
+bool InsertCommand::TTL(uint32_t &ttl) const {
+    if (_expire < 0) {
+        return false;
+    }
+
+    if (_expire <= kMaxRelativeExpire) {
+        ttl = _expire;
+        return true;
+    }
+
+    std::time_t now = std::time(nullptr);
+    if (_expire <= now) {
+        return false;
+    }
+    ttl = _expire - now;
+    return true;
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,93 @@
+#include <afina/execute/Output.h>
+
+namespace Afina {
+namespace Execute {
+
+constexpr size_t Output::kMinReferenced;
+
+// See Output.h
+void Output::Append(const char *data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    if (_pieces.empty() || _pieces.back().value) {
+        _pieces.push_back(Piece{nullptr, _text.size(), 0});
+    }
+    _text.append(data, size);
+    _pieces.back().size += size;
+    _size += size;
+}
+
+// See Output.h
+void Output::Append(std::shared_ptr<const std::string> value) {
+    // Small value costs less to copy than to pass as separate iovec entry
+    if (value->size() < kMinReferenced) {
+        Append(value->data(), value->size());
+        return;
+    }
+
+    _size += value->size();
+    _pieces.push_back(Piece{std::move(value), 0, 0});
+    _pieces.back().size = _pieces.back().value->size();
+}
+
+// See Output.h
+size_t Output::Prepare(struct iovec *iov, size_t count) const {
+    size_t filled = 0;
+    for (auto it = _pieces.begin(); it != _pieces.end() && filled < count; it++, filled++) {
+        iov[filled].iov_base = const_cast<char *>(Data(*it));
+        iov[filled].iov_len = it->size;
+    }
+    return filled;
+}
+
+// See Output.h
+void Output::Consume(size_t size) {
+    _size -= size;
+    while (size > 0) {
+        Piece &front = _pieces.front();
+        if (size < front.size) {
+            front.offset += size;
+            front.size -= size;
+            break;
+        }
+
+        size -= front.size;
+        _pieces.pop_front();
+    }
+
+    // Buffer keeps its capacity, so steady state connection doesn't allocate memory for output
+    if (_pieces.empty()) {
+        _text.clear();
+        return;
+    }
+
+    // Text already sent is dropped once it takes most of the buffer, so that buffer doesn't grow while
+    // connection always has something pending
+    size_t sent = _text.size();
+    for (auto &piece : _pieces) {
+        if (!piece.value) {
+            sent = piece.offset;
+            break;
+        }
+    }
+    if (sent > _text.size() / 2) {
+        _text.erase(0, sent);
+        for (auto &piece : _pieces) {
+            if (!piece.value) {
+                piece.offset -= sent;
+            }
+        }
+    }
+}
+
+// See Output.h
+void Output::Clear() {
+    _text.clear();
+    _pieces.clear();
+    _size = 0;
+}
+
+} // namespace Execute
+} // namespace Afina
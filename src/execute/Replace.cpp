@@ -1,8 +1,6 @@
 #include <afina/Storage.h>
 #include <afina/execute/Replace.h>
 
-#include <iostream>
-
 namespace Afina {
 namespace Execute {
 
@@ -10,13 +8,13 @@ namespace Execute {
 // already hold data for this key".
 
 void Replace::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Replace(" << _key << "): " << args << std::endl;
-    std::string value;
-    if (storage.Get(_key, value)) {
-        storage.Set(_key, args);
-        out = "STORED";
+    const std::string &key = StorageKey(_key);
+    uint32_t ttl;
+    bool stored = TTL(ttl) ? storage.Set(key, args, ttl) : storage.Delete(key);
+    if (stored) {
+        out.assign("STORED");
     } else {
-        out = "NOT_STORED";
+        out.assign("NOT_STORED");
     }
 }
 
@@ -1,16 +1,19 @@
 #include <afina/Storage.h>
 #include <afina/execute/Set.h>
 
-#include <iostream>
-
 namespace Afina {
 namespace Execute {
 
 // memcached protocol: "set" means "store this data".
 void Set::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Set(" << _key << "): " << args << std::endl;
-    storage.Put(_key, args);
-    out = "STORED";
+    uint32_t ttl;
+    if (TTL(ttl)) {
+        storage.Put(StorageKey(_key), args, ttl);
+    } else {
+        // Item stored expired is never seen, but it still replaces the old one
+        storage.Delete(StorageKey(_key));
+    }
+    out.assign("STORED");
 }
 
 } // namespace Execute
@@ -1,6 +1,8 @@
 #include <chrono>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <sstream>
 
 #include <atomic>
 #include <semaphore.h>
@@ -11,6 +13,8 @@
 
 #include <afina/Storage.h>
 #include <afina/Version.h>
+#include <afina/allocator/Slab.h>
+#include <afina/allocator/SmallAlloc.h>
 #include <afina/logging/Service.h>
 #include <afina/network/Server.h>
 
@@ -19,8 +23,15 @@
 #include "network/mt_nonblocking/ServerImpl.h"
 #include "network/st_blocking/ServerImpl.h"
 #include "network/st_nonblocking/ServerImpl.h"
+#ifdef AFINA_HAVE_IO_URING
+#include "network/uring/ServerImpl.h"
+#endif
 
+#include "storage/ClockLRU.h"
+#include "storage/FlatLRU.h"
+#include "storage/LockFreeLRU.h"
 #include "storage/SimpleLRU.h"
+#include "storage/StripedLRU.h"
 #include "storage/ThreadSafeSimpleLRU.h"
 
 #include <afina/concurrency/Executor.h>
@@ -52,10 +63,94 @@ public:
             storage_type = options["storage"].as<std::string>();
         }
 
+        Afina::Backend::SimpleLRU::Policy policy = Afina::Backend::SimpleLRU::Policy::LRU;
+        if (options.count("policy") > 0) {
+            std::string policy_type = options["policy"].as<std::string>();
+            if (policy_type == "slru") {
+                policy = Afina::Backend::SimpleLRU::Policy::SegmentedLRU;
+            } else if (policy_type == "tinylfu") {
+                policy = Afina::Backend::SimpleLRU::Policy::TinyLFU;
+            } else if (policy_type != "lru") {
+                throw std::runtime_error("Unknown eviction policy");
+            }
+            if (storage_type != "st_lru" && storage_type != "mt_lru" && storage_type != "striped_lru") {
+                throw std::runtime_error("Eviction policy is supported by st_lru, mt_lru and striped_lru only");
+            }
+        }
+
+        // Memory limit of the storage, index is sized for the expected number of items up front
+        size_t memory = size_t(64) << 20;
+        if (options.count("memory") > 0) {
+            memory = ParseSize(options["memory"].as<std::string>());
+        }
+        size_t expected_items = 0;
+        if (options.count("expected-items") > 0) {
+            expected_items = options["expected-items"].as<size_t>();
+        }
+
+        // Allocator of the items, only LRU storages could take other one than malloc
+        std::string allocator = "malloc";
+        if (options.count("allocator") > 0) {
+            allocator = options["allocator"].as<std::string>();
+            if (allocator != "malloc" && allocator != "slab" && allocator != "arena" && allocator != "small") {
+                throw std::runtime_error("Unknown allocator");
+            }
+            if (allocator == "small" && storage_type != "st_lru" && storage_type != "mt_lru" &&
+                storage_type != "striped_lru") {
+                throw std::runtime_error("Small objects allocator is supported by st_lru, mt_lru and striped_lru only");
+            }
+            if ((allocator == "slab" || allocator == "arena") && storage_type != "st_lru" && storage_type != "mt_lru") {
+                throw std::runtime_error("Slab allocator and values arena are supported by st_lru and mt_lru only");
+            }
+        }
+
+        // Free memory watermarks of the background reclaim, in percent of the memory limit
+        size_t low_watermark = 0, high_watermark = 0;
+        if (options.count("watermarks") > 0) {
+            std::stringstream watermarks(options["watermarks"].as<std::string>());
+            char comma = 0;
+            watermarks >> low_watermark >> comma >> high_watermark;
+            if (!watermarks || comma != ',' || low_watermark > high_watermark || high_watermark >= 100) {
+                throw std::runtime_error("Watermarks must be LOW,HIGH percents with LOW <= HIGH < 100");
+            }
+            if (storage_type != "mt_lru" && storage_type != "striped_lru") {
+                throw std::runtime_error("Background reclaim is supported by mt_lru and striped_lru only");
+            }
+        }
+
         if (storage_type == "st_lru") {
-            storage = std::make_shared<Afina::Backend::SimpleLRU>();
+            auto lru = MakeLRU<Afina::Backend::SimpleLRU>(memory, allocator, policy);
+            lru->Reserve(expected_items);
+            storage = lru;
         } else if (storage_type == "mt_lru") {
-            storage = std::make_shared<Afina::Backend::ThreadSafeSimpleLRU>();
+            auto lru = MakeLRU<Afina::Backend::ThreadSafeSimpleLRU>(memory, allocator, policy);
+            lru->Reserve(expected_items);
+            lru->SetWatermarks(low_watermark, high_watermark);
+            storage = lru;
+        } else if (storage_type == "flat_lru") {
+            auto lru = std::make_shared<Afina::Backend::FlatLRU>(memory);
+            lru->Reserve(expected_items);
+            storage = lru;
+        } else if (storage_type == "clock_lru") {
+            auto lru = std::make_shared<Afina::Backend::ClockLRU>(memory);
+            lru->Reserve(expected_items);
+            storage = lru;
+        } else if (storage_type == "lockfree_lru") {
+            storage = std::make_shared<Afina::Backend::LockFreeLRU>(memory, expected_items);
+        } else if (storage_type == "striped_lru") {
+            size_t stripes = 4;
+            if (options.count("stripes") > 0) {
+                stripes = options["stripes"].as<size_t>();
+            }
+            std::shared_ptr<Afina::Backend::StripedLRU> striped;
+            if (allocator == "small") {
+                striped = std::make_shared<Afina::Backend::StripedLRU>(stripes, memory, MakeSmallAlloc(memory), policy);
+            } else {
+                striped = std::make_shared<Afina::Backend::StripedLRU>(stripes, memory, policy);
+            }
+            striped->Reserve(expected_items);
+            striped->SetWatermarks(low_watermark, high_watermark);
+            storage = striped;
         } else {
             throw std::runtime_error("Unknown storage type");
         }
@@ -74,6 +169,16 @@ public:
             server = std::make_shared<Afina::Network::STnonblock::ServerImpl>(storage, logService);
         } else if (network_type == "mt_nonblock") {
             server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(storage, logService);
+        } else if (network_type == "mt_reuseport") {
+            server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(
+                storage, logService, Afina::Network::MTnonblock::ServerImpl::Mode::ReusePort);
+        } else if (network_type == "mt_rebalance") {
+            server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(
+                storage, logService, Afina::Network::MTnonblock::ServerImpl::Mode::Rebalance);
+#ifdef AFINA_HAVE_IO_URING
+        } else if (network_type == "uring") {
+            server = std::make_shared<Afina::Network::Uring::ServerImpl>(storage, logService);
+#endif
         } else {
             throw std::runtime_error("Unknown network type");
         }
@@ -106,6 +211,64 @@ public:
     }
 
 private:
+    // Pools need some spare slabs on top of the budget, each thread keeps its own ones
+    static std::shared_ptr<Afina::Allocator::SmallAlloc> MakeSmallAlloc(size_t memory) {
+        return std::make_shared<Afina::Allocator::SmallAlloc>(memory + memory / 4);
+    }
+
+    // Creates st_lru or mt_lru storage which places items with the given allocator
+    template <typename LRU>
+    static std::shared_ptr<LRU> MakeLRU(size_t memory, const std::string &allocator,
+                                        Afina::Backend::SimpleLRU::Policy policy) {
+        if (allocator == "slab") {
+            std::unique_ptr<Afina::Allocator::Slab> slab(new Afina::Allocator::Slab(memory));
+            return std::make_shared<LRU>(std::move(slab), policy);
+        } else if (allocator == "arena") {
+            return std::make_shared<LRU>(memory, memory, policy);
+        } else if (allocator == "small") {
+            return std::make_shared<LRU>(memory, MakeSmallAlloc(memory), policy);
+        }
+        return std::make_shared<LRU>(memory, policy);
+    }
+
+    // Parses number of bytes with optional K, M or G suffix
+    static size_t ParseSize(const std::string &text) {
+        // Digits only, stream extraction would take sign and wrap negative number around
+        size_t pos = 0, size = 0;
+        for (; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; pos++) {
+            size_t digit = text[pos] - '0';
+            if (size > (std::numeric_limits<size_t>::max() - digit) / 10) {
+                throw std::runtime_error("Memory size is too large: " + text);
+            }
+            size = size * 10 + digit;
+        }
+        if (pos == 0) {
+            throw std::runtime_error("Invalid memory size: " + text);
+        }
+
+        std::string suffix = text.substr(pos);
+        unsigned shift = 0;
+        if (suffix == "K" || suffix == "k") {
+            shift = 10;
+        } else if (suffix == "M" || suffix == "m") {
+            shift = 20;
+        } else if (suffix == "G" || suffix == "g") {
+            shift = 30;
+        } else if (!suffix.empty()) {
+            throw std::runtime_error("Invalid memory size: " + text);
+        }
+
+        if (size > (std::numeric_limits<size_t>::max() >> shift)) {
+            throw std::runtime_error("Memory size is too large: " + text);
+        }
+        size <<= shift;
+
+        if (size == 0) {
+            throw std::runtime_error("Memory size must be positive");
+        }
+        return size;
+    }
+
     std::shared_ptr<Afina::Logging::Config> logConfig;
     std::shared_ptr<Afina::Logging::Service> logService;
 
@@ -130,6 +293,18 @@ int main(int argc, char **argv) {
         // TODO: use custom cxxopts::value to print options possible values in help message
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
+        options.add_options()("m,memory", "Storage memory limit in bytes, K, M or G suffix is allowed, 64M by default",
+                              cxxopts::value<std::string>());
+        options.add_options()("expected-items", "Number of items to size storage index for up front",
+                              cxxopts::value<size_t>());
+        options.add_options()("stripes", "Number of shards for striped_lru storage", cxxopts::value<size_t>());
+        options.add_options()("policy", "Eviction policy of lru storages: lru, slru or tinylfu",
+                              cxxopts::value<std::string>());
+        options.add_options()("allocator", "Allocator of lru storages items: malloc, slab, arena or small",
+                              cxxopts::value<std::string>());
+        options.add_options()("watermarks",
+                              "Background eviction of mt_lru and striped_lru: LOW,HIGH percents of free memory",
+                              cxxopts::value<std::string>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
         options.add_options()("h,help", "Print usage info");
         options.parse(argc, argv);
@@ -143,9 +318,14 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    // Start boot sequence
+    // Start boot sequence, invalid option values are reported the same way as unknown options
     Application app;
-    app.Configure(options);
+    try {
+        app.Configure(options);
+    } catch (std::runtime_error &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
 
     // POSIX specific staff
     {
@@ -0,0 +1,51 @@
+#include "Session.h"
+
+#include <cerrno>
+
+#include <sys/uio.h>
+
+namespace Afina {
+namespace Network {
+namespace Blocking {
+
+namespace {
+
+// Pieces of output passed to a single writev
+constexpr std::size_t kMaxIov = 64;
+
+} // namespace
+
+// See Session.h
+Session::Session(Afina::Storage &storage) : _processor(storage) {}
+
+// See Session.h
+Session::~Session() {}
+
+// See Session.h
+void Session::Process(const char *data, std::size_t size) { _processor.Process(data, size, _output); }
+
+// See Session.h
+bool Session::Send(int socket) {
+    struct iovec iov[kMaxIov];
+    while (!_output.empty()) {
+        ssize_t sent = writev(socket, iov, _output.Prepare(iov, kMaxIov));
+        if (sent > 0) {
+            _output.Consume(sent);
+        } else if (sent == -1 && errno == EINTR) {
+            continue;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// See Session.h
+void Session::Reset() {
+    _processor.Reset();
+    _output.Clear();
+}
+
+} // namespace Blocking
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,59 @@
+#ifndef AFINA_NETWORK_BLOCKING_SESSION_H
+#define AFINA_NETWORK_BLOCKING_SESSION_H
+
+#include <cstddef>
+
+#include <afina/execute/Output.h>
+
+#include "protocol/Processor.h"
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+
+namespace Network {
+namespace Blocking {
+
+/**
+ * # Protocol state of a blocking connection
+ * Shared by servers reading socket with plain read(). Every command completed by the block read is
+ * executed right away, see Protocol::Processor, responses are collected in the output, so that responses
+ * to all pipelined commands of the block are sent with as few writev as possible.
+ */
+class Session {
+public:
+    explicit Session(Afina::Storage &storage);
+    ~Session();
+
+    /**
+     * Executes every command completed by the block, throws std::runtime_error if input is malformed.
+     * Responses to commands executed before the failure stay in the output
+     */
+    void Process(const char *data, std::size_t size);
+
+    /**
+     * Sends the whole output, returns false if connection is broken
+     */
+    bool Send(int socket);
+
+    /**
+     * Drops partial command and pending output, e.g. before the next connection
+     */
+    void Reset();
+
+private:
+    Session(const Session &) = delete;
+    Session &operator=(const Session &) = delete;
+
+    Protocol::Processor _processor;
+
+    // Responses waiting to be sent
+    Execute::Output _output;
+};
+
+} // namespace Blocking
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_BLOCKING_SESSION_H
@@ -1,25 +1,135 @@
 #include "Connection.h"
 
-#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
 
 namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
+namespace {
+
+// Connection stops reading new commands while that many bytes are waiting to be sent
+constexpr size_t kMaxOutput = 64 * 1024;
+
+// Pieces of output passed to a single sendmsg
+constexpr size_t kMaxIov = 64;
+
+} // namespace
+
 // See Connection.h
-void Connection::Start() { std::cout << "Start" << std::endl; }
+Connection::Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl)
+    : _socket(s), _pStorage(std::move(ps)), _logger(std::move(pl)), _is_alive(false), _eof(false),
+      _processor(*_pStorage), _load_period(0), _load(0), _next(nullptr) {
+    std::memset(&_event, 0, sizeof(struct epoll_event));
+    _event.data.ptr = this;
+}
 
 // See Connection.h
-void Connection::OnError() { std::cout << "OnError" << std::endl; }
+Connection::~Connection() { close(_socket); }
+
+// See Connection.h
+void Connection::Start() {
+    _logger->debug("Start connection on descriptor {}", _socket);
+    _is_alive = true;
+    _event.events = EPOLLIN;
+
+    // Responses are sent as soon as they are ready, Nagle would hold the tail of a long pipeline until
+    // client acknowledges previous data, which it may delay
+    int opts = 1;
+    setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &opts, sizeof(opts));
+}
 
 // See Connection.h
-void Connection::OnClose() { std::cout << "OnClose" << std::endl; }
+void Connection::OnError() {
+    _logger->error("Error on descriptor {}", _socket);
+    _is_alive = false;
+}
 
 // See Connection.h
-void Connection::DoRead() { std::cout << "DoRead" << std::endl; }
+void Connection::OnClose() {
+    _logger->debug("Connection on descriptor {} closed", _socket);
+    _is_alive = false;
+}
 
 // See Connection.h
-void Connection::DoWrite() { std::cout << "DoWrite" << std::endl; }
+void Connection::DoRead() {
+    ssize_t readed_bytes = read(_socket, _read_buffer, sizeof(_read_buffer));
+    if (readed_bytes > 0) {
+        _logger->debug("Got {} bytes from descriptor {}", readed_bytes, _socket);
+        try {
+            _processor.Process(_read_buffer, readed_bytes, _output);
+        } catch (std::runtime_error &ex) {
+            _logger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
+            _output.Append("CLIENT_ERROR ");
+            _output.Append(ex.what(), strlen(ex.what()));
+            _output.Append("\r\n", 2);
+            _eof = true;
+        }
+    } else if (readed_bytes == 0) {
+        _logger->debug("Client on descriptor {} has nothing more to send", _socket);
+        _eof = true;
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        OnError();
+        return;
+    }
+
+    // Try to send responses right away, usually socket has room for them and EPOLLOUT isn't needed at all
+    DoWrite();
+}
+
+// See Connection.h
+void Connection::DoWrite() {
+    struct iovec iov[kMaxIov];
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+
+    while (!_output.empty()) {
+        msg.msg_iovlen = _output.Prepare(iov, kMaxIov);
+        ssize_t sent = sendmsg(_socket, &msg, MSG_NOSIGNAL);
+        if (sent > 0) {
+            _output.Consume(sent);
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else if (errno != EINTR) {
+            OnError();
+            return;
+        }
+    }
+
+    UpdateEvents();
+}
+
+// See Connection.h
+void Connection::UpdateEvents() {
+    size_t pending = _output.size();
+
+    uint32_t events = 0;
+    if (!_eof && pending < kMaxOutput) {
+        events |= EPOLLIN;
+    }
+    if (pending > 0) {
+        events |= EPOLLOUT;
+    }
+
+    // Client is gone and everything is sent
+    if (events == 0) {
+        _is_alive = false;
+    }
+    _event.events = events;
+}
 
 } // namespace MTnonblock
 } // namespace Network
@@ -2,21 +2,41 @@
 #define AFINA_NETWORK_MT_NONBLOCKING_CONNECTION_H
 
 #include <cstring>
+#include <memory>
+#include <string>
 
 #include <sys/epoll.h>
 
+#include <afina/execute/Output.h>
+
+#include "protocol/Processor.h"
+
+namespace spdlog {
+class logger;
+}
+
 namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+
 namespace Network {
 namespace MTnonblock {
 
+/**
+ * # Client connection served by workers
+ * Connection is registered in the shared epoll with EPOLLONESHOT, so that only one worker at a time
+ * works with it and no locking is needed. Input is parsed and executed right after read, responses
+ * are queued in the output buffer and sent immediately as far as socket allows. Connection asks
+ * for EPOLLOUT only while there is something left to send, and stops reading while too much output
+ * is pending, so that client that doesn't read responses can't make server buffer them without bound.
+ */
 class Connection {
 public:
-    Connection(int s) : _socket(s) {
-        std::memset(&_event, 0, sizeof(struct epoll_event));
-        _event.data.ptr = this;
-    }
+    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl);
+    ~Connection();
 
-    inline bool isAlive() const { return true; }
+    inline bool isAlive() const { return _is_alive; }
 
     void Start();
 
@@ -29,9 +49,36 @@ protected:
 private:
     friend class Worker;
     friend class ServerImpl;
+    friend class Rebalancer;
+
+    // Sets epoll interest according to the connection state, connection dies once it has nothing to do
+    void UpdateEvents();
 
     int _socket;
     struct epoll_event _event;
+
+    std::shared_ptr<Afina::Storage> _pStorage;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    bool _is_alive;
+
+    // Client won't send anything more or sent garbage, connection is closed once output is sent
+    bool _eof;
+
+    // Everything read is processed right away, partial command is kept by processor
+    char _read_buffer[4096];
+    Protocol::Processor _processor;
+
+    // Responses not yet sent, values there are referenced rather than copied
+    Execute::Output _output;
+
+    // Events served by the owning worker during its rebalance period, counter is valid only while
+    // _load_period matches the current period of the worker
+    uint32_t _load_period;
+    uint32_t _load;
+
+    // Link in the queue of connections handed over to another worker
+    Connection *_next;
 };
 
 } // namespace MTnonblock
@@ -0,0 +1,88 @@
+#include "Rebalancer.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+namespace MTnonblock {
+
+namespace {
+
+// Loads are published as integers, atomic double isn't guaranteed to be lock-free
+constexpr double kLoadScale = 1000.0;
+
+// Worker that is less busy gives nothing away
+constexpr double kMinLoad = 0.5;
+
+// Smaller difference between workers is considered to be a noise
+constexpr double kMinGap = 0.2;
+
+} // namespace
+
+// See Rebalancer.h
+Rebalancer::Rebalancer(size_t workers) : _slots(workers) {
+    for (size_t i = 0; i < _slots.size(); i++) {
+        _slots[i].event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_slots[i].event_fd == -1) {
+            for (size_t j = 0; j < i; j++) {
+                close(_slots[j].event_fd);
+            }
+            throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+        }
+    }
+}
+
+// See Rebalancer.h
+Rebalancer::~Rebalancer() {
+    for (size_t i = 0; i < _slots.size(); i++) {
+        close(_slots[i].event_fd);
+    }
+}
+
+// See Rebalancer.h
+void Rebalancer::Report(size_t worker, double load) {
+    _slots[worker].load.store(static_cast<uint32_t>(load * kLoadScale), std::memory_order_relaxed);
+}
+
+// See Rebalancer.h
+int Rebalancer::Target(size_t worker, double load, double share) {
+    if (load < kMinLoad) {
+        return -1;
+    }
+
+    int target = -1;
+    double min_load = load;
+    for (size_t i = 0; i < _slots.size(); i++) {
+        double other = _slots[i].load.load(std::memory_order_relaxed) / kLoadScale;
+        if (i != worker && other < min_load) {
+            target = i;
+            min_load = other;
+        }
+    }
+
+    // After the move both workers must be less busy than this one is now
+    double gap = load - min_load;
+    if (target == -1 || gap < kMinGap || share >= gap) {
+        return -1;
+    }
+
+    _slots[target].load.fetch_add(static_cast<uint32_t>(share * kLoadScale), std::memory_order_relaxed);
+    return target;
+}
+
+// See Rebalancer.h
+void Rebalancer::Send(size_t worker, Connection *pconn) {
+    _slots[worker].queue.Push(pconn);
+    eventfd_write(_slots[worker].event_fd, 1);
+}
+
+} // namespace MTnonblock
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,80 @@
+#ifndef AFINA_NETWORK_MT_NONBLOCKING_REBALANCER_H
+#define AFINA_NETWORK_MT_NONBLOCKING_REBALANCER_H
+
+#include <atomic>
+
+#include <afina/concurrency/AlignedArray.h>
+#include <afina/concurrency/MPSCQueue.h>
+
+#include "Connection.h"
+
+namespace Afina {
+namespace Network {
+namespace MTnonblock {
+
+/**
+ * # Moves connections from overloaded workers to idle ones
+ * Each worker has private epoll, so connection stays on the same thread unless moved explicitly.
+ * Workers periodically publish fraction of time they spent serving connections. Overloaded worker
+ * asks for a target and hands its busiest connection over: removes it from own epoll, puts into the
+ * target's lock-free queue and wakes target up through its eventfd. Target registers connection in
+ * its epoll, so that connection is owned by a single thread at any time.
+ *
+ * Connection is moved only if that makes the busiest of two workers less loaded, so that a single
+ * heavy client doesn't jump between workers forever.
+ */
+class Rebalancer {
+public:
+    explicit Rebalancer(size_t workers);
+    ~Rebalancer();
+
+    /**
+     * Descriptor that becomes readable once connections are handed over to the worker, worker must read
+     * it before taking connections
+     */
+    int WakeupFd(size_t worker) const { return _slots[worker].event_fd; }
+
+    /**
+     * Publishes worker load, fraction of the last period it spent serving connections
+     */
+    void Report(size_t worker, double load);
+
+    /**
+     * Returns worker that should take connection which has given share in the worker load, or -1
+     * if load is balanced enough. Share is added to the target load until target reports again, so
+     * that many workers don't pick the same target at once
+     */
+    int Target(size_t worker, double load, double share);
+
+    /**
+     * Hands connection over to the target worker, connection must be removed from the epoll of the
+     * current one beforehand
+     */
+    void Send(size_t worker, Connection *pconn);
+
+    /**
+     * Takes all connections handed over to the worker, list is linked through Connection::_next
+     */
+    Connection *Receive(size_t worker) { return _slots[worker].queue.PopAll(); }
+
+private:
+    Rebalancer(const Rebalancer &) = delete;
+    Rebalancer &operator=(const Rebalancer &) = delete;
+
+    // State of worker, aligned so that loads published by different workers don't share cache line
+    struct alignas(64) Slot {
+        Slot() : load(0), event_fd(-1) {}
+
+        std::atomic<uint32_t> load;
+        Afina::Concurrency::MPSCQueue<Connection, &Connection::_next> queue;
+        int event_fd;
+    };
+
+    Afina::Concurrency::AlignedArray<Slot> _slots;
+};
+
+} // namespace MTnonblock
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_NONBLOCKING_REBALANCER_H
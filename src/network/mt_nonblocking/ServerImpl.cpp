@@ -22,6 +22,7 @@
 #include <afina/logging/Service.h>
 
 #include "Connection.h"
+#include "Rebalancer.h"
 #include "Utils.h"
 #include "Worker.h"
 
@@ -29,57 +30,68 @@ namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
-// See Server.h
-ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
+namespace {
 
-// See Server.h
-ServerImpl::~ServerImpl() {}
+// Address space for connection objects is reserved for that many of them, physical memory is taken
+// on demand, so the pool doesn't limit the server before the descriptor limit does
+constexpr size_t kMaxConnections = 1 << 20;
 
-// See Server.h
-void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
-    _logger = pLogging->select("network");
-    _logger->info("Start network service");
-
-    sigset_t sig_mask;
-    sigemptyset(&sig_mask);
-    sigaddset(&sig_mask, SIGPIPE);
-    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
-        throw std::runtime_error("Unable to mask SIGPIPE");
-    }
-
-    // Create server socket
+// Opens non-blocking socket listening on the given port, many sockets with SO_REUSEPORT could share it
+int open_server_socket(uint16_t port, bool reuseport) {
     struct sockaddr_in server_addr;
     std::memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;         // IPv4
     server_addr.sin_port = htons(port);       // TCP port number
     server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
 
-    _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (_server_socket == -1) {
+    int server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (server_socket == -1) {
         throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
     }
 
     int opts = 1;
-    if (setsockopt(_server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
-        close(_server_socket);
+    if (setsockopt(server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (reuseport && setsockopt(server_socket, SOL_SOCKET, SO_REUSEPORT, &opts, sizeof(opts)) == -1) {
+        close(server_socket);
         throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
     }
 
-    if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
-        close(_server_socket);
+    if (bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        close(server_socket);
         throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
     }
 
-    make_socket_non_blocking(_server_socket);
-    if (listen(_server_socket, 5) == -1) {
-        close(_server_socket);
+    make_socket_non_blocking(server_socket);
+    if (listen(server_socket, SOMAXCONN) == -1) {
+        close(server_socket);
         throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
     }
+    return server_socket;
+}
 
-    // Start IO workers
-    _data_epoll_fd = epoll_create1(0);
-    if (_data_epoll_fd == -1) {
-        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+} // namespace
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, Mode mode)
+    : Server(ps, pl), _mode(mode), _server_socket(-1), _data_epoll_fd(-1), _event_fd(-1) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+    _logger->info("Start network service");
+
+    sigset_t sig_mask;
+    sigemptyset(&sig_mask);
+    sigaddset(&sig_mask, SIGPIPE);
+    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
+        throw std::runtime_error("Unable to mask SIGPIPE");
     }
 
     _event_fd = eventfd(0, EFD_NONBLOCK);
@@ -87,23 +99,98 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
         throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
     }
 
-    struct epoll_event event;
-    event.events = EPOLLIN;
-    event.data.ptr = nullptr;
-    if (epoll_ctl(_data_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
-        throw std::runtime_error("Failed to add eventfd descriptor to epoll");
-    }
+    _connections_arena.reset(new Afina::Allocator::Arena(kMaxConnections * sizeof(Connection)));
+    _connections.reset(new Afina::Allocator::MemPool(*_connections_arena, sizeof(Connection)));
 
-    _workers.reserve(n_workers);
-    for (int i = 0; i < n_workers; i++) {
-        _workers.emplace_back(pStorage, pLogging);
-        _workers.back().Start(_data_epoll_fd);
+    // Each worker accepts and serves connections on its own, kernel balances clients between sockets
+    if (_mode != Mode::Shared) {
+        if (_mode == Mode::Rebalance) {
+            _rebalancer.reset(new Rebalancer(n_workers));
+        }
+
+        _workers.reserve(n_workers);
+        try {
+            for (int i = 0; i < n_workers; i++) {
+                int worker_socket = open_server_socket(port, true);
+                int worker_epoll = epoll_create1(0);
+                if (worker_epoll == -1) {
+                    close(worker_socket);
+                    throw std::runtime_error("Failed to create epoll file descriptor: " +
+                                             std::string(strerror(errno)));
+                }
+                _worker_sockets.push_back(worker_socket);
+                _worker_epolls.push_back(worker_epoll);
+
+                struct epoll_event event;
+                event.events = EPOLLIN;
+                event.data.ptr = nullptr;
+                if (epoll_ctl(worker_epoll, EPOLL_CTL_ADD, _event_fd, &event)) {
+                    throw std::runtime_error("Failed to add eventfd descriptor to epoll");
+                }
+
+                _workers.emplace_back(pStorage, pLogging, _connections.get());
+                _workers.back().Start(worker_epoll, worker_socket, _rebalancer.get(), i);
+            }
+        } catch (...) {
+            // Workers started so far are stopped, all descriptors taken are given back
+            Stop();
+            for (auto &w : _workers) {
+                w.Join();
+            }
+            _workers.clear();
+            CloseWorkerDescriptors();
+            close(_event_fd);
+            _event_fd = -1;
+            throw;
+        }
+        return;
     }
 
-    // Start acceptors
-    _acceptors.reserve(n_acceptors);
-    for (int i = 0; i < n_acceptors; i++) {
-        _acceptors.emplace_back(&ServerImpl::OnRun, this);
+    try {
+        // Create server socket
+        _server_socket = open_server_socket(port, false);
+
+        // Start IO workers
+        _data_epoll_fd = epoll_create1(0);
+        if (_data_epoll_fd == -1) {
+            throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+        }
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        if (epoll_ctl(_data_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
+            throw std::runtime_error("Failed to add eventfd descriptor to epoll");
+        }
+
+        _workers.reserve(n_workers);
+        for (int i = 0; i < n_workers; i++) {
+            _workers.emplace_back(pStorage, pLogging, _connections.get(), &_shared_live);
+            _workers.back().Start(_data_epoll_fd);
+        }
+
+        // Start acceptors
+        _acceptors.reserve(n_acceptors);
+        for (int i = 0; i < n_acceptors; i++) {
+            _acceptors.emplace_back(&ServerImpl::OnRun, this);
+        }
+    } catch (...) {
+        // Threads started so far are stopped, all descriptors taken are given back
+        Stop();
+        Join();
+        _acceptors.clear();
+        _workers.clear();
+        if (_data_epoll_fd != -1) {
+            close(_data_epoll_fd);
+            _data_epoll_fd = -1;
+        }
+        if (_server_socket != -1) {
+            close(_server_socket);
+            _server_socket = -1;
+        }
+        close(_event_fd);
+        _event_fd = -1;
+        throw;
     }
 }
 
@@ -130,6 +217,34 @@ void ServerImpl::Join() {
     for (auto &w : _workers) {
         w.Join();
     }
+    CloseWorkerDescriptors();
+
+    // Workers close connections of private epolls themselves, the rest is not owned by any thread
+    if (_connections) {
+        _shared_live.DestroyAll(*_connections);
+    }
+    if (_rebalancer) {
+        for (size_t i = 0; i < _workers.size(); i++) {
+            Connection *pconn = _rebalancer->Receive(i);
+            while (pconn != nullptr) {
+                Connection *next = pconn->_next;
+                _connections->destroy(pconn);
+                pconn = next;
+            }
+        }
+    }
+}
+
+// See ServerImpl.h
+void ServerImpl::CloseWorkerDescriptors() {
+    for (int fd : _worker_epolls) {
+        close(fd);
+    }
+    for (int fd : _worker_sockets) {
+        close(fd);
+    }
+    _worker_epolls.clear();
+    _worker_sockets.clear();
 }
 
 // See ServerImpl.h
@@ -193,21 +308,28 @@ void ServerImpl::OnRun() {
                 }
 
                 // Register the new FD to be monitored by epoll.
-                Connection *pc = new Connection(infd);
+                Connection *pc = _connections->create<Connection>(infd, pStorage, _logger);
                 if (pc == nullptr) {
-                    throw std::runtime_error("Failed to allocate connection");
+                    _logger->error("Too many connections, drop descriptor {}", infd);
+                    close(infd);
+                    continue;
                 }
 
-                // Register connection in worker's epoll
+                // Register connection in worker's epoll, worker could close it right after that, so it
+                // becomes live beforehand
                 pc->Start();
                 if (pc->isAlive()) {
                     pc->_event.events |= EPOLLONESHOT;
+                    _shared_live.Add(pc);
                     int epoll_ctl_retval;
                     if ((epoll_ctl_retval = epoll_ctl(_data_epoll_fd, EPOLL_CTL_ADD, pc->_socket, &pc->_event))) {
                         _logger->debug("epoll_ctl failed during connection register in workers'epoll: error {}", epoll_ctl_retval);
                         pc->OnError();
-                        delete pc;
+                        _shared_live.Remove(pc);
+                        _connections->destroy(pc);
                     }
+                } else {
+                    _connections->destroy(pc);
                 }
             }
         }
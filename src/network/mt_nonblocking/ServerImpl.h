@@ -1,11 +1,16 @@
 #ifndef AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 #define AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 
+#include <memory>
 #include <thread>
 #include <vector>
 
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/MemPool.h>
 #include <afina/network/Server.h>
 
+#include "Worker.h"
+
 namespace spdlog {
 class logger;
 }
@@ -14,16 +19,26 @@ namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
-// Forward declaration, see Worker.h
-class Worker;
+// Forward declaration, see Rebalancer.h
+class Rebalancer;
 
 /**
  * # Network resource manager implementation
- * Epoll based server
+ * Epoll based server, works in one of modes:
+ * - Shared: acceptors put connections into epoll shared by all workers, each event is taken by one
+ *   worker thanks to EPOLLONESHOT, so connection has to be rearmed after every event and could be
+ *   served by different threads during its life
+ * - ReusePort: each worker has private epoll and own listening socket bound to the same port with
+ *   SO_REUSEPORT, kernel spreads new clients between sockets. Connection stays with the worker that
+ *   accepted it, epoll interest is changed only when connection needs different events
+ * - Rebalance: same as ReusePort, but busy connections are moved from overloaded workers to idle ones,
+ *   see Rebalancer.h
  */
 class ServerImpl : public Server {
 public:
-    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    enum class Mode { Shared, ReusePort, Rebalance };
+
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl, Mode mode = Mode::Shared);
     ~ServerImpl();
 
     // See Server.h
@@ -39,10 +54,16 @@ protected:
     void OnRun();
     void OnNewConnection();
 
+    // Closes private sockets and epolls of workers, workers must be joined already
+    void CloseWorkerDescriptors();
+
 private:
     // logger to use
     std::shared_ptr<spdlog::logger> _logger;
 
+    // How connections are distributed between workers
+    Mode _mode;
+
     // Port to listen for new connections, permits access only from
     // inside of accept_thread
     // Read-only
@@ -63,6 +84,21 @@ private:
 
     // threads serving read/write requests
     std::vector<Worker> _workers;
+
+    // Private listening sockets and epoll instances of workers in reuseport mode
+    std::vector<int> _worker_sockets;
+    std::vector<int> _worker_epolls;
+
+    // Moves connections between workers in Rebalance mode
+    std::unique_ptr<Rebalancer> _rebalancer;
+
+    // Connections are allocated by acceptors and released by workers, so that pool is lock-free
+    // for both, arena must outlive the pool
+    std::unique_ptr<Afina::Allocator::Arena> _connections_arena;
+    std::unique_ptr<Afina::Allocator::MemPool> _connections;
+
+    // Connections registered in the shared epoll, closed by Join
+    LiveConnections _shared_live;
 };
 
 } // namespace MTnonblock
@@ -1,34 +1,59 @@
 #include "Worker.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <functional>
-#include <iostream>
+#include <stdexcept>
 
 #include <netdb.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <spdlog/logger.h>
 
+#include <afina/allocator/MemPool.h>
 #include <afina/logging/Service.h>
 
 #include "Connection.h"
+#include "Rebalancer.h"
 #include "Utils.h"
 
 namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
+namespace {
+
+// Workers report their load and move connections that often
+constexpr std::chrono::milliseconds kRebalancePeriod(100);
+
+} // namespace
+
 // See Worker.h
-Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl)
-    : _pStorage(ps), _pLogging(pl), isRunning(false), _epoll_fd(-1) {
-    // TODO: implementation here
+void LiveConnections::DestroyAll(Afina::Allocator::MemPool &pool) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (Connection *pconn : _connections) {
+        pool.destroy(pconn);
+    }
+    _connections.clear();
 }
 
+// See Worker.h
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl,
+               Afina::Allocator::MemPool *connections, LiveConnections *live)
+    : _pStorage(ps), _pLogging(pl), _connections(connections),
+      _own_live(live == nullptr ? new LiveConnections() : nullptr), _live(live == nullptr ? _own_live.get() : live),
+      isRunning(false), _epoll_fd(-1), _server_socket(-1), _rebalancer(nullptr), _index(0), _period(0),
+      _period_events(0), _hottest(nullptr) {}
+
 // See Worker.h
 Worker::~Worker() {
-    // TODO: implementation here
+    // Thread works with the worker state till the end, so it must be joined before
+    assert(!_thread.joinable());
 }
 
 // See Worker.h
@@ -39,18 +64,53 @@ Worker &Worker::operator=(Worker &&other) {
     _pStorage = std::move(other._pStorage);
     _pLogging = std::move(other._pLogging);
     _logger = std::move(other._logger);
+    _connections = other._connections;
+    _own_live = std::move(other._own_live);
+    _live = other._live;
     _thread = std::move(other._thread);
     _epoll_fd = other._epoll_fd;
+    _server_socket = other._server_socket;
+    _rebalancer = other._rebalancer;
+    _index = other._index;
 
     other._epoll_fd = -1;
+    other._server_socket = -1;
     return *this;
 }
 
 // See Worker.h
-void Worker::Start(int epoll_fd) {
+void Worker::Start(int epoll_fd, int server_socket, Rebalancer *rebalancer, size_t index) {
     if (isRunning.exchange(true) == false) {
         assert(_epoll_fd == -1);
+        assert(rebalancer == nullptr || server_socket != -1);
+
+        // Private epoll, connections are accepted right there. Worker itself marks server socket
+        // events. Registration is done here, so that failure gets to the caller
+        if (server_socket != -1) {
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            event.data.ptr = this;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_socket, &event)) {
+                isRunning = false;
+                throw std::runtime_error("Failed to add file descriptor to epoll");
+            }
+        }
+
+        // Connections handed over by other workers are signalled through own eventfd marked by rebalancer
+        if (rebalancer != nullptr) {
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            event.data.ptr = rebalancer;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, rebalancer->WakeupFd(index), &event)) {
+                isRunning = false;
+                throw std::runtime_error("Failed to add file descriptor to epoll");
+            }
+        }
+
         _epoll_fd = epoll_fd;
+        _server_socket = server_socket;
+        _rebalancer = rebalancer;
+        _index = index;
         _logger = _pLogging->select("network.worker");
         _thread = std::thread(&Worker::OnRun, this);
     }
@@ -61,8 +121,9 @@ void Worker::Stop() { isRunning = false; }
 
 // See Worker.h
 void Worker::Join() {
-    assert(_thread.joinable());
-    _thread.join();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
 }
 
 // See Worker.h
@@ -70,6 +131,11 @@ void Worker::OnRun() {
     assert(_epoll_fd >= 0);
     _logger->trace("OnRun");
 
+    // Server socket and rebalancer eventfd are registered by Start already
+    bool shared = _server_socket == -1;
+    _period_start = std::chrono::steady_clock::now();
+    _period_busy = std::chrono::steady_clock::duration::zero();
+
     // Process connection events
     //
     // Do not forget to use EPOLLEXCLUSIVE flag when register socket
@@ -77,8 +143,13 @@ void Worker::OnRun() {
     int timeout = -1;
     std::array<struct epoll_event, 64> mod_list;
     while (isRunning) {
+        if (_rebalancer != nullptr) {
+            timeout = Rebalance();
+        }
+
         int nmod = epoll_wait(_epoll_fd, &mod_list[0], mod_list.size(), timeout);
         _logger->debug("Worker wokeup: {} events", nmod);
+        auto busy_start = std::chrono::steady_clock::now();
 
         for (int i = 0; i < nmod; i++) {
             struct epoll_event &current_event = mod_list[i];
@@ -90,8 +161,21 @@ void Worker::OnRun() {
                 continue;
             }
 
+            // New clients on the own server socket
+            if (current_event.data.ptr == this) {
+                OnAccept();
+                continue;
+            }
+
+            // Connections from other workers
+            if (current_event.data.ptr == _rebalancer) {
+                OnHandover();
+                continue;
+            }
+
             // Some connection gets new data
             Connection *pconn = static_cast<Connection *>(current_event.data.ptr);
+            uint32_t old_events = pconn->_event.events;
             if ((current_event.events & EPOLLERR) || (current_event.events & EPOLLHUP)) {
                 _logger->debug("Got EPOLLERR or EPOLLHUP, value of returned events: {}", current_event.events);
                 pconn->OnError();
@@ -110,29 +194,142 @@ void Worker::OnRun() {
                 }
             }
 
-            // Rearm connection
+            // Remember which connection keeps worker busy, it is the first candidate to move
+            if (_rebalancer != nullptr) {
+                if (pconn->_load_period != _period) {
+                    pconn->_load_period = _period;
+                    pconn->_load = 0;
+                }
+                pconn->_load++;
+                _period_events++;
+                if (!pconn->isAlive() && pconn == _hottest) {
+                    _hottest = nullptr;
+                } else if (pconn->isAlive() && (_hottest == nullptr || pconn->_load > _hottest->_load)) {
+                    _hottest = pconn;
+                }
+            }
+
+            // Rearm connection, in private epoll it stays armed unless it wants other events
             if (pconn->isAlive()) {
-                pconn->_event.events |= EPOLLONESHOT;
+                if (shared) {
+                    pconn->_event.events |= EPOLLONESHOT;
+                } else if (pconn->_event.events == old_events) {
+                    continue;
+                }
+
                 int epoll_ctl_retval;
                 if ((epoll_ctl_retval = epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, pconn->_socket, &pconn->_event))) {
                     _logger->debug("epoll_ctl failed during connection rearm: error {}", epoll_ctl_retval);
                     pconn->OnError();
-                    delete pconn;
+                    if (pconn == _hottest) {
+                        _hottest = nullptr;
+                    }
+                    _live->Remove(pconn);
+                    _connections->destroy(pconn);
                 }
             }
             // Or delete closed one
             else {
                 if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pconn->_socket, &pconn->_event)) {
-                    std::cerr << "Failed to delete connection!" << std::endl;
+                    _logger->error("Failed to delete connection on descriptor {} from epoll", pconn->_socket);
                 }
-                delete pconn;
+                _live->Remove(pconn);
+                _connections->destroy(pconn);
             }
         }
-        // TODO: Select timeout...
+        _period_busy += std::chrono::steady_clock::now() - busy_start;
+    }
+
+    // Nobody else serves connections of the private epoll, shared ones are closed by server
+    if (!shared) {
+        _live->DestroyAll(*_connections);
     }
     _logger->warn("Worker stopped");
 }
 
+// See Worker.h
+int Worker::Rebalance() {
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = now - _period_start;
+    if (elapsed < kRebalancePeriod) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(kRebalancePeriod - elapsed).count() + 1;
+    }
+
+    double load = std::min(_period_busy / elapsed, 1.0);
+    _rebalancer->Report(_index, load);
+
+    // Busiest connection goes away only if that makes load more even
+    if (_hottest != nullptr && _period_events > 0) {
+        double share = load * _hottest->_load / _period_events;
+        int target = _rebalancer->Target(_index, load, share);
+        if (target != -1 && epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, _hottest->_socket, &_hottest->_event) == 0) {
+            _logger->debug("Move connection on descriptor {} to worker {}, load {} share {}", _hottest->_socket,
+                           target, load, share);
+            _live->Remove(_hottest);
+            _rebalancer->Send(target, _hottest);
+        }
+    }
+
+    // Start the next period, counters of connections are reset lazily once they get an event
+    _period++;
+    _period_start = now;
+    _period_busy = std::chrono::steady_clock::duration::zero();
+    _period_events = 0;
+    _hottest = nullptr;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(kRebalancePeriod).count();
+}
+
+// See Worker.h
+void Worker::OnHandover() {
+    eventfd_t value;
+    eventfd_read(_rebalancer->WakeupFd(_index), &value);
+
+    Connection *pconn = _rebalancer->Receive(_index);
+    while (pconn != nullptr) {
+        Connection *next = pconn->_next;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, pconn->_socket, &pconn->_event)) {
+            _logger->error("Failed to register connection on descriptor {}", pconn->_socket);
+            pconn->OnError();
+            _connections->destroy(pconn);
+        } else {
+            _live->Add(pconn);
+        }
+        pconn = next;
+    }
+}
+
+// See Worker.h
+void Worker::OnAccept() {
+    for (;;) {
+        // No need to make these sockets non blocking since accept4() takes care of it.
+        int infd = accept4(_server_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (infd == -1) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                _logger->error("Failed to accept socket");
+            }
+            break;
+        }
+        _logger->debug("Accepted connection on descriptor {}", infd);
+
+        Connection *pc = _connections->create<Connection>(infd, _pStorage, _logger);
+        if (pc == nullptr) {
+            _logger->error("Too many connections, drop descriptor {}", infd);
+            close(infd);
+            continue;
+        }
+
+        // Connection is never shared, so it is registered without EPOLLONESHOT
+        pc->Start();
+        if (!pc->isAlive() || epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, pc->_socket, &pc->_event)) {
+            _logger->debug("Failed to register connection on descriptor {}", infd);
+            pc->OnError();
+            _connections->destroy(pc);
+        } else {
+            _live->Add(pc);
+        }
+    }
+}
+
 } // namespace MTnonblock
 } // namespace Network
 } // namespace Afina
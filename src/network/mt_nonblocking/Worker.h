@@ -2,8 +2,11 @@
 #define AFINA_NETWORK_MT_NONBLOCKING_WORKER_H
 
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <unordered_set>
 
 namespace spdlog {
 class logger;
@@ -16,10 +19,47 @@ class Storage;
 namespace Logging {
 class Service;
 }
+namespace Allocator {
+class MemPool;
+}
 
 namespace Network {
 namespace MTnonblock {
 
+// Forward declaration, see Connection.h
+class Connection;
+
+// Forward declaration, see Rebalancer.h
+class Rebalancer;
+
+/**
+ * # Connections registered in epoll
+ * Nobody else knows about connections waiting for events, so they are tracked here to close ones
+ * still open once server stops. Set is private to a worker if epoll is private, otherwise it is
+ * shared by acceptors and all workers
+ */
+class LiveConnections {
+public:
+    void Add(Connection *pconn) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _connections.insert(pconn);
+    }
+
+    void Remove(Connection *pconn) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _connections.erase(pconn);
+    }
+
+    /**
+     * Closes and destroys all connections, nobody must serve them anymore
+     */
+    void DestroyAll(Afina::Allocator::MemPool &pool);
+
+private:
+    std::mutex _mutex;
+    std::unordered_set<Connection *> _connections;
+};
+
 /**
  * # Thread running epoll
  * On Start spaws background thread that is doing epoll on the given server
@@ -27,7 +67,12 @@ namespace MTnonblock {
  */
 class Worker {
 public:
-    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl);
+    /**
+     * Connections are allocated from the given pool. Live set is given if epoll is shared, otherwise
+     * worker tracks its connections itself
+     */
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl,
+           Afina::Allocator::MemPool *connections, LiveConnections *live = nullptr);
     ~Worker();
 
     Worker(Worker &&);
@@ -37,20 +82,27 @@ public:
      * Spaws new background thread that is doing epoll on the given server
      * socket. Once connection accepted it must be registered and being processed
      * on this thread
+     *
+     * Epoll could be shared with other workers, then connections are registered by acceptors with
+     * EPOLLONESHOT. If server socket is given, epoll is private, worker accepts connections itself
+     * and serves them until they are closed or moved to another worker by rebalancer, index is the
+     * worker number in rebalancer
+     *
+     * Throws std::runtime_error if sockets can't be registered in epoll, thread isn't started then
      */
-    void Start(int epoll_fd);
+    void Start(int epoll_fd, int server_socket = -1, Rebalancer *rebalancer = nullptr, size_t index = 0);
 
     /**
      * Signal background thread to stop. After that signal thread must stop to
      * accept new connections and must stop read new commands from existing. Once
      * all readed commands are executed and results are send back to client, thread
-     * must stop
+     * must stop. Connections of the private epoll are closed by the thread on exit
      */
     void Stop();
 
     /**
      * Blocks calling thread until background one for this worker is actually
-     * been destoryed
+     * been destoryed. Does nothing if Start has failed
      */
     void Join();
 
@@ -60,6 +112,22 @@ protected:
      */
     void OnRun();
 
+    /**
+     * Accepts all pending connections on the own server socket and registers them in the private epoll
+     */
+    void OnAccept();
+
+    /**
+     * Registers connections handed over by other workers in the private epoll
+     */
+    void OnHandover();
+
+    /**
+     * Once rebalance period is over reports worker load and hands the busiest connection over to
+     * less loaded worker if needed. Returns epoll timeout until the end of the current period
+     */
+    int Rebalance();
+
 private:
     Worker(Worker &) = delete;
     Worker &operator=(Worker &) = delete;
@@ -73,6 +141,13 @@ private:
     // Logger to be used
     std::shared_ptr<spdlog::logger> _logger;
 
+    // Pool connections are allocated from, closed ones go back there
+    Afina::Allocator::MemPool *_connections;
+
+    // Connections registered in epoll, _own_live is set only if worker has a private epoll
+    std::unique_ptr<LiveConnections> _own_live;
+    LiveConnections *_live;
+
     // Flag signals that thread should continue to operate
     std::atomic<bool> isRunning;
 
@@ -81,6 +156,20 @@ private:
 
     // EPOLL descriptor using for events processing
     int _epoll_fd;
+
+    // Socket to accept connections on, -1 if epoll is shared and connections come from acceptors
+    int _server_socket;
+
+    // Moves connections between workers, could be nullptr, then connections never leave worker
+    Rebalancer *_rebalancer;
+    size_t _index;
+
+    // Load of the current rebalance period, only used by the worker thread
+    uint32_t _period;
+    std::chrono::steady_clock::time_point _period_start;
+    std::chrono::steady_clock::duration _period_busy;
+    size_t _period_events;
+    Connection *_hottest;
 };
 
 } // namespace MTnonblock
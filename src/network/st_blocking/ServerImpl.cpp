@@ -1,6 +1,7 @@
 #include "ServerImpl.h"
 
 #include <cassert>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -21,6 +22,7 @@
 #include <afina/execute/Command.h>
 #include <afina/logging/Service.h>
 
+#include "network/blocking/Session.h"
 #include "protocol/Parser.h"
 
 namespace Afina {
@@ -120,15 +122,9 @@ void ServerImpl::Join() {
 
 // See Server.h
 void ServerImpl::OnRun() {
-    // Here is connection state
-    // - parser: parse state of the stream
-    // - command_to_execute: last command parsed out of stream
-    // - arg_remains: how many bytes to read from stream to get command argument
-    // - argument_for_command: buffer stores argument
-    std::size_t arg_remains;
-    Protocol::Parser parser;
-    std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+    // Here is connection state: parse state of the stream and responses waiting to be sent, it is
+    // reused from connection to connection
+    Blocking::Session session(*pStorage);
     while (running.load()) {
         _logger->debug("waiting for connection...");
 
@@ -171,66 +167,13 @@ void ServerImpl::OnRun() {
             while ((readed_bytes = read(client_socket, client_buffer, sizeof(client_buffer))) > 0) {
                 _logger->debug("Got {} bytes from socket", readed_bytes);
 
-                // Single block of data readed from the socket could trigger inside actions a multiple times,
-                // for example:
-                // - read#0: [<command1 start>]
-                // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
-                while (readed_bytes > 0) {
-                    _logger->debug("Process {} bytes", readed_bytes);
-                    // There is no command yet
-                    if (!command_to_execute) {
-                        std::size_t parsed = 0;
-                        if (parser.Parse(client_buffer, readed_bytes, parsed)) {
-                            // There is no command to be launched, continue to parse input stream
-                            // Here we are, current chunk finished some command, process it
-                            _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                            command_to_execute = parser.Build(arg_remains);
-                            if (arg_remains > 0) {
-                                arg_remains += 2;
-                            }
-                        }
-
-                        // Parsed might fails to consume any bytes from input stream. In real life that could happens,
-                        // for example, because we are working with UTF-16 chars and only 1 byte left in stream
-                        if (parsed == 0) {
-                            break;
-                        } else {
-                            std::memmove(client_buffer, client_buffer + parsed, readed_bytes - parsed);
-                            readed_bytes -= parsed;
-                        }
-                    }
-
-                    // There is command, but we still wait for argument to arrive...
-                    if (command_to_execute && arg_remains > 0) {
-                        _logger->debug("Fill argument: {} bytes of {}", readed_bytes, arg_remains);
-                        // There is some parsed command, and now we are reading argument
-                        std::size_t to_read = std::min(arg_remains, std::size_t(readed_bytes));
-                        argument_for_command.append(client_buffer, to_read);
-
-                        std::memmove(client_buffer, client_buffer + to_read, readed_bytes - to_read);
-                        arg_remains -= to_read;
-                        readed_bytes -= to_read;
-                    }
-
-                    // Thre is command & argument - RUN!
-                    if (command_to_execute && arg_remains == 0) {
-                        _logger->debug("Start command execution");
-
-                        std::string result;
-                        command_to_execute->Execute(*pStorage, argument_for_command, result);
-
-                        // Send response
-                        result += "\r\n";
-                        if (send(client_socket, result.data(), result.size(), 0) <= 0) {
-                            throw std::runtime_error("Failed to send response");
-                        }
-
-                        // Prepare for the next command
-                        command_to_execute.reset();
-                        argument_for_command.resize(0);
-                        parser.Reset();
-                    }
-                } // while (readed_bytes)
+                // Commands completed by the block are executed before responses are sent all at once
+                session.Process(client_buffer, readed_bytes);
+
+                // Send responses to all commands of the block
+                if (!session.Send(client_socket)) {
+                    throw std::runtime_error("Failed to send response");
+                }
             }
 
             if (readed_bytes == 0) {
@@ -240,15 +183,16 @@ void ServerImpl::OnRun() {
             }
         } catch (std::runtime_error &ex) {
             _logger->error("Failed to process connection on descriptor {}: {}", client_socket, ex.what());
+
+            // Commands of the block executed before the failure still get their responses
+            session.Send(client_socket);
         }
 
         // We are done with this connection
         close(client_socket);
 
         // Prepare for the next command: just in case if connection was closed in the middle of executing something
-        command_to_execute.reset();
-        argument_for_command.resize(0);
-        parser.Reset();
+        session.Reset();
     }
 
     // Cleanup on exit...
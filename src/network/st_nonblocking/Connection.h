@@ -2,21 +2,43 @@
 #define AFINA_NETWORK_ST_NONBLOCKING_CONNECTION_H
 
 #include <cstring>
+#include <memory>
+#include <string>
 
 #include <sys/epoll.h>
 
+#include <afina/execute/Output.h>
+
+#include "protocol/Processor.h"
+
+namespace spdlog {
+class logger;
+}
+
 namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+
 namespace Network {
 namespace STnonblock {
 
+/**
+ * # Client connection served by the event loop
+ * Connection is registered once for both input and output in edge triggered mode, so its interest
+ * never changes. Each notification means socket state has changed, connection reads and writes
+ * until EAGAIN and remembers which side is still ready, because no more notifications come for it
+ * until then.
+ *
+ * Input is parsed and executed right after read, responses are queued in the output buffer. Reading
+ * is paused while too much output is pending and resumed as soon as it is sent, so that client
+ * that doesn't read responses can't make server buffer them without bound.
+ */
 class Connection {
 public:
-    Connection(int s) : _socket(s) {
-        std::memset(&_event, 0, sizeof(struct epoll_event));
-        _event.data.ptr = this;
-    }
+    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl);
 
-    inline bool isAlive() const { return true; }
+    inline bool isAlive() const { return _is_alive; }
 
     void Start();
 
@@ -29,8 +51,38 @@ protected:
 private:
     friend class ServerImpl;
 
+    // Moves data both ways while socket allows, connection dies once it has nothing to do
+    void Drain();
+
+    // Reads once, returns false if nothing was read
+    bool ReadSome();
+
+    // Sends output until socket is full
+    void WriteSome();
+
+    size_t Pending() const { return _output.size(); }
+
     int _socket;
     struct epoll_event _event;
+
+    std::shared_ptr<Afina::Storage> _pStorage;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    bool _is_alive;
+
+    // Client won't send anything more or sent garbage, connection is closed once output is sent
+    bool _eof;
+
+    // Socket sides that didn't report EAGAIN since the last notification
+    bool _readable;
+    bool _writable;
+
+    // Everything read is processed right away, partial command is kept by processor
+    char _read_buffer[4096];
+    Protocol::Processor _processor;
+
+    // Responses not yet sent, values there are referenced rather than copied
+    Execute::Output _output;
 };
 
 } // namespace STnonblock
@@ -0,0 +1,92 @@
+#include "Connection.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+namespace {
+
+// Connection stops processing new commands while that many bytes are waiting to be sent
+constexpr size_t kMaxOutput = 64 * 1024;
+
+} // namespace
+
+// See Connection.h
+Connection::Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl)
+    : _socket(s), _pStorage(std::move(ps)), _logger(std::move(pl)), _is_alive(true), _eof(false), _inflight(0),
+      _recv_armed(false), _recv_canceled(false), _send_inflight(false), _dirty(false), _processor(*_pStorage) {
+    std::memset(&_msg, 0, sizeof(_msg));
+    _msg.msg_iov = _iov;
+}
+
+// See Connection.h
+void Connection::OnData(const char *data, size_t size) {
+    if (_eof) {
+        return;
+    }
+
+    // Data is processed right from the kernel buffer unless older input is waiting
+    if (_input.empty()) {
+        size_t consumed = Process(data, size);
+        _input.append(data + consumed, size - consumed);
+    } else {
+        _input.append(data, size);
+        Resume();
+    }
+}
+
+// See Connection.h
+void Connection::Resume() {
+    if (!_input.empty()) {
+        _input.erase(0, Process(_input.data(), _input.size()));
+    }
+}
+
+// See Connection.h
+bool Connection::Blocked() const { return Pending() >= kMaxOutput; }
+
+// See Connection.h
+size_t Connection::Process(const char *data, size_t size) {
+    // Output being sent counts too, so that the whole pending output stays under the limit
+    size_t max_output = kMaxOutput - std::min(kMaxOutput, _output.size());
+    try {
+        return _processor.Process(data, size, _queued, max_output);
+    } catch (std::runtime_error &ex) {
+        _logger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
+        _queued.Append("CLIENT_ERROR ");
+        _queued.Append(ex.what(), strlen(ex.what()));
+        _queued.Append("\r\n", 2);
+        _eof = true;
+        return size;
+    }
+}
+
+// See Connection.h
+bool Connection::PrepareSend() {
+    if (_send_inflight) {
+        return false;
+    }
+
+    // Outputs keep their capacity, so steady state connection doesn't allocate memory for output
+    if (_output.empty()) {
+        std::swap(_output, _queued);
+    }
+    if (_output.empty()) {
+        return false;
+    }
+    _msg.msg_iovlen = _output.Prepare(_iov, kMaxIov);
+    return true;
+}
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
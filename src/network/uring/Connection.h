@@ -0,0 +1,107 @@
+#ifndef AFINA_NETWORK_URING_CONNECTION_H
+#define AFINA_NETWORK_URING_CONNECTION_H
+
+#include <memory>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <afina/execute/Output.h>
+
+#include "protocol/Processor.h"
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+
+namespace Network {
+namespace Uring {
+
+/**
+ * # Client connection served by io_uring worker
+ * Connection doesn't issue any syscalls: worker keeps multishot receive armed on the socket and passes
+ * received data right from the kernel provided buffer, connection executes commands and queues responses.
+ * Responses are accumulated while previous send is in flight, worker sends them all at once when it
+ * completes, so output being sent is never touched. Values are referenced by output rather than copied
+ * and go to the socket right from the storage with a single sendmsg.
+ *
+ * Once too much output is pending connection stops processing input and keeps the rest of it, worker
+ * cancels receive until output is sent, so that client that doesn't read responses can't make server
+ * buffer them without bound.
+ */
+class Connection {
+public:
+    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl);
+
+    inline bool isAlive() const { return _is_alive; }
+
+private:
+    friend class Worker;
+
+    // Processes received data, keeps what wasn't processed because of output limit
+    void OnData(const char *data, size_t size);
+
+    // Processes kept input once output is sent
+    void Resume();
+
+    // Executes commands from the given data until output limit, returns number of bytes consumed
+    size_t Process(const char *data, size_t size);
+
+    // Output is over the limit, no more input is processed
+    bool Blocked() const;
+
+    // Next portion of output to send, responses queued since the last send go there. Message is described
+    // by _msg, which must stay untouched until send completes
+    bool PrepareSend();
+
+    // Send has completed, drops what was sent
+    void OnSent(size_t size) { _output.Consume(size); }
+
+    size_t Pending() const { return _output.size() + _queued.size(); }
+
+    int _socket;
+
+    std::shared_ptr<Afina::Storage> _pStorage;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    bool _is_alive;
+
+    // Client won't send anything more or sent garbage, connection is closed once output is sent
+    bool _eof;
+
+    // Operations kernel works on for the connection, connection could be released only once there are none
+    size_t _inflight;
+    bool _recv_armed;
+    bool _recv_canceled;
+    bool _send_inflight;
+
+    // Connection is in the worker list of connections to send output for
+    bool _dirty;
+
+    // Input received while output was over the limit
+    std::string _input;
+
+    // Partial command is kept by processor
+    Protocol::Processor _processor;
+
+    // Output of the send in flight, responses since then are queued
+    Execute::Output _output;
+    Execute::Output _queued;
+
+    // Message of the send in flight, kernel could read it at any time until completion
+    static constexpr size_t kMaxIov = 64;
+    struct iovec _iov[kMaxIov];
+    struct msghdr _msg;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_URING_CONNECTION_H
@@ -0,0 +1,185 @@
+#include "Ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+namespace {
+
+int io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+} // namespace
+
+// See Ring.h
+Ring::Ring(unsigned entries) : _sq_tail(0), _sq_submitted(0) {
+    // Ring is only used by the thread that created it, so kernel could run completion work right
+    // before return to that thread instead of interrupting it
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    params.cq_entries = entries * 4;
+    _fd = io_uring_setup(entries, &params);
+    if (_fd == -1 && errno == EINVAL) {
+        // Setup flags are the newest feature used, kernel knowing them supports multishot operations as well
+        throw std::runtime_error("Failed to setup io_uring: kernel is too old, Linux 6.1 or newer is required");
+    }
+    if (_fd == -1) {
+        throw std::runtime_error("Failed to setup io_uring: " + std::string(strerror(errno)));
+    }
+
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        _sq_ring_size = _cq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+    }
+
+    _sq_ring = mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                    IORING_OFF_SQ_RING);
+    if (_sq_ring == MAP_FAILED) {
+        close(_fd);
+        throw std::runtime_error("Failed to map io_uring: " + std::string(strerror(errno)));
+    }
+
+    _cq_ring = _sq_ring;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        _cq_ring = mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                        IORING_OFF_CQ_RING);
+        if (_cq_ring == MAP_FAILED) {
+            munmap(_sq_ring, _sq_ring_size);
+            close(_fd);
+            throw std::runtime_error("Failed to map io_uring: " + std::string(strerror(errno)));
+        }
+    }
+
+    _sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        if (_cq_ring != _sq_ring) {
+            munmap(_cq_ring, _cq_ring_size);
+        }
+        munmap(_sq_ring, _sq_ring_size);
+        close(_fd);
+        throw std::runtime_error("Failed to map io_uring: " + std::string(strerror(errno)));
+    }
+    _sqes = static_cast<struct io_uring_sqe *>(sqes);
+
+    char *sq = static_cast<char *>(_sq_ring);
+    _sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    _sq_ktail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    _sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    _sq_entries = params.sq_entries;
+    _sq_tail = _sq_submitted = *_sq_ktail;
+
+    // Entries are always submitted in order, so index array is identity
+    unsigned *array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < _sq_entries; i++) {
+        array[i] = i;
+    }
+
+    char *cq = static_cast<char *>(_cq_ring);
+    _cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    _cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+}
+
+// See Ring.h
+Ring::~Ring() {
+    munmap(_sqes, _sqes_size);
+    if (_cq_ring != _sq_ring) {
+        munmap(_cq_ring, _cq_ring_size);
+    }
+    munmap(_sq_ring, _sq_ring_size);
+    close(_fd);
+}
+
+// See Ring.h
+struct io_uring_sqe *Ring::Sqe() {
+    // Kernel consumes submitted entries right away unless it is short of memory or completion queue
+    // overflows, so the full queue is submitted until there is room
+    while (_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries) {
+        int ret = Submit(0);
+        if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+            throw std::runtime_error("Failed to submit to io_uring: " + std::string(strerror(-ret)));
+        }
+    }
+
+    struct io_uring_sqe *sqe = &_sqes[_sq_tail & _sq_mask];
+    std::memset(sqe, 0, sizeof(struct io_uring_sqe));
+    _sq_tail++;
+    return sqe;
+}
+
+// See Ring.h
+int Ring::Submit(unsigned wait_nr) {
+    unsigned to_submit = _sq_tail - _sq_submitted;
+    if (to_submit == 0 && wait_nr == 0) {
+        return 0;
+    }
+
+    __atomic_store_n(_sq_ktail, _sq_tail, __ATOMIC_RELEASE);
+    int ret = io_uring_enter(_fd, to_submit, wait_nr, wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0);
+    if (ret < 0) {
+        return -errno;
+    }
+    _sq_submitted += ret;
+    return ret;
+}
+
+// See Ring.h
+ProvidedBuffers::ProvidedBuffers(Ring &ring, uint16_t group, unsigned count, size_t size, uint64_t user_data)
+    : _ring(ring), _group(group), _size(size), _user_data(user_data), _count(count),
+      _memory(new char[count * size]) {
+    struct io_uring_sqe *sqe = _ring.Sqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = count;
+    sqe->addr = reinterpret_cast<uint64_t>(_memory);
+    sqe->len = size;
+    sqe->off = 0;
+    sqe->buf_group = group;
+    sqe->user_data = _user_data;
+}
+
+// See Ring.h
+ProvidedBuffers::~ProvidedBuffers() { delete[] _memory; }
+
+// See Ring.h
+void ProvidedBuffers::Recycle(uint16_t id) {
+    struct io_uring_sqe *sqe = _ring.Sqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = 1;
+    sqe->addr = reinterpret_cast<uint64_t>(Buffer(id));
+    sqe->len = _size;
+    sqe->off = id;
+    sqe->buf_group = _group;
+    sqe->user_data = _user_data;
+}
+
+// See Ring.h
+void ProvidedBuffers::Remove(uint64_t user_data) {
+    struct io_uring_sqe *sqe = _ring.Sqe();
+    sqe->opcode = IORING_OP_REMOVE_BUFFERS;
+    sqe->fd = _count;
+    sqe->buf_group = _group;
+    sqe->user_data = user_data;
+}
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,136 @@
+#ifndef AFINA_NETWORK_URING_RING_H
+#define AFINA_NETWORK_URING_RING_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/io_uring.h>
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+/**
+ * # io_uring instance
+ * Thin wrapper over io_uring syscalls and shared rings, just enough for the server. Ring is meant
+ * to be used by a single thread: entries are taken by Sqe(), filled by caller and passed to kernel
+ * by the next Submit(), so that many operations cost a single syscall. Completions are read with
+ * Peek() and released with Advance().
+ */
+class Ring {
+public:
+    /**
+     * Creates ring with the given number of submission entries, completion queue is larger since
+     * multishot operations post many completions for a single submission
+     */
+    explicit Ring(unsigned entries);
+    ~Ring();
+
+    int fd() const { return _fd; }
+
+    /**
+     * Returns cleared submission entry, if queue is full entries taken so far are submitted until kernel
+     * takes some of them. Throws std::runtime_error if submission fails
+     */
+    struct io_uring_sqe *Sqe();
+
+    /**
+     * Passes all taken entries to kernel and waits until there are at least wait_nr completions,
+     * returns -errno on failure
+     */
+    int Submit(unsigned wait_nr);
+
+    /**
+     * Returns completion at the head of queue, nullptr if there is none
+     */
+    struct io_uring_cqe *Peek() {
+        unsigned head = *_cq_head;
+        if (head == __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE)) {
+            return nullptr;
+        }
+        return &_cqes[head & _cq_mask];
+    }
+
+    /**
+     * Releases completion returned by Peek()
+     */
+    void Advance() { __atomic_store_n(_cq_head, *_cq_head + 1, __ATOMIC_RELEASE); }
+
+private:
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    int _fd;
+
+    // Mapped rings, with IORING_FEAT_SINGLE_MMAP both queues share the first mapping
+    void *_sq_ring;
+    size_t _sq_ring_size;
+    void *_cq_ring;
+    size_t _cq_ring_size;
+    struct io_uring_sqe *_sqes;
+    size_t _sqes_size;
+
+    // Submission queue, entries [*_sq_head, _sq_tail) are taken but not yet consumed by kernel
+    unsigned *_sq_head;
+    unsigned *_sq_ktail;
+    unsigned _sq_mask;
+    unsigned _sq_entries;
+    unsigned _sq_tail;
+    unsigned _sq_submitted;
+
+    // Completion queue
+    unsigned *_cq_head;
+    unsigned *_cq_tail;
+    unsigned _cq_mask;
+    struct io_uring_cqe *_cqes;
+};
+
+/**
+ * # Provided buffers
+ * Buffers kernel picks from on its own when data arrives for receive operation with IOSQE_BUFFER_SELECT,
+ * buffer id comes in the completion flags. Buffer belongs to user until Recycle(), which queues request
+ * to give it back along with other submissions, so recycling costs no syscall on its own.
+ *
+ * Buffers are provided with IORING_OP_PROVIDE_BUFFERS rather than registered buffer ring: kernel this
+ * was tested on accepts ring registration but never takes buffers from it
+ */
+class ProvidedBuffers {
+public:
+    /**
+     * Queues request to provide all buffers, user_data is set to the given value for every request
+     * made, so that completions could be told apart
+     */
+    ProvidedBuffers(Ring &ring, uint16_t group, unsigned count, size_t size, uint64_t user_data);
+    ~ProvidedBuffers();
+
+    uint16_t group() const { return _group; }
+
+    char *Buffer(uint16_t id) { return _memory + static_cast<size_t>(id) * _size; }
+
+    /**
+     * Gives buffer back to kernel
+     */
+    void Recycle(uint16_t id);
+
+    /**
+     * Queues request to take all buffers back from kernel, memory could be freed once it completes
+     */
+    void Remove(uint64_t user_data);
+
+private:
+    ProvidedBuffers(const ProvidedBuffers &) = delete;
+    ProvidedBuffers &operator=(const ProvidedBuffers &) = delete;
+
+    Ring &_ring;
+    uint16_t _group;
+    size_t _size;
+    uint64_t _user_data;
+    unsigned _count;
+    char *_memory;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_URING_RING_H
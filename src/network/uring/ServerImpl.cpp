@@ -0,0 +1,132 @@
+#include "ServerImpl.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/logging/Service.h>
+
+#include "Worker.h"
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+namespace {
+
+// Opens socket listening on the given port, sockets of all workers share the port with SO_REUSEPORT
+int open_server_socket(uint16_t port) {
+    struct sockaddr_in server_addr;
+    std::memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;         // IPv4
+    server_addr.sin_port = htons(port);       // TCP port number
+    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
+
+    int server_socket = socket(PF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (server_socket == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    int opts = 1;
+    if (setsockopt(server_socket, SOL_SOCKET, SO_KEEPALIVE, &opts, sizeof(opts)) == -1 ||
+        setsockopt(server_socket, SOL_SOCKET, SO_REUSEPORT, &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
+    }
+
+    if (listen(server_socket, SOMAXCONN) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
+    }
+    return server_socket;
+}
+
+} // namespace
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+    : Server(ps, pl), _event_fd(-1) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+    _logger->info("Start network service");
+
+    sigset_t sig_mask;
+    sigemptyset(&sig_mask);
+    sigaddset(&sig_mask, SIGPIPE);
+    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
+        throw std::runtime_error("Unable to mask SIGPIPE");
+    }
+
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_event_fd == -1) {
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+
+    // Workers accept connections themselves, so acceptors count doesn't matter
+    _workers.reserve(n_workers);
+    try {
+        for (uint32_t i = 0; i < n_workers; i++) {
+            _server_sockets.push_back(open_server_socket(port));
+            _workers.emplace_back(pStorage, pLogging);
+            _workers.back().Start(_server_sockets.back(), _event_fd);
+        }
+    } catch (...) {
+        // Workers started already are stopped, so that server is left as if Start was never called
+        Stop();
+        Join();
+        throw;
+    }
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    _logger->warn("Stop network service");
+    for (auto &w : _workers) {
+        w.Stop();
+    }
+
+    // Wakeup threads that are waiting for completions, eventfd is never read so all of them see it
+    if (eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup workers");
+    }
+}
+
+// See Server.h
+void ServerImpl::Join() {
+    for (auto &w : _workers) {
+        w.Join();
+    }
+    _workers.clear();
+
+    for (int fd : _server_sockets) {
+        close(fd);
+    }
+    _server_sockets.clear();
+
+    close(_event_fd);
+    _event_fd = -1;
+}
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,58 @@
+#ifndef AFINA_NETWORK_URING_SERVER_H
+#define AFINA_NETWORK_URING_SERVER_H
+
+#include <memory>
+#include <vector>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+// Forward declaration, see Worker.h
+class Worker;
+
+/**
+ * # Network resource manager implementation
+ * io_uring based server. Each worker has private ring and own listening socket bound to the same
+ * port with SO_REUSEPORT, there are no acceptor threads: workers accept connections themselves with
+ * multishot accept. Requires kernel 6.0+ for multishot receive
+ */
+class ServerImpl : public Server {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Curstom event "device" used to wakeup workers
+    int _event_fd;
+
+    // Listening sockets of workers
+    std::vector<int> _server_sockets;
+
+    // threads serving connections
+    std::vector<Worker> _workers;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_URING_SERVER_H
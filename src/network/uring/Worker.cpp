@@ -0,0 +1,402 @@
+#include "Worker.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/logging/Service.h>
+
+#include "Connection.h"
+#include "Ring.h"
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+namespace {
+
+// Submission queue size, sends of a larger batch are submitted in parts
+constexpr unsigned kRingEntries = 256;
+
+// Receive buffers shared by all connections of the worker
+constexpr uint16_t kBufferGroup = 0;
+constexpr unsigned kBuffersCount = 512;
+constexpr size_t kBufferSize = 4096;
+
+} // namespace
+
+// See Worker.h
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl)
+    : _pStorage(ps), _pLogging(pl), isRunning(false), _server_socket(-1), _event_fd(-1), _pending(0) {}
+
+// See Worker.h
+Worker::~Worker() {}
+
+// See Worker.h
+Worker::Worker(Worker &&other) { *this = std::move(other); }
+
+// See Worker.h
+Worker &Worker::operator=(Worker &&other) {
+    _pStorage = std::move(other._pStorage);
+    _pLogging = std::move(other._pLogging);
+    _logger = std::move(other._logger);
+    _thread = std::move(other._thread);
+    _server_socket = other._server_socket;
+    _event_fd = other._event_fd;
+    _pending = other._pending;
+
+    other._server_socket = -1;
+    other._event_fd = -1;
+    return *this;
+}
+
+// See Worker.h
+void Worker::Start(int server_socket, int event_fd) {
+    if (isRunning.exchange(true) == false) {
+        assert(_server_socket == -1);
+        _server_socket = server_socket;
+        _event_fd = event_fd;
+        _logger = _pLogging->select("network.worker");
+
+        // Ring must be created by the thread using it, its failure is passed back to report it here
+        std::promise<void> started;
+        std::future<void> result = started.get_future();
+        _thread = std::thread(&Worker::OnRun, this, &started);
+        try {
+            result.get();
+        } catch (...) {
+            _thread.join();
+            isRunning = false;
+            _server_socket = -1;
+            _event_fd = -1;
+            throw;
+        }
+    }
+}
+
+// See Worker.h
+void Worker::Stop() { isRunning = false; }
+
+// See Worker.h
+void Worker::Join() {
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+// See Worker.h
+void Worker::OnRun(std::promise<void> *started) {
+    _logger->trace("OnRun");
+    try {
+        _ring.reset(new Ring(kRingEntries));
+        _buffers.reset(new ProvidedBuffers(*_ring, kBufferGroup, kBuffersCount, kBufferSize, kProvide));
+        _pending++;
+        ArmAccept();
+        ArmWakeup();
+    } catch (...) {
+        _buffers.reset();
+        _ring.reset();
+        started->set_exception(std::current_exception());
+        return;
+    }
+    started->set_value();
+
+    while (isRunning && Reap(1)) {
+        Flush();
+    }
+
+    // Kernel may use buffers and sockets until all operations complete, if ring is broken closing it
+    // is the only way left to stop them
+    if (!Drain()) {
+        _ring.reset();
+    }
+    _buffers.reset();
+    _ring.reset();
+    for (Connection *pconn : _connections) {
+        close(pconn->_socket);
+        delete pconn;
+    }
+    _connections.clear();
+    _dirty.clear();
+    _logger->warn("Worker stopped");
+}
+
+// See Worker.h
+void Worker::OnCompletion(const struct io_uring_cqe &cqe) {
+    Connection *pconn = reinterpret_cast<Connection *>(cqe.user_data & ~static_cast<uint64_t>(kMask));
+    uint64_t operation = cqe.user_data & kMask;
+    if (pconn == nullptr) {
+        if (operation == kAccept) {
+            OnAccept(cqe);
+            return;
+        }
+
+        // Wakeup just lets the loop check whether worker should stop
+        _pending--;
+        if ((operation == kProvide || operation == kRemove) && cqe.res < 0) {
+            _logger->error("Failed to {} buffers: {}", operation == kProvide ? "provide" : "remove",
+                           strerror(-cqe.res));
+        }
+        return;
+    }
+
+    if (operation == kRecv) {
+        OnRecv(pconn, cqe);
+    } else if (operation == kSend) {
+        OnSend(pconn, cqe);
+    } else {
+        pconn->_inflight--;
+    }
+    MarkDirty(pconn);
+}
+
+// See Worker.h
+void Worker::OnAccept(const struct io_uring_cqe &cqe) {
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        _pending--;
+        if (isRunning) {
+            ArmAccept();
+        }
+    }
+    if (cqe.res < 0) {
+        if (cqe.res != -ECANCELED) {
+            _logger->error("Failed to accept socket: {}", strerror(-cqe.res));
+        }
+        return;
+    }
+
+    int infd = cqe.res;
+    _logger->debug("Accepted connection on descriptor {}", infd);
+
+    // Responses are sent as soon as they are ready, Nagle would hold the tail of a long pipeline
+    int opts = 1;
+    setsockopt(infd, IPPROTO_TCP, TCP_NODELAY, &opts, sizeof(opts));
+
+    Connection *pconn = new Connection(infd, _pStorage, _logger);
+    _connections.insert(pconn);
+    MarkDirty(pconn);
+}
+
+// See Worker.h
+void Worker::OnRecv(Connection *pconn, const struct io_uring_cqe &cqe) {
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        pconn->_inflight--;
+        pconn->_recv_armed = false;
+        pconn->_recv_canceled = false;
+    }
+
+    if (cqe.res > 0) {
+        uint16_t id = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+        _logger->debug("Got {} bytes from descriptor {}", cqe.res, pconn->_socket);
+        if (pconn->isAlive()) {
+            pconn->OnData(_buffers->Buffer(id), cqe.res);
+        }
+        _buffers->Recycle(id);
+        _pending++;
+    } else if (cqe.res == 0) {
+        _logger->debug("Client on descriptor {} has nothing more to send", pconn->_socket);
+        pconn->_eof = true;
+    } else if (cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+        // Out of buffers or canceled receive is armed again once connection could take more input
+        _logger->error("Error on descriptor {}: {}", pconn->_socket, strerror(-cqe.res));
+        pconn->_is_alive = false;
+    }
+}
+
+// See Worker.h
+void Worker::OnSend(Connection *pconn, const struct io_uring_cqe &cqe) {
+    pconn->_inflight--;
+    pconn->_send_inflight = false;
+    if (cqe.res < 0) {
+        // Sends fail once worker shuts connections down on stop, there is nothing to report then
+        if (pconn->isAlive()) {
+            _logger->error("Error on descriptor {}: {}", pconn->_socket, strerror(-cqe.res));
+        }
+        pconn->_is_alive = false;
+        return;
+    }
+
+    // Input kept because of too much output could be processed now
+    pconn->OnSent(cqe.res);
+    pconn->Resume();
+}
+
+// See Worker.h
+void Worker::ArmAccept() {
+    struct io_uring_sqe *sqe = _ring->Sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = _server_socket;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = kAccept;
+    _pending++;
+}
+
+// See Worker.h
+void Worker::ArmWakeup() {
+    struct io_uring_sqe *sqe = _ring->Sqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = _event_fd;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = kWakeup;
+    _pending++;
+}
+
+// See Worker.h
+void Worker::ArmRecv(Connection *pconn) {
+    struct io_uring_sqe *sqe = _ring->Sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = pconn->_socket;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = _buffers->group();
+    sqe->user_data = reinterpret_cast<uint64_t>(pconn) | kRecv;
+    pconn->_recv_armed = true;
+    pconn->_inflight++;
+}
+
+// See Worker.h
+void Worker::CancelRecv(Connection *pconn) {
+    struct io_uring_sqe *sqe = _ring->Sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(pconn) | kRecv;
+    sqe->user_data = reinterpret_cast<uint64_t>(pconn) | kCancel;
+    pconn->_recv_canceled = true;
+    pconn->_inflight++;
+}
+
+// See Worker.h
+bool Worker::Reap(unsigned wait_nr) {
+    int ret = _ring->Submit(wait_nr);
+    if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+        _logger->error("Failed to submit to io_uring: {}", strerror(-ret));
+        return false;
+    }
+
+    struct io_uring_cqe *cqe;
+    while ((cqe = _ring->Peek()) != nullptr) {
+        struct io_uring_cqe current = *cqe;
+        _ring->Advance();
+        OnCompletion(current);
+    }
+    return true;
+}
+
+// See Worker.h
+bool Worker::Wait() {
+    while (Pending() > 0) {
+        if (!Reap(1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// See Worker.h
+size_t Worker::Pending() const {
+    size_t pending = _pending;
+    for (Connection *pconn : _connections) {
+        pending += pconn->_inflight;
+    }
+    return pending;
+}
+
+// See Worker.h
+bool Worker::Drain() {
+    // Shutdown completes sends to clients that don't read, all the rest is canceled
+    for (Connection *pconn : _connections) {
+        pconn->_is_alive = false;
+        shutdown(pconn->_socket, SHUT_RDWR);
+    }
+
+    try {
+        struct io_uring_sqe *sqe = _ring->Sqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+        sqe->user_data = kCancelAll;
+        _pending++;
+        if (!Wait()) {
+            return false;
+        }
+
+        // Buffers are taken back only once no receive could pick them
+        _buffers->Remove(kRemove);
+        _pending++;
+        return Wait();
+    } catch (std::runtime_error &ex) {
+        _logger->error("Failed to stop worker: {}", ex.what());
+        return false;
+    }
+}
+
+// See Worker.h
+void Worker::MarkDirty(Connection *pconn) {
+    if (!pconn->_dirty) {
+        pconn->_dirty = true;
+        _dirty.push_back(pconn);
+    }
+}
+
+// See Worker.h
+void Worker::Flush() {
+    for (Connection *pconn : _dirty) {
+        pconn->_dirty = false;
+
+        if (pconn->isAlive()) {
+            if (pconn->PrepareSend()) {
+                struct io_uring_sqe *sqe = _ring->Sqe();
+                sqe->opcode = IORING_OP_SENDMSG;
+                sqe->fd = pconn->_socket;
+                sqe->addr = reinterpret_cast<uint64_t>(&pconn->_msg);
+                sqe->len = 1;
+                sqe->msg_flags = MSG_NOSIGNAL;
+                sqe->user_data = reinterpret_cast<uint64_t>(pconn) | kSend;
+                pconn->_send_inflight = true;
+                pconn->_inflight++;
+            }
+
+            // Receive only while connection could process input
+            bool blocked = pconn->Blocked() || !pconn->_input.empty();
+            if (!pconn->_recv_armed && !pconn->_eof && !blocked) {
+                ArmRecv(pconn);
+            } else if (pconn->_recv_armed && !pconn->_recv_canceled && (pconn->_eof || blocked)) {
+                CancelRecv(pconn);
+            }
+
+            // Client is gone and everything is sent
+            if (pconn->_eof && pconn->Pending() == 0) {
+                pconn->_is_alive = false;
+            }
+        }
+
+        // Shutdown completes operations kernel still works on, including send to a client that doesn't read
+        if (!pconn->isAlive()) {
+            if (pconn->_inflight > 0) {
+                shutdown(pconn->_socket, SHUT_RDWR);
+            } else {
+                _logger->debug("Connection on descriptor {} closed", pconn->_socket);
+                _connections.erase(pconn);
+                close(pconn->_socket);
+                delete pconn;
+            }
+        }
+    }
+    _dirty.clear();
+}
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,158 @@
+#ifndef AFINA_NETWORK_URING_WORKER_H
+#define AFINA_NETWORK_URING_WORKER_H
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <linux/io_uring.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+namespace Logging {
+class Service;
+}
+
+namespace Network {
+namespace Uring {
+
+// Forward declaration, see Connection.h
+class Connection;
+
+// Forward declaration, see Ring.h
+class Ring;
+class ProvidedBuffers;
+
+/**
+ * # Thread running io_uring
+ * Worker owns io_uring instance and listening socket bound with SO_REUSEPORT, so that workers share
+ * nothing. Single multishot accept brings all new connections, each connection has single multishot
+ * receive taking kernel provided buffers. Sends are collected while completions are processed and
+ * submitted in one batch along with waiting for the next completions, so that worker makes one
+ * syscall per loop iteration no matter how many connections were served.
+ */
+class Worker {
+public:
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl);
+    ~Worker();
+
+    Worker(Worker &&);
+    Worker &operator=(Worker &&);
+
+    /**
+     * Spaws new background thread serving connections accepted on the given server socket, thread
+     * stops once stop was requested and event_fd becomes readable. Waits until thread sets io_uring
+     * up, throws std::runtime_error if it fails, thread isn't running then
+     */
+    void Start(int server_socket, int event_fd);
+
+    /**
+     * Signal background thread to stop
+     */
+    void Stop();
+
+    /**
+     * Blocks calling thread until background one for this worker is actually
+     * been destoryed. Does nothing if Start has failed
+     */
+    void Join();
+
+protected:
+    /**
+     * Method executing by background thread, sets io_uring up and reports the result through started
+     */
+    void OnRun(std::promise<void> *started);
+
+private:
+    Worker(Worker &) = delete;
+    Worker &operator=(Worker &) = delete;
+
+    // Operations are told apart by user data, it is connection pointer with operation in low bits
+    enum Operation : uint64_t {
+        kAccept = 1,
+        kWakeup = 2,
+        kProvide = 3,
+        kCancelAll = 4,
+        kRemove = 5,
+        kRecv = 1,
+        kSend = 2,
+        kCancel = 3,
+        kMask = 7
+    };
+
+    void OnCompletion(const struct io_uring_cqe &cqe);
+    void OnAccept(const struct io_uring_cqe &cqe);
+    void OnRecv(Connection *pconn, const struct io_uring_cqe &cqe);
+    void OnSend(Connection *pconn, const struct io_uring_cqe &cqe);
+
+    void ArmAccept();
+    void ArmWakeup();
+    void ArmRecv(Connection *pconn);
+    void CancelRecv(Connection *pconn);
+
+    // Submits queued entries, waits for at least wait_nr completions and processes all there are.
+    // Returns false if ring can't be used anymore
+    bool Reap(unsigned wait_nr);
+
+    // Processes completions until kernel has no operations of the worker left
+    bool Wait();
+
+    // Number of operations kernel still works on
+    size_t Pending() const;
+
+    // Shuts all connections down, cancels everything in flight and takes provided buffers back, so
+    // that kernel uses neither buffers nor sockets anymore. Returns false if ring has failed meanwhile
+    bool Drain();
+
+    // Connection state changed, it will be looked at before the next submit
+    void MarkDirty(Connection *pconn);
+
+    // Queues sends and receives of changed connections, releases closed ones
+    void Flush();
+
+    // afina services
+    std::shared_ptr<Afina::Storage> _pStorage;
+
+    // afina services
+    std::shared_ptr<Afina::Logging::Service> _pLogging;
+
+    // Logger to be used
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Flag signals that thread should continue to operate
+    std::atomic<bool> isRunning;
+
+    // Thread serving requests in this worker
+    std::thread _thread;
+
+    // Socket to accept connections on
+    int _server_socket;
+
+    // Becomes readable once server stops
+    int _event_fd;
+
+    // Only exist while thread runs, ring is used by the thread that created it only
+    std::unique_ptr<Ring> _ring;
+    std::unique_ptr<ProvidedBuffers> _buffers;
+
+    // Operations of the worker itself kernel still works on: accept, wakeup, buffer requests and cancel
+    size_t _pending;
+
+    // Connections served by the worker and ones changed since the last submit
+    std::unordered_set<Connection *> _connections;
+    std::vector<Connection *> _dirty;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+#endif // AFINA_NETWORK_URING_WORKER_H
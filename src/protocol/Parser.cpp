@@ -6,6 +6,7 @@
 
 #include <afina/execute/Add.h>
 #include <afina/execute/Append.h>
+#include <afina/execute/CacheMemlimit.h>
 #include <afina/execute/Command.h>
 #include <afina/execute/Delete.h>
 #include <afina/execute/Get.h>
@@ -35,6 +36,9 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                 } else if (name == "stats") {
                     state = State::sLF;
                     continue;
+                } else if (name == "cache_memlimit") {
+                    // The only argument goes to bytes, there is no data block though
+                    state = State::spBytes;
                 } else {
                     throw std::runtime_error("Unknown command name: " + name);
                 }
@@ -109,19 +113,11 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                 state = State::spBytes;
                 // std::cout << "parser debug: ExprTime='" << exprtime << "'" << std::endl;
             } else if (c >= '0' && c <= '9') {
-                int32_t et = exprtime;
-                if (negative) {
-                    et -= (c - '0');
-                    if (et > exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
-                    }
-                } else {
-                    et += (c - '0');
-                    if (et < exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
-                    }
+                int64_t et = int64_t(exprtime) * 10 + (negative ? -(c - '0') : (c - '0'));
+                if (et > INT32_MAX || et < INT32_MIN) {
+                    throw std::runtime_error("Expire time field overflow");
                 }
-                exprtime = et;
+                exprtime = int32_t(et);
             }
             break;
         }
@@ -169,15 +165,18 @@ std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
 
     body_size = bytes;
     if (name == "set") {
-        return std::unique_ptr<Execute::Command>(new Execute::Set(keys[0], flags, exprtime));
+        return std::unique_ptr<Execute::Command>(new (_resource) Execute::Set(keys[0], flags, exprtime));
     } else if (name == "add") {
-        return std::unique_ptr<Execute::Command>(new Execute::Add(keys[0], flags, exprtime));
+        return std::unique_ptr<Execute::Command>(new (_resource) Execute::Add(keys[0], flags, exprtime));
     } else if (name == "append") {
-        return std::unique_ptr<Execute::Command>(new Execute::Append(keys[0], flags, exprtime));
+        return std::unique_ptr<Execute::Command>(new (_resource) Execute::Append(keys[0], flags, exprtime));
     } else if (name == "get") {
-        return std::unique_ptr<Execute::Command>(new Execute::Get(keys));
+        return std::unique_ptr<Execute::Command>(new (_resource) Execute::Get(keys));
     } else if (name == "stats") {
-        return std::unique_ptr<Execute::Command>(new Execute::Stats());
+        return std::unique_ptr<Execute::Command>(new (_resource) Execute::Stats());
+    } else if (name == "cache_memlimit") {
+        body_size = 0;
+        return std::unique_ptr<Execute::Command>(new (_resource) Execute::CacheMemlimit(bytes));
     } else {
         throw std::runtime_error("Unsupported command");
     }
@@ -187,8 +186,14 @@ std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
 void Parser::Reset() {
     state = State::sName;
     name.clear();
-    keys.clear();
-    curKey.clear();
+    if (_resource != nullptr) {
+        // Resource could be reset right after the command, nothing must stay there
+        Allocator::Vector<Allocator::String>(keys.get_allocator()).swap(keys);
+        Allocator::String(curKey.get_allocator()).swap(curKey);
+    } else {
+        keys.clear();
+        curKey.clear();
+    }
     parse_complete = false;
     flags = 0;
     bytes = 0;
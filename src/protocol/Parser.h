@@ -8,6 +8,8 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <afina/allocator/StlAllocator.h>
+
 namespace Afina {
 namespace Execute {
 class Command;
@@ -20,7 +22,15 @@ namespace Protocol {
  */
 class Parser {
 public:
-    Parser() { Reset(); }
+    /**
+     * @param resource memory for the parsed out keys and commands, heap if not set. Memory taken
+     * for a command is given back by Reset(), so that resource could be reset after each command
+     */
+    explicit Parser(Allocator::MemoryResource *resource = nullptr)
+        : _resource(resource), keys(resource), curKey(resource) {
+        Reset();
+    }
+
     /**
      * Push given string into parser input. Method returns true if it was a command parsed out
      * from comulative input. In a such case method Build will return new command
@@ -64,12 +74,15 @@ private:
      */
     enum State : uint16_t { sCR, sLF, sName, spKey, spFlags, spExprTimeStart, spExprTime, spBytes, sgKey };
 
+    // Memory for everything parsed out of the current command
+    Allocator::MemoryResource *_resource;
+
     // Current parser state
     State state;
 
     // vrious fields of the command
     std::string name;
-    std::vector<std::string> keys;
+    Allocator::Vector<Allocator::String> keys;
 
     // <flags> is an arbitrary 16-bit unsigned integer (written out in decimal) that the server stores along with
     // the data and sends back when the item is retrieved. Clients may use this as a bit field to store data-specific
@@ -89,7 +102,7 @@ private:
     uint32_t bytes;
 
     bool negative;
-    std::string curKey;
+    Allocator::String curKey;
     bool parse_complete;
 };
 
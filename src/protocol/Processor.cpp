@@ -0,0 +1,90 @@
+#include "Processor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <afina/Storage.h>
+#include <afina/execute/Command.h>
+#include <afina/execute/Output.h>
+
+namespace Afina {
+namespace Protocol {
+
+namespace {
+
+// Most of requests fit a single chunk of request memory
+constexpr size_t kRequestMemoryChunk = 1024;
+
+} // namespace
+
+// See Processor.h
+Processor::Processor(Afina::Storage &storage)
+    : _storage(storage), _request_memory(kRequestMemoryChunk), _parser(&_request_memory), _arg_remains(0) {}
+
+// See Processor.h
+Processor::~Processor() {}
+
+// See Processor.h
+size_t Processor::Process(const char *data, size_t size, Execute::Output &output, size_t max_output) {
+    size_t offset = 0;
+    while (offset < size) {
+        // There is no command yet
+        if (!_command) {
+            if (output.size() >= max_output) {
+                break;
+            }
+
+            size_t parsed = 0;
+            bool ready = _parser.Parse(data + offset, size - offset, parsed);
+            offset += parsed;
+            if (!ready) {
+                break;
+            }
+
+            _command = _parser.Build(_arg_remains);
+            if (_arg_remains > 0) {
+                _arg_remains += 2;
+            }
+        }
+
+        // There is command, but we still wait for argument to arrive...
+        if (_arg_remains > 0) {
+            size_t to_read = std::min(_arg_remains, size - offset);
+            _argument.append(data + offset, to_read);
+            offset += to_read;
+            _arg_remains -= to_read;
+            if (_arg_remains > 0) {
+                break;
+            }
+
+            // Data block is followed by \r\n which isn't a part of the value
+            if (_argument.size() < 2 || _argument.compare(_argument.size() - 2, 2, "\r\n") != 0) {
+                throw std::runtime_error("bad data chunk");
+            }
+            _argument.resize(_argument.size() - 2);
+        }
+
+        // There is command & argument - RUN!
+        _command->Execute(_storage, _argument, output);
+        output.Append("\r\n", 2);
+
+        // Prepare for the next command
+        _command.reset();
+        _argument.resize(0);
+        _parser.Reset();
+        _request_memory.reset();
+    }
+    return offset;
+}
+
+// See Processor.h
+void Processor::Reset() {
+    _command.reset();
+    _arg_remains = 0;
+    _argument.resize(0);
+    _parser.Reset();
+    _request_memory.reset();
+}
+
+} // namespace Protocol
+} // namespace Afina
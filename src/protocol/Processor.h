@@ -0,0 +1,76 @@
+#ifndef AFINA_PROTOCOL_PROCESSOR_H
+#define AFINA_PROTOCOL_PROCESSOR_H
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include <afina/allocator/Region.h>
+
+#include "Parser.h"
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+
+namespace Execute {
+class Command;
+class Output;
+} // namespace Execute
+
+namespace Protocol {
+
+/**
+ * # Request processing of a connection
+ * Walks input received from the client: parses commands, collects their arguments and executes each
+ * command as soon as it is complete, responses are appended to the output given by the caller. Parser
+ * keeps partial input in its own state, so command and its argument could span any number of reads and
+ * server never has to keep input between calls.
+ *
+ * Single block of data could complete many commands, for example:
+ * - read#0: [<command1 start>]
+ * - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
+ */
+class Processor {
+public:
+    explicit Processor(Afina::Storage &storage);
+    ~Processor();
+
+    /**
+     * Executes commands completed by the data, appends their responses to the output. New command isn't
+     * started once output holds max_output bytes, so that server could wait for client to take responses
+     * before it takes more input. Returns number of bytes consumed, the rest must be given again later.
+     *
+     * Throws std::runtime_error if input is malformed, responses to commands executed before the failure
+     * stay in the output
+     */
+    size_t Process(const char *data, size_t size, Execute::Output &output,
+                   size_t max_output = std::numeric_limits<size_t>::max());
+
+    /**
+     * Drops partially received command, e.g. before the next connection
+     */
+    void Reset();
+
+private:
+    Processor(const Processor &) = delete;
+    Processor &operator=(const Processor &) = delete;
+
+    Afina::Storage &_storage;
+
+    // Parser and command of the current request live in request memory, it is reset once request is done
+    Allocator::Region _request_memory;
+    Parser _parser;
+    std::unique_ptr<Execute::Command> _command;
+
+    // How many bytes to read from stream to get command argument, including trailing \r\n
+    size_t _arg_remains;
+    std::string _argument;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_PROCESSOR_H
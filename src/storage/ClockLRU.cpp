@@ -0,0 +1,202 @@
+#include "ClockLRU.h"
+
+#include <ctime>
+#include <mutex>
+
+namespace Afina {
+namespace Backend {
+
+constexpr size_t ClockLRU::kShrinkStep;
+
+// See ClockLRU.h
+uint32_t ClockLRU::Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return uint32_t(ts.tv_sec);
+}
+
+// See ClockLRU.h
+ClockLRU::index_type::iterator ClockLRU::FindLive(const std::string &key) {
+    auto item = _index.find(key);
+    if (item != _index.end() && Expired(*item->second, Now())) {
+        DeleteItem(item);
+        return _index.end();
+    }
+    return item;
+}
+
+// See ClockLRU.h
+bool ClockLRU::PutItem(const std::string &key, const std::string &value, uint32_t deadline) {
+    std::size_t additional_size = key.size() + value.size();
+    if (additional_size > _max_size) {
+        return false;
+    }
+    Evict(additional_size, nullptr);
+
+    std::unique_ptr<clock_node> node(new clock_node(key, value, deadline));
+    clock_node *pnode = node.get();
+    if (_hand == nullptr) {
+        pnode->_prev = pnode->_next = pnode;
+        _hand = pnode;
+    } else {
+        // Place new node right behind the hand, so it gets a full turn before eviction
+        pnode->_next = _hand;
+        pnode->_prev = _hand->_prev;
+        _hand->_prev->_next = pnode;
+        _hand->_prev = pnode;
+    }
+
+    _index.emplace(std::cref(pnode->_key), std::move(node));
+    _actual_size += additional_size;
+    return true;
+}
+
+// See ClockLRU.h
+bool ClockLRU::SetItem(clock_node &node, const std::string &value, uint32_t deadline) {
+    if (node._key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    node._referenced.store(true, std::memory_order_relaxed);
+    if (value.size() > node._value.size()) {
+        Evict(value.size() - node._value.size(), &node);
+    }
+
+    _actual_size = _actual_size - node._value.size() + value.size();
+    node._value.assign(value);
+    node._deadline = deadline;
+    return true;
+}
+
+// See ClockLRU.h
+void ClockLRU::DeleteItem(index_type::iterator item) {
+    clock_node *node = item->second.get();
+    if (node->_next == node) {
+        _hand = nullptr;
+    } else {
+        if (_hand == node) {
+            _hand = node->_next;
+        }
+        node->_prev->_next = node->_next;
+        node->_next->_prev = node->_prev;
+    }
+
+    _actual_size -= node->_key.size() + node->_value.size();
+    _index.erase(item);
+}
+
+// See ClockLRU.h
+void ClockLRU::Evict(std::size_t required, const clock_node *keep) {
+    uint32_t now = Now();
+    Shrink();
+    while (_actual_size + required > _limit) {
+        clock_node *victim = _hand;
+        _hand = _hand->_next;
+
+        // Second chance for recently accessed items, but not for expired ones
+        if (victim == keep ||
+            (victim->_referenced.exchange(false, std::memory_order_relaxed) && !Expired(*victim, now))) {
+            continue;
+        }
+        DeleteItem(_index.find(victim->_key));
+    }
+}
+
+// See ClockLRU.h
+void ClockLRU::Reserve(size_t items) {
+    std::lock_guard<Concurrency::ShardedSharedMutex> lock(_mutex);
+    _index.reserve(items);
+}
+
+// See Storage.h
+bool ClockLRU::Resize(size_t max_size) {
+    std::lock_guard<Concurrency::ShardedSharedMutex> lock(_mutex);
+
+    // Nothing is evicted right now, the limit writers meet goes down step by step
+    _max_size = max_size;
+    _limit = std::max(max_size, std::min(_limit, _actual_size));
+    return true;
+}
+
+// See Storage.h
+bool ClockLRU::Put(const std::string &key, const std::string &value) { return Put(key, value, 0); }
+
+// See Storage.h
+bool ClockLRU::Put(const std::string &key, const std::string &value, uint32_t ttl) {
+    std::lock_guard<Concurrency::ShardedSharedMutex> lock(_mutex);
+    auto item = _index.find(key);
+    if (item != _index.end()) {
+        return SetItem(*item->second, value, Deadline(ttl));
+    }
+    return PutItem(key, value, Deadline(ttl));
+}
+
+// See Storage.h
+bool ClockLRU::PutIfAbsent(const std::string &key, const std::string &value) { return PutIfAbsent(key, value, 0); }
+
+// See Storage.h
+bool ClockLRU::PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) {
+    std::lock_guard<Concurrency::ShardedSharedMutex> lock(_mutex);
+    if (FindLive(key) != _index.end()) {
+        return false;
+    }
+    return PutItem(key, value, Deadline(ttl));
+}
+
+// See Storage.h
+bool ClockLRU::Set(const std::string &key, const std::string &value) {
+    std::lock_guard<Concurrency::ShardedSharedMutex> lock(_mutex);
+    auto item = FindLive(key);
+    if (item == _index.end()) {
+        return false;
+    }
+    return SetItem(*item->second, value, item->second->_deadline);
+}
+
+// See Storage.h
+bool ClockLRU::Set(const std::string &key, const std::string &value, uint32_t ttl) {
+    std::lock_guard<Concurrency::ShardedSharedMutex> lock(_mutex);
+    auto item = FindLive(key);
+    if (item == _index.end()) {
+        return false;
+    }
+    return SetItem(*item->second, value, Deadline(ttl));
+}
+
+// See Storage.h
+bool ClockLRU::Delete(const std::string &key) {
+    std::lock_guard<Concurrency::ShardedSharedMutex> lock(_mutex);
+    auto item = _index.find(key);
+    if (item == _index.end()) {
+        return false;
+    }
+
+    bool live = !Expired(*item->second, Now());
+    DeleteItem(item);
+    return live;
+}
+
+// See Storage.h
+bool ClockLRU::Get(const std::string &key, std::string &value) const {
+    Concurrency::SharedLock<Concurrency::ShardedSharedMutex> lock(_mutex);
+    auto item = _index.find(key);
+    if (item == _index.end()) {
+        return false;
+    }
+
+    // Avoid cache line invalidation if bit is raised already: hot items are read far more
+    // often than the hand passes them
+    const clock_node &node = *item->second;
+    if (Expired(node, Now())) {
+        return false;
+    }
+    if (!node._referenced.load(std::memory_order_relaxed)) {
+        node._referenced.store(true, std::memory_order_relaxed);
+    }
+
+    value.assign(node._value);
+    return true;
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,143 @@
+#ifndef AFINA_STORAGE_CLOCK_LRU_H
+#define AFINA_STORAGE_CLOCK_LRU_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/SharedMutex.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Thread safe LRU approximation
+ * Items are kept in a ring, each item has "referenced" bit which is set on every access. Once
+ * storage needs space the clock hand walks over the ring, clears the bit on referenced items and
+ * evicts the first one which wasn't accessed since the previous pass.
+ *
+ * Unlike SimpleLRU, Get doesn't change ring structure, it only raises the bit with a relaxed
+ * atomic store. So readers take the lock in shared mode and never wait for each other, only
+ * modifications are exclusive. Lock is sharded, each reader thread takes its own slot, so readers
+ * don't even share a cache line. Readers still wait for a running or pending writer.
+ *
+ * Expired item is never returned. Writer finding it removes it, and the hand evicts it on the first
+ * pass no matter whether it was referenced.
+ */
+class ClockLRU : public Afina::Storage {
+public:
+    explicit ClockLRU(size_t max_size = 1024) : _max_size(max_size), _limit(max_size) {}
+    ~ClockLRU() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override;
+
+    // Implements Afina::Storage interface
+    bool Resize(size_t max_size) override;
+
+    /**
+     * Sizes index for the given number of items up front, so that it doesn't grow until there are
+     * more of them. Index is rebuilt at once, so that is meant to be done before the storage is filled
+     */
+    void Reserve(size_t items);
+
+private:
+    // Number of bytes each write evicts on top of its own size while the storage shrinks
+    static constexpr size_t kShrinkStep = 16 * 1024;
+
+    struct clock_node {
+        const std::string _key;
+        std::string _value;
+
+        // Ring links, modified under exclusive lock only
+        clock_node *_prev = nullptr;
+        clock_node *_next = nullptr;
+
+        // Access flag, could be set by readers concurrently
+        mutable std::atomic<bool> _referenced;
+
+        // Time in seconds the item expires at, zero if it never does
+        uint32_t _deadline;
+
+        clock_node(const std::string &key, const std::string &value, uint32_t deadline)
+            : _key(key), _value(value), _referenced(false), _deadline(deadline) {}
+    };
+
+    using index_type = std::unordered_map<std::reference_wrapper<const std::string>, std::unique_ptr<clock_node>,
+                                          std::hash<std::string>, std::equal_to<const std::string>>;
+
+    // Time in seconds deadlines are compared with
+    static uint32_t Now();
+
+    // Deadline of the item stored with the given ttl
+    static uint32_t Deadline(uint32_t ttl) { return ttl == 0 ? 0 : Now() + ttl; }
+
+    static bool Expired(const clock_node &node, uint32_t now) { return node._deadline != 0 && node._deadline <= now; }
+
+    // Finds item of the key, expired one is deleted and isn't found
+    index_type::iterator FindLive(const std::string &key);
+
+    bool PutItem(const std::string &key, const std::string &value, uint32_t deadline);
+    bool SetItem(clock_node &node, const std::string &value, uint32_t deadline);
+    void DeleteItem(index_type::iterator item);
+
+    // Evicts items until there are at least required bytes available. Node keep is never evicted
+    void Evict(std::size_t required, const clock_node *keep);
+
+    // Brings the limit writers evict items to meet a step closer to the memory limit
+    void Shrink() {
+        if (_limit > _max_size) {
+            std::size_t limit = std::min(_limit, _actual_size);
+            _limit = limit > _max_size + kShrinkStep ? limit - kShrinkStep : _max_size;
+        }
+    }
+
+    // Maximum number of bytes could be stored in this cache.
+    // i.e all (keys+values) must be less the _max_size
+    std::size_t _max_size;
+
+    // Limit writers evict items to meet, greater than _max_size for a while once the storage shrinks
+    std::size_t _limit;
+
+    // Actual number of bytes stored in this cache
+    std::size_t _actual_size = 0;
+
+    // Owns all nodes
+    index_type _index;
+
+    // Next eviction candidate, new nodes are inserted just behind it
+    clock_node *_hand = nullptr;
+
+    // Get takes slot of its thread shared, everything else takes all slots exclusively
+    mutable Concurrency::ShardedSharedMutex _mutex;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_CLOCK_LRU_H
@@ -0,0 +1,388 @@
+#include "FlatLRU.h"
+
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+const uint32_t FlatLRU::kNone;
+constexpr size_t FlatLRU::kInline;
+constexpr size_t FlatLRU::kIndexShare;
+constexpr size_t FlatLRU::kShrinkStep;
+
+// See FlatLRU.h
+FlatLRU::FlatLRU(size_t max_size) : _max_size(max_size), _limit(max_size), _index_bits(4) {
+    _index.resize(size_t(1) << _index_bits, slot{0, kNone});
+}
+
+// See FlatLRU.h
+FlatLRU::~FlatLRU() {
+    for (entry &e : _entries) {
+        Release(e);
+    }
+}
+
+// See FlatLRU.h
+size_t FlatLRU::ItemSize(size_t key_size, size_t value_size) {
+    size_t data_size = key_size + value_size;
+    return sizeof(entry) + kIndexShare + (data_size > kInline ? data_size : 0);
+}
+
+// See FlatLRU.h
+const char *FlatLRU::Data(const entry &e) {
+    if (e._key_size + e._value_size <= kInline) {
+        return e._inline;
+    }
+
+    // Address is copied out as inline data has no alignment
+    const char *block;
+    std::memcpy(&block, e._inline, sizeof(block));
+    return block;
+}
+
+// See FlatLRU.h
+void FlatLRU::Fill(entry &e, const std::string &key, const std::string &value) {
+    char *data = e._inline;
+    if (key.size() + value.size() > kInline) {
+        data = new char[key.size() + value.size()];
+        std::memcpy(e._inline, &data, sizeof(data));
+    }
+
+    std::memcpy(data, key.data(), key.size());
+    std::memcpy(data + key.size(), value.data(), value.size());
+    e._key_size = key.size();
+    e._value_size = value.size();
+}
+
+// See FlatLRU.h
+void FlatLRU::Assign(entry &e, const std::string &value) {
+    const char *old = Data(e);
+    char *data = e._inline;
+    if (e._key_size + value.size() > kInline) {
+        data = new char[e._key_size + value.size()];
+    }
+
+    // Key moves only if data changes its place, old block is freed once key is copied out
+    if (data != old) {
+        std::memcpy(data, old, e._key_size);
+    }
+    std::memcpy(data + e._key_size, value.data(), value.size());
+    if (old != e._inline && old != data) {
+        delete[] old;
+    }
+
+    e._value_size = value.size();
+    if (data != e._inline) {
+        std::memcpy(e._inline, &data, sizeof(data));
+    }
+}
+
+// See FlatLRU.h
+void FlatLRU::Release(entry &e) {
+    const char *data = Data(e);
+    if (data != e._inline) {
+        delete[] data;
+    }
+    e._key_size = e._value_size = 0;
+}
+
+// See FlatLRU.h
+uint32_t FlatLRU::Hash(const std::string &key) const {
+    uint64_t h = _hash(key);
+    return uint32_t(h ^ (h >> 32));
+}
+
+// See FlatLRU.h
+uint32_t FlatLRU::Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return uint32_t(ts.tv_sec);
+}
+
+// See FlatLRU.h
+size_t FlatLRU::Find(const std::string &key, uint32_t hash) const {
+    size_t mask = _index.size() - 1;
+    for (size_t pos = Home(hash);; pos = (pos + 1) & mask) {
+        const slot &s = _index[pos];
+        if (s._entry == kNone) {
+            return kNone;
+        }
+
+        if (s._hash == hash) {
+            const entry &e = _entries[s._entry];
+            if (e._key_size == key.size() && std::memcmp(Data(e), key.data(), key.size()) == 0) {
+                return pos;
+            }
+        }
+    }
+}
+
+// See FlatLRU.h
+size_t FlatLRU::FindLive(const std::string &key, uint32_t hash) {
+    size_t pos = Find(key, hash);
+    if (pos != kNone && Expired(_entries[_index[pos]._entry])) {
+        DeleteItem(pos);
+        return kNone;
+    }
+    return pos;
+}
+
+// See FlatLRU.h
+size_t FlatLRU::FindEntry(uint32_t e) const {
+    size_t mask = _index.size() - 1;
+    size_t pos = Home(_entries[e]._hash);
+    while (_index[pos]._entry != e) {
+        pos = (pos + 1) & mask;
+    }
+    return pos;
+}
+
+// See FlatLRU.h
+void FlatLRU::Unlink(uint32_t e) const {
+    const entry &curr = _entries[e];
+    if (curr._prev != kNone) {
+        _entries[curr._prev]._next = curr._next;
+    } else {
+        _lru_head = curr._next;
+    }
+
+    if (curr._next != kNone) {
+        _entries[curr._next]._prev = curr._prev;
+    } else {
+        _lru_tail = curr._prev;
+    }
+}
+
+// See FlatLRU.h
+void FlatLRU::LinkHead(uint32_t e) const {
+    const entry &curr = _entries[e];
+    curr._prev = kNone;
+    curr._next = _lru_head;
+    if (_lru_head != kNone) {
+        _entries[_lru_head]._prev = e;
+    } else {
+        _lru_tail = e;
+    }
+    _lru_head = e;
+}
+
+// See FlatLRU.h
+void FlatLRU::Grow() {
+    std::vector<slot> old_index(size_t(1) << (_index_bits + 1), slot{0, kNone});
+    old_index.swap(_index);
+    _index_bits++;
+
+    // Slots carry hash, so there is no need to touch items
+    size_t mask = _index.size() - 1;
+    for (auto &s : old_index) {
+        if (s._entry == kNone) {
+            continue;
+        }
+
+        size_t pos = Home(s._hash);
+        while (_index[pos]._entry != kNone) {
+            pos = (pos + 1) & mask;
+        }
+        _index[pos] = s;
+    }
+}
+
+// See FlatLRU.h
+bool FlatLRU::PutItem(const std::string &key, uint32_t hash, const std::string &value, uint32_t deadline) {
+    std::size_t additional_size = ItemSize(key.size(), value.size());
+    if (additional_size > _max_size) {
+        return false;
+    }
+
+    Shrink();
+    while (_actual_size + additional_size > _limit) {
+        DeleteItem(FindEntry(_lru_tail));
+    }
+
+    // Keep load factor below 3/4, linear probing degrades quickly after that
+    if ((_index_used + 1) * 4 > _index.size() * 3) {
+        Grow();
+    }
+
+    uint32_t e = _free;
+    if (e != kNone) {
+        _free = _entries[e]._next;
+    } else {
+        if (_entries.size() == kNone) {
+            throw std::runtime_error("Too many items in the storage");
+        }
+        e = _entries.size();
+        _entries.emplace_back();
+    }
+
+    entry &curr = _entries[e];
+    curr._hash = hash;
+    curr._deadline = deadline;
+    Fill(curr, key, value);
+    LinkHead(e);
+
+    size_t mask = _index.size() - 1;
+    size_t pos = Home(hash);
+    while (_index[pos]._entry != kNone) {
+        pos = (pos + 1) & mask;
+    }
+    _index[pos] = slot{hash, e};
+    _index_used++;
+
+    _actual_size += additional_size;
+    return true;
+}
+
+// See FlatLRU.h
+bool FlatLRU::SetItem(uint32_t e, const std::string &value, uint32_t deadline) {
+    entry &curr = _entries[e];
+    size_t new_size = ItemSize(curr._key_size, value.size());
+    if (new_size > _max_size) {
+        return false;
+    }
+
+    if (_lru_head != e) {
+        Unlink(e);
+        LinkHead(e);
+    }
+
+    // Item is at the head now, so that it would be evicted last, but before that there will
+    // be enough space
+    size_t old_size = ItemSize(curr._key_size, curr._value_size);
+    Shrink();
+    while (_actual_size - old_size + new_size > _limit) {
+        DeleteItem(FindEntry(_lru_tail));
+    }
+
+    Assign(curr, value);
+    curr._deadline = deadline;
+    _actual_size = _actual_size - old_size + new_size;
+    return true;
+}
+
+// See FlatLRU.h
+void FlatLRU::DeleteItem(size_t pos) {
+    uint32_t e = _index[pos]._entry;
+    entry &curr = _entries[e];
+    Unlink(e);
+
+    _actual_size -= ItemSize(curr._key_size, curr._value_size);
+    Release(curr);
+    curr._next = _free;
+    _free = e;
+
+    // Backward shift deletion: pull following items of the cluster into the hole unless it
+    // would place them before their home position. No tombstones required
+    size_t mask = _index.size() - 1;
+    size_t hole = pos;
+    for (size_t next = (hole + 1) & mask; _index[next]._entry != kNone; next = (next + 1) & mask) {
+        size_t home = Home(_index[next]._hash);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            _index[hole] = _index[next];
+            hole = next;
+        }
+    }
+
+    _index[hole]._entry = kNone;
+    _index_used--;
+}
+
+// See FlatLRU.h
+void FlatLRU::Reserve(size_t items) {
+    // Same load factor limit as PutItem keeps
+    while (items * 4 > _index.size() * 3) {
+        Grow();
+    }
+    _entries.reserve(items);
+}
+
+// See Storage.h
+bool FlatLRU::Resize(size_t max_size) {
+    // Nothing is evicted right now, the limit writers meet goes down step by step
+    _max_size = max_size;
+    _limit = std::max(max_size, std::min(_limit, _actual_size));
+    return true;
+}
+
+// See Storage.h
+bool FlatLRU::Put(const std::string &key, const std::string &value) { return Put(key, value, 0); }
+
+// See Storage.h
+bool FlatLRU::Put(const std::string &key, const std::string &value, uint32_t ttl) {
+    uint32_t hash = Hash(key);
+    size_t pos = Find(key, hash);
+    if (pos != kNone) {
+        return SetItem(_index[pos]._entry, value, Deadline(ttl));
+    }
+    return PutItem(key, hash, value, Deadline(ttl));
+}
+
+// See Storage.h
+bool FlatLRU::PutIfAbsent(const std::string &key, const std::string &value) { return PutIfAbsent(key, value, 0); }
+
+// See Storage.h
+bool FlatLRU::PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) {
+    uint32_t hash = Hash(key);
+    if (FindLive(key, hash) != kNone) {
+        return false;
+    }
+    return PutItem(key, hash, value, Deadline(ttl));
+}
+
+// See Storage.h
+bool FlatLRU::Set(const std::string &key, const std::string &value) {
+    size_t pos = FindLive(key, Hash(key));
+    if (pos == kNone) {
+        return false;
+    }
+
+    uint32_t e = _index[pos]._entry;
+    return SetItem(e, value, _entries[e]._deadline);
+}
+
+// See Storage.h
+bool FlatLRU::Set(const std::string &key, const std::string &value, uint32_t ttl) {
+    size_t pos = FindLive(key, Hash(key));
+    if (pos == kNone) {
+        return false;
+    }
+    return SetItem(_index[pos]._entry, value, Deadline(ttl));
+}
+
+// See Storage.h
+bool FlatLRU::Delete(const std::string &key) {
+    size_t pos = Find(key, Hash(key));
+    if (pos == kNone) {
+        return false;
+    }
+
+    bool live = !Expired(_entries[_index[pos]._entry]);
+    DeleteItem(pos);
+    return live;
+}
+
+// See Storage.h
+bool FlatLRU::Get(const std::string &key, std::string &value) const {
+    size_t pos = Find(key, Hash(key));
+    if (pos == kNone) {
+        return false;
+    }
+
+    uint32_t e = _index[pos]._entry;
+    const entry &curr = _entries[e];
+    if (Expired(curr)) {
+        return false;
+    }
+    value.assign(Data(curr) + curr._key_size, curr._value_size);
+
+    if (_lru_head != e) {
+        Unlink(e);
+        LinkHead(e);
+    }
+    return true;
+}
+
+} // namespace Backend
+} // namespace Afina
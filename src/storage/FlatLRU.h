@@ -0,0 +1,199 @@
+#ifndef AFINA_STORAGE_FLAT_LRU_H
+#define AFINA_STORAGE_FLAT_LRU_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Open addressing based LRU
+ * That is NOT thread safe implementation!!
+ *
+ * Items live in a single contiguous array and are linked into LRU list by indexes stored
+ * right in the item, so there are no separate list nodes. Index is a flat linear probing
+ * table, each slot keeps 32 bits of the key hash next to the item number, so that lookup
+ * compares keys only for slots which hash matches, typically once per Get.
+ *
+ * Entry takes a cache line. Key and value up to 40 bytes together are stored right in it, so a
+ * hit touches the index slot and the entry only. Larger ones share a single heap block, so
+ * each item costs one heap allocation at most.
+ *
+ * Expired item is never returned, it is removed once a writer finds it or the LRU order reaches it,
+ * there is no separate expiration index.
+ *
+ * Memory limit covers the entry, share of the index and the heap block of each item, see ItemSize.
+ */
+class FlatLRU : public Afina::Storage {
+public:
+    explicit FlatLRU(size_t max_size = 1024);
+    ~FlatLRU();
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override;
+
+    // Implements Afina::Storage interface
+    bool Resize(size_t max_size) override;
+
+    /**
+     * Sizes index for the given number of items up front, so that it doesn't grow until there are
+     * more of them. Index is rebuilt at once, so that is meant to be done before the storage is filled
+     */
+    void Reserve(size_t items);
+
+    /**
+     * Number of bytes an item with the given key and value sizes takes from the storage
+     * memory limit
+     */
+    static size_t ItemSize(size_t key_size, size_t value_size);
+
+private:
+    // Marks absence of item in the slot, list link or free list
+    static const uint32_t kNone = UINT32_MAX;
+
+    // Key and value up to that size together are stored inline, entry takes 64 bytes then
+    static constexpr size_t kInline = 40;
+
+    // Number of bytes each write evicts on top of its own size while the storage shrinks
+    static constexpr size_t kShrinkStep = 16 * 1024;
+
+    struct entry {
+        // LRU links, for free entries _next points to the next free one
+        mutable uint32_t _prev;
+        mutable uint32_t _next;
+
+        // Key hash, allows to find index slot without rehashing the key
+        uint32_t _hash;
+        uint32_t _key_size;
+        uint32_t _value_size;
+
+        // Time in seconds the item expires at, zero if it never does
+        uint32_t _deadline;
+
+        // Key immediately followed by the value if they fit, address of the heap block holding
+        // them otherwise. Free entries have neither
+        char _inline[kInline];
+    };
+    static_assert(sizeof(entry) == 64, "Entry must take exactly a cache line");
+
+    // Key of the entry immediately followed by the value
+    static const char *Data(const entry &e);
+
+    // Stores key and value into the entry having no data
+    static void Fill(entry &e, const std::string &key, const std::string &value);
+
+    // Replaces value of the entry, key stays the same
+    static void Assign(entry &e, const std::string &value);
+
+    // Frees data of the entry
+    static void Release(entry &e);
+
+    struct slot {
+        uint32_t _hash;
+        uint32_t _entry;
+    };
+
+    // Index keeps load factor between 3/8 and 3/4, so an item takes from 4/3 to 8/3 of slots, two
+    // slots are counted for each one
+    static constexpr size_t kIndexShare = 2 * sizeof(slot);
+
+    uint32_t Hash(const std::string &key) const;
+
+    // Time in seconds deadlines are compared with
+    static uint32_t Now();
+
+    // Deadline of the item stored with the given ttl
+    static uint32_t Deadline(uint32_t ttl) { return ttl == 0 ? 0 : Now() + ttl; }
+
+    static bool Expired(const entry &e) { return e._deadline != 0 && e._deadline <= Now(); }
+
+    // Position in the index the given hash should ideally be placed on
+    inline size_t Home(uint32_t hash) const { return (hash * UINT32_C(2654435769)) >> (32 - _index_bits); }
+
+    // Returns index slot of the given key or kNone
+    size_t Find(const std::string &key, uint32_t hash) const;
+
+    // Same as Find, but expired item is deleted and isn't found
+    size_t FindLive(const std::string &key, uint32_t hash);
+
+    // Returns index slot of the given entry
+    size_t FindEntry(uint32_t e) const;
+
+    bool PutItem(const std::string &key, uint32_t hash, const std::string &value, uint32_t deadline);
+    bool SetItem(uint32_t e, const std::string &value, uint32_t deadline);
+    void DeleteItem(size_t pos);
+
+    // LRU list management
+    void Unlink(uint32_t e) const;
+    void LinkHead(uint32_t e) const;
+
+    // Doubles index size
+    void Grow();
+
+    // Brings the limit writers evict items to meet a step closer to the memory limit
+    void Shrink() {
+        if (_limit > _max_size) {
+            std::size_t limit = std::min(_limit, _actual_size);
+            _limit = limit > _max_size + kShrinkStep ? limit - kShrinkStep : _max_size;
+        }
+    }
+
+    // Maximum number of bytes could be stored in this cache.
+    // i.e ItemSize of all items must be less the _max_size
+    std::size_t _max_size;
+
+    // Limit writers evict items to meet, greater than _max_size for a while once the storage shrinks
+    std::size_t _limit;
+
+    // Actual number of bytes stored in this cache
+    std::size_t _actual_size = 0;
+
+    // All items, both live and free ones
+    std::vector<entry> _entries;
+
+    // Head of free entries list
+    uint32_t _free = kNone;
+
+    // Hash index, size is always power of two
+    std::vector<slot> _index;
+    unsigned _index_bits;
+    size_t _index_used = 0;
+
+    // Most and least recently used entries
+    mutable uint32_t _lru_head = kNone;
+    mutable uint32_t _lru_tail = kNone;
+
+    std::hash<std::string> _hash;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_FLAT_LRU_H
@@ -0,0 +1,103 @@
+#include "FrequencySketch.h"
+
+#include <algorithm>
+
+namespace Afina {
+namespace Backend {
+
+constexpr unsigned FrequencySketch::kMaxFrequency;
+constexpr size_t FrequencySketch::kDepth;
+constexpr size_t FrequencySketch::kWidthPerItem;
+
+// See FrequencySketch.h
+size_t FrequencySketch::Width(size_t items) {
+    // Few counters per key in each row keep collisions of rare keys with popular ones unlikely
+    size_t size = 16;
+    while (size < kWidthPerItem * items) {
+        size *= 2;
+    }
+    return size;
+}
+
+// See FrequencySketch.h
+void FrequencySketch::Resize(size_t items) {
+    size_t size = Width(items);
+    _counters.assign(kDepth * size / 2, 0);
+    _mask = size - 1;
+    _additions = 0;
+    _sample_size = std::max<size_t>(10 * items, 16);
+}
+
+// See FrequencySketch.h
+void FrequencySketch::Rebuild(size_t items) {
+    size_t old_size = _mask + 1, size = Width(items);
+    if (size == old_size) {
+        _sample_size = std::max<size_t>(10 * items, 16);
+        return;
+    }
+
+    // Row width is a power of two and key index is masked by it, so the key counter in the new row is
+    // at the same position modulo the smaller of two widths
+    std::vector<uint8_t> counters(kDepth * size / 2, 0);
+    size_t common = std::min(size, old_size);
+    for (size_t row = 0; row < kDepth; row++) {
+        for (size_t i = 0; i < std::max(size, old_size); i++) {
+            size_t from = row * old_size + (size > old_size ? i & (common - 1) : i);
+            size_t to = row * size + (size > old_size ? i : i & (common - 1));
+            unsigned value = Get(from), current = Get(counters, to);
+            if (value > current) {
+                counters[to / 2] += uint8_t((value - current) << (to % 2 * 4));
+            }
+        }
+    }
+
+    _counters.swap(counters);
+    _mask = size - 1;
+    _sample_size = std::max<size_t>(10 * items, 16);
+    _additions = std::min(_additions, _sample_size - 1);
+}
+
+// See FrequencySketch.h
+size_t FrequencySketch::Index(uint32_t hash, size_t row) const {
+    // Double hashing, hash is mixed first as the low bits select the counter
+    uint64_t h = (hash + uint64_t(1)) * 0x9E3779B97F4A7C15ULL;
+    uint32_t h1 = uint32_t(h), h2 = uint32_t(h >> 32) | 1;
+    return row * (_mask + 1) + ((h1 + row * h2) & _mask);
+}
+
+// See FrequencySketch.h
+void FrequencySketch::Increment(uint32_t hash) {
+    bool added = false;
+    for (size_t row = 0; row < kDepth; row++) {
+        size_t index = Index(hash, row);
+        if (Get(index) < kMaxFrequency) {
+            _counters[index / 2] += uint8_t(1 << (index % 2 * 4));
+            added = true;
+        }
+    }
+
+    if (added && ++_additions >= _sample_size) {
+        Age();
+    }
+}
+
+// See FrequencySketch.h
+unsigned FrequencySketch::Estimate(uint32_t hash) const {
+    unsigned result = kMaxFrequency;
+    for (size_t row = 0; row < kDepth; row++) {
+        result = std::min(result, Get(Index(hash, row)));
+    }
+    return result;
+}
+
+// See FrequencySketch.h
+void FrequencySketch::Age() {
+    // Both counters of the byte are halved at once, low bit of the upper one mustn't get into the lower one
+    for (uint8_t &pair : _counters) {
+        pair = (pair >> 1) & 0x77;
+    }
+    _additions /= 2;
+}
+
+} // namespace Backend
+} // namespace Afina
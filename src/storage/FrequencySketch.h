@@ -0,0 +1,79 @@
+#ifndef AFINA_STORAGE_FREQUENCY_SKETCH_H
+#define AFINA_STORAGE_FREQUENCY_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Approximate access frequency of keys
+ * Count-min sketch with 4-bit counters: each key hash maps to one counter in every of four rows,
+ * increment raises all of them and the estimate is the smallest one, so collisions could only
+ * overestimate the frequency. Counters saturate at 15.
+ *
+ * Sketch ages: once the number of increments reaches ten times the number of keys it is sized for,
+ * all counters are halved. So the estimate reflects recent popularity, keys popular long ago fade.
+ */
+class FrequencySketch {
+public:
+    // Maximum value of the estimate
+    static constexpr unsigned kMaxFrequency = 15;
+
+    explicit FrequencySketch(size_t items = 16) { Resize(items); }
+
+    /**
+     * Sizes sketch to tell apart frequencies of the given number of keys. All counters are reset
+     */
+    void Resize(size_t items);
+
+    /**
+     * Same as Resize, but estimates are kept: counter of the wider row is copied from the one the keys
+     * mapped to before, counter of the narrower row is the largest of the counters folded into it.
+     * So estimate of any key could only grow, same as because of collisions
+     */
+    void Rebuild(size_t items);
+
+    // Records access of the key with the given hash
+    void Increment(uint32_t hash);
+
+    // Returns estimated number of recent accesses of the key with the given hash
+    unsigned Estimate(uint32_t hash) const;
+
+    // Number of counters per row
+    size_t width() const { return _mask + 1; }
+
+private:
+    static constexpr size_t kDepth = 4;
+    static constexpr size_t kWidthPerItem = 4;
+
+    // Number of counters per row sized for the given number of keys
+    static size_t Width(size_t items);
+
+    // Index of the key counter in the given row
+    size_t Index(uint32_t hash, size_t row) const;
+
+    unsigned Get(size_t index) const { return Get(_counters, index); }
+
+    static unsigned Get(const std::vector<uint8_t> &counters, size_t index) {
+        return (counters[index / 2] >> (index % 2 * 4)) & 0xF;
+    }
+
+    // Halves all counters
+    void Age();
+
+    // Rows one after another, two counters per byte
+    std::vector<uint8_t> _counters;
+    size_t _mask;
+
+    // Number of increments since the last aging and its limit
+    size_t _additions;
+    size_t _sample_size;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_FREQUENCY_SKETCH_H
@@ -0,0 +1,383 @@
+#include "LockFreeLRU.h"
+
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <limits>
+#include <new>
+#include <thread>
+
+#include <afina/concurrency/Epoch.h>
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+// Default index size, one bucket per that much bytes of the memory limit
+constexpr size_t kBytesPerBucket = 256;
+
+// Number of failed attempts to lock the bucket before giving the core to other threads
+constexpr unsigned kSpinsBeforeYield = 64;
+
+// Cheap per-thread random generator picking buckets to sample
+uint64_t Random() {
+    static thread_local uint64_t state =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ULL | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+} // namespace
+
+constexpr size_t LockFreeLRU::kEvictionSamples;
+constexpr size_t LockFreeLRU::kShrinkStep;
+constexpr size_t LockFreeLRU::kBucketsPerSample;
+
+// See LockFreeLRU.h
+LockFreeLRU::LockFreeLRU(size_t max_size, size_t expected_items) : _max_size(max_size), _memory(new lf_memory()) {
+    size_t items = expected_items != 0 ? expected_items : max_size / kBytesPerBucket;
+    size_t size = 16;
+    while (size < items) {
+        size *= 2;
+    }
+
+    _buckets.reset(new std::atomic<uintptr_t>[size]);
+    for (size_t i = 0; i < size; i++) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+    _mask = size - 1;
+}
+
+// See LockFreeLRU.h
+LockFreeLRU::~LockFreeLRU() {
+    for (size_t i = 0; i <= _mask; i++) {
+        lf_node *node = Head(i);
+        while (node != nullptr) {
+            lf_node *next = node->next.load(std::memory_order_relaxed);
+            FreeNode(node);
+            node = next;
+        }
+    }
+
+    // Retired items still refer to the accounting, the last of them frees it
+    Release(_memory);
+}
+
+// See LockFreeLRU.h
+size_t LockFreeLRU::ItemSize(size_t key_size, size_t value_size) { return sizeof(lf_node) + key_size + value_size; }
+
+// See LockFreeLRU.h
+uint32_t LockFreeLRU::Hash(const std::string &key) {
+    uint64_t h = std::hash<std::string>()(key);
+    return uint32_t(h ^ (h >> 32));
+}
+
+// See LockFreeLRU.h
+uint32_t LockFreeLRU::Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return uint32_t(ts.tv_sec);
+}
+
+// See LockFreeLRU.h
+uint32_t LockFreeLRU::NowMillis() {
+    // Coarse clock ticks every few milliseconds, which is fine to tell recent items from old ones
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return uint32_t(uint64_t(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000);
+}
+
+// See LockFreeLRU.h
+void LockFreeLRU::Touch(lf_node *node) {
+    uint32_t now = NowMillis();
+    if (node->access.load(std::memory_order_relaxed) != now) {
+        node->access.store(now, std::memory_order_relaxed);
+    }
+}
+
+// See LockFreeLRU.h
+LockFreeLRU::lf_node *LockFreeLRU::NewNode(const std::string &key, uint32_t hash, const std::string &value,
+                                           uint32_t deadline) {
+    void *memory = ::operator new(ItemSize(key.size(), value.size()));
+    lf_node *node = new (memory) lf_node();
+    node->next.store(nullptr, std::memory_order_relaxed);
+    node->access.store(NowMillis(), std::memory_order_relaxed);
+    node->hash = hash;
+    node->deadline = deadline;
+    node->key_size = uint32_t(key.size());
+    node->value_size = uint32_t(value.size());
+    std::memcpy(node->data(), key.data(), key.size());
+    std::memcpy(node->data() + key.size(), value.data(), value.size());
+    return node;
+}
+
+// See LockFreeLRU.h
+void LockFreeLRU::FreeNode(void *node) {
+    static_cast<lf_node *>(node)->~lf_node();
+    ::operator delete(node);
+}
+
+// See LockFreeLRU.h
+void LockFreeLRU::FreeRetired(void *node, void *memory) {
+    lf_memory *accounting = static_cast<lf_memory *>(memory);
+    lf_node *item = static_cast<lf_node *>(node);
+    accounting->size.fetch_sub(ItemSize(item->key_size, item->value_size), std::memory_order_relaxed);
+    FreeNode(node);
+    Release(accounting);
+}
+
+// See LockFreeLRU.h
+void LockFreeLRU::Release(lf_memory *memory) {
+    if (memory->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete memory;
+    }
+}
+
+// See LockFreeLRU.h
+void LockFreeLRU::Retire(lf_node *node) {
+    _memory->refs.fetch_add(1, std::memory_order_relaxed);
+    Concurrency::Epoch::Retire(node, &LockFreeLRU::FreeRetired, _memory);
+}
+
+// See LockFreeLRU.h
+void LockFreeLRU::Lock(size_t bucket) {
+    std::atomic<uintptr_t> &head = _buckets[bucket];
+    for (unsigned spins = 0;; spins++) {
+        uintptr_t value = head.load(std::memory_order_relaxed);
+        if ((value & 1) == 0 &&
+            head.compare_exchange_weak(value, value | 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return;
+        }
+        if (spins >= kSpinsBeforeYield) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// See LockFreeLRU.h
+void LockFreeLRU::Unlock(size_t bucket) {
+    std::atomic<uintptr_t> &head = _buckets[bucket];
+    head.store(head.load(std::memory_order_relaxed) & ~uintptr_t(1), std::memory_order_release);
+}
+
+// See LockFreeLRU.h
+void LockFreeLRU::Link(size_t bucket, lf_node *prev, lf_node *node) {
+    // Release makes the item contents visible to readers reaching it through the link
+    if (prev == nullptr) {
+        _buckets[bucket].store(reinterpret_cast<uintptr_t>(node) | 1, std::memory_order_release);
+    } else {
+        prev->next.store(node, std::memory_order_release);
+    }
+}
+
+// See LockFreeLRU.h
+LockFreeLRU::lf_node *LockFreeLRU::FindLocked(size_t bucket, const std::string &key, uint32_t hash,
+                                              lf_node *&prev) const {
+    prev = nullptr;
+    for (lf_node *node = Head(bucket); node != nullptr; node = node->next.load(std::memory_order_relaxed)) {
+        if (Matches(node, key, hash)) {
+            return node;
+        }
+        prev = node;
+    }
+    return nullptr;
+}
+
+// See LockFreeLRU.h
+bool LockFreeLRU::Store(const std::string &key, const std::string &value, Mode mode, bool keep_deadline,
+                        uint32_t ttl) {
+    size_t size = ItemSize(key.size(), value.size());
+    if (size > _max_size.load(std::memory_order_relaxed) || key.size() > UINT32_MAX || value.size() > UINT32_MAX) {
+        return false;
+    }
+
+    // Item is built before the bucket is locked, so the lock is held for a few pointer updates only
+    uint32_t hash = Hash(key);
+    uint32_t now = Now();
+    lf_node *node = NewNode(key, hash, value, ttl == 0 ? 0 : now + ttl);
+
+    size_t bucket = hash & _mask;
+    lf_node *prev;
+    Lock(bucket);
+    lf_node *old = FindLocked(bucket, key, hash, prev);
+    bool live = old != nullptr && !Expired(old, now);
+    if ((mode == Mode::PutIfAbsent && live) || (mode == Mode::Set && !live)) {
+        Unlock(bucket);
+        FreeNode(node);
+        return false;
+    }
+
+    if (old != nullptr) {
+        if (keep_deadline) {
+            node->deadline = old->deadline;
+        }
+        node->next.store(old->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    } else {
+        prev = nullptr;
+        node->next.store(Head(bucket), std::memory_order_relaxed);
+    }
+    // Item is accounted before anyone could remove it, so that the size never drops below zero
+    _memory->size.fetch_add(size, std::memory_order_relaxed);
+    Link(bucket, prev, node);
+    Unlock(bucket);
+
+    if (old != nullptr) {
+        Retire(old);
+    }
+    Evict(size);
+    return true;
+}
+
+// See LockFreeLRU.h
+void LockFreeLRU::Evict(size_t required) {
+    size_t max_size = _max_size.load(std::memory_order_relaxed);
+    if (_memory->size.load(std::memory_order_relaxed) <= max_size) {
+        return;
+    }
+
+    // Items retired by this thread earlier could be safe to free already, that costs no eviction
+    Concurrency::Epoch::Collect();
+
+    // Evicted items stay accounted until readers let them go, they are counted as gone here, so that
+    // eviction doesn't go on because of its own victims
+    size_t freed = 0;
+    while (_memory->size.load(std::memory_order_relaxed) > max_size + freed && freed < required + kShrinkStep) {
+        size_t size;
+        if (!EvictOne(size)) {
+            break;
+        }
+        freed += size;
+    }
+}
+
+// See LockFreeLRU.h
+bool LockFreeLRU::EvictOne(size_t &freed) {
+    // Readers could still walk through the sampled items, they are compared under guard
+    Concurrency::Epoch::Guard guard;
+    uint32_t now = Now(), millis = NowMillis();
+
+    // Sparse table could have few items in the probed buckets, then fewer of them are compared. Probing
+    // goes past the limit only until the first item is found
+    lf_node *victim = nullptr;
+    size_t victim_bucket = 0;
+    int64_t victim_age = 0;
+    size_t bucket = Random() & _mask, seen = 0;
+    size_t probes = kBucketsPerSample * kEvictionSamples;
+    for (size_t i = 0; i <= _mask && seen < kEvictionSamples && (i < probes || victim == nullptr);
+         i++, bucket = (bucket + 1) & _mask) {
+        for (lf_node *node = Head(bucket); node != nullptr; node = node->next.load(std::memory_order_acquire)) {
+            // Stamp could be taken by other thread a bit later than now, such item is the most recent one
+            int64_t age = Expired(node, now) ? std::numeric_limits<int64_t>::max()
+                                             : int32_t(millis - node->access.load(std::memory_order_relaxed));
+            if (victim == nullptr || age > victim_age) {
+                victim = node;
+                victim_bucket = bucket;
+                victim_age = age;
+            }
+            seen++;
+        }
+    }
+    freed = 0;
+    if (victim == nullptr) {
+        return false;
+    }
+
+    // Item could be replaced or evicted by someone else meanwhile, then it is just skipped
+    size_t size = ItemSize(victim->key_size, victim->value_size);
+    lf_node *prev = nullptr, *node;
+    Lock(victim_bucket);
+    for (node = Head(victim_bucket); node != nullptr && node != victim;
+         node = node->next.load(std::memory_order_relaxed)) {
+        prev = node;
+    }
+    if (node != nullptr) {
+        Link(victim_bucket, prev, node->next.load(std::memory_order_relaxed));
+    }
+    Unlock(victim_bucket);
+
+    if (node != nullptr) {
+        Retire(node);
+        freed = size;
+    }
+    return true;
+}
+
+// See Storage.h
+bool LockFreeLRU::Put(const std::string &key, const std::string &value) {
+    return Store(key, value, Mode::Put, false, 0);
+}
+
+// See Storage.h
+bool LockFreeLRU::Put(const std::string &key, const std::string &value, uint32_t ttl) {
+    return Store(key, value, Mode::Put, false, ttl);
+}
+
+// See Storage.h
+bool LockFreeLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+    return Store(key, value, Mode::PutIfAbsent, false, 0);
+}
+
+// See Storage.h
+bool LockFreeLRU::PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) {
+    return Store(key, value, Mode::PutIfAbsent, false, ttl);
+}
+
+// See Storage.h
+bool LockFreeLRU::Set(const std::string &key, const std::string &value) {
+    return Store(key, value, Mode::Set, true, 0);
+}
+
+// See Storage.h
+bool LockFreeLRU::Set(const std::string &key, const std::string &value, uint32_t ttl) {
+    return Store(key, value, Mode::Set, false, ttl);
+}
+
+// See Storage.h
+bool LockFreeLRU::Delete(const std::string &key) {
+    uint32_t hash = Hash(key);
+    size_t bucket = hash & _mask;
+    lf_node *prev;
+    Lock(bucket);
+    lf_node *node = FindLocked(bucket, key, hash, prev);
+    if (node != nullptr) {
+        Link(bucket, prev, node->next.load(std::memory_order_relaxed));
+    }
+    Unlock(bucket);
+
+    if (node == nullptr) {
+        return false;
+    }
+    bool live = !Expired(node, Now());
+    Retire(node);
+    return live;
+}
+
+// See Storage.h
+bool LockFreeLRU::Get(const std::string &key, std::string &value) const {
+    uint32_t hash = Hash(key);
+    Concurrency::Epoch::Guard guard;
+    for (lf_node *node = Head(hash & _mask); node != nullptr; node = node->next.load(std::memory_order_acquire)) {
+        if (Matches(node, key, hash)) {
+            if (Expired(node, Now())) {
+                return false;
+            }
+            value.assign(node->data() + node->key_size, node->value_size);
+            Touch(node);
+            return true;
+        }
+    }
+    return false;
+}
+
+// See Storage.h
+bool LockFreeLRU::Resize(size_t max_size) {
+    // Items above the new limit are evicted by the following writes, kShrinkStep bytes at a time
+    _max_size.store(max_size, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,194 @@
+#ifndef AFINA_STORAGE_LOCK_FREE_LRU_H
+#define AFINA_STORAGE_LOCK_FREE_LRU_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Concurrent hash table with lock-free reads
+ * Chained hash table with no global lock at all. Get never blocks: it walks the bucket chain with
+ * atomic loads and copies the value out, items are immutable once published. Modifications build
+ * the new item before taking any lock, then lock the affected bucket only to link it in place of
+ * the old one, so writers contend only when they hit the same bucket. Bucket lock is the lowest
+ * bit of the bucket head pointer, readers just mask it out.
+ *
+ * Unlinked items are freed through Concurrency::Epoch once no reader could still access them. They
+ * are accounted until then, so memory taken by items waiting for a slow reader counts against the
+ * limit as well. Accounting lives in a separate block, so that items freed after the storage is gone
+ * still have something to update.
+ *
+ * Eviction is approximate LRU: each item keeps the time of its last access, writer exceeding the
+ * memory limit samples a few items from random buckets and evicts the least recently used one,
+ * expired items go first. Sampling probes a limited number of buckets once some item is found, so a
+ * sparse table yields fewer samples rather than a long scan. There is no shared list to update on access, so reads don't
+ * write anything but the item stamp, and only when it changes.
+ *
+ * Number of buckets is fixed at construction, so table must be sized for the expected number of
+ * items up front, chains get longer as the number of items grows beyond it.
+ */
+class LockFreeLRU : public Afina::Storage {
+public:
+    /**
+     * Creates storage with the given memory limit and index sized for the given number of items, by
+     * default it is one bucket per 256 bytes of the limit
+     */
+    explicit LockFreeLRU(size_t max_size = 1024, size_t expected_items = 0);
+    ~LockFreeLRU();
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override;
+
+    // Implements Afina::Storage interface
+    bool Resize(size_t max_size) override;
+
+    /**
+     * Memory taken by the item with the given key and value sizes, the limit is checked against
+     */
+    static size_t ItemSize(size_t key_size, size_t value_size);
+
+    // Memory taken by all items now, including removed ones which aren't freed yet
+    size_t size() const { return _memory->size.load(std::memory_order_relaxed); }
+
+    // Number of buckets of the index
+    size_t buckets() const { return _mask + 1; }
+
+private:
+    // Number of items eviction compares
+    static constexpr size_t kEvictionSamples = 5;
+
+    // Eviction frees at most that much memory more than the item being added takes, so that the
+    // lowered memory limit is reached gradually
+    static constexpr size_t kShrinkStep = 16 * 1024;
+
+    // Eviction stops probing after that many buckets per sample, unless nothing is found yet
+    static constexpr size_t kBucketsPerSample = 64;
+
+    // Memory accounting shared by the storage and its retired items
+    struct lf_memory {
+        lf_memory() : size(0), refs(1) {}
+
+        // Memory taken by all items, including retired ones
+        std::atomic<size_t> size;
+
+        // Storage itself and every retired item not freed yet
+        std::atomic<size_t> refs;
+    };
+
+    // Item never changes once linked into the table, but the access stamp
+    struct lf_node {
+        std::atomic<lf_node *> next;
+
+        // Time of the last access in milliseconds, see Touch
+        std::atomic<uint32_t> access;
+
+        uint32_t hash;
+
+        // Time in seconds the item expires at, zero if it never does
+        uint32_t deadline;
+
+        uint32_t key_size;
+        uint32_t value_size;
+
+        // Key followed by value
+        char *data() { return reinterpret_cast<char *>(this + 1); }
+    };
+
+    // What to do with the item of the key already present, see Store
+    enum class Mode { Put, PutIfAbsent, Set };
+
+    static uint32_t Hash(const std::string &key);
+
+    // Time in seconds deadlines are compared with
+    static uint32_t Now();
+
+    // Time in milliseconds access stamps are taken from
+    static uint32_t NowMillis();
+
+    static bool Matches(lf_node *node, const std::string &key, uint32_t hash) {
+        return node->hash == hash && node->key_size == key.size() &&
+               key.compare(0, key.size(), node->data(), node->key_size) == 0;
+    }
+
+    static bool Expired(const lf_node *node, uint32_t now) { return node->deadline != 0 && node->deadline <= now; }
+
+    // Updates item access time, stamp is written only if it has changed to keep the cache line shared
+    static void Touch(lf_node *node);
+
+    static lf_node *NewNode(const std::string &key, uint32_t hash, const std::string &value, uint32_t deadline);
+    static void FreeNode(void *node);
+
+    // Frees retired item and takes it out of the accounting given as the context
+    static void FreeRetired(void *node, void *memory);
+
+    // Drops reference to the accounting, the last one frees it
+    static void Release(lf_memory *memory);
+
+    // Unlinked item is freed once no reader could access it
+    void Retire(lf_node *node);
+
+    // Head of the bucket chain, could be called without the lock
+    lf_node *Head(size_t bucket) const {
+        return reinterpret_cast<lf_node *>(_buckets[bucket].load(std::memory_order_acquire) & ~uintptr_t(1));
+    }
+
+    // Spins until bucket is locked by the calling thread
+    void Lock(size_t bucket);
+    void Unlock(size_t bucket);
+
+    // Points link of the locked bucket, which is either the bucket head or next field of prev, to node
+    void Link(size_t bucket, lf_node *prev, lf_node *node);
+
+    // Finds item of the key in the locked bucket, sets prev to the item before it in chain or to the
+    // last item if key is absent
+    lf_node *FindLocked(size_t bucket, const std::string &key, uint32_t hash, lf_node *&prev) const;
+
+    // Adds, replaces or updates item, see Mode. Unless ttl is given, update keeps item deadline
+    bool Store(const std::string &key, const std::string &value, Mode mode, bool keep_deadline, uint32_t ttl);
+
+    // Evicts items until storage fits the limit or the given amount of memory is freed
+    void Evict(size_t required);
+
+    // Evicts one of a few sampled items and sets freed to its size, which is zero if someone else has
+    // removed the item meanwhile. Returns false if no item was found
+    bool EvictOne(size_t &freed);
+
+    std::unique_ptr<std::atomic<uintptr_t>[]> _buckets;
+    size_t _mask;
+
+    // Memory limit and memory used by all items
+    std::atomic<size_t> _max_size;
+    lf_memory *_memory;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_LOCK_FREE_LRU_H
@@ -0,0 +1,63 @@
+#include "Reclaimer.h"
+
+#include <chrono>
+
+#include "ThreadSafeSimpleLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+// See Reclaimer.h
+void Reclaimer::Start(std::vector<ThreadSafeSimpleLRU *> storages) {
+    _storages = std::move(storages);
+    _running = true;
+    _woken = false;
+    _thread = std::thread(&Reclaimer::Run, this);
+}
+
+// See Reclaimer.h
+void Reclaimer::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _condition.notify_one();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+// See Reclaimer.h
+void Reclaimer::Wake() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _woken = true;
+    }
+    _condition.notify_one();
+}
+
+// See Reclaimer.h
+void Reclaimer::Run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+        _condition.wait_for(lock, std::chrono::seconds(1), [this] { return _woken || !_running; });
+        _woken = false;
+        lock.unlock();
+
+        // Storages are served in turns batch by batch, so that none of them waits for the others
+        bool more = true;
+        while (more) {
+            more = false;
+            for (ThreadSafeSimpleLRU *storage : _storages) {
+                more |= storage->Reclaim();
+            }
+
+            std::lock_guard<std::mutex> check(_mutex);
+            more &= _running;
+        }
+        lock.lock();
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
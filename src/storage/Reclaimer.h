@@ -0,0 +1,58 @@
+#ifndef AFINA_STORAGE_RECLAIMER_H
+#define AFINA_STORAGE_RECLAIMER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+class ThreadSafeSimpleLRU;
+
+/**
+ * # Background memory reclaim
+ * Thread keeping free memory of the storages above the low watermark, so that writers almost never
+ * evict items themselves. Storage wakes the thread up once its free memory drops below the low
+ * watermark, then the thread evicts items in small batches, holding the storage lock for one batch
+ * only, until free memory gets to the high watermark.
+ *
+ * Thread also wakes up every second to reclaim expired items of storages nobody writes to.
+ */
+class Reclaimer {
+public:
+    Reclaimer() : _running(false), _woken(false) {}
+    ~Reclaimer() { Stop(); }
+
+    /**
+     * Starts the thread serving the given storages, they must outlive Stop()
+     */
+    void Start(std::vector<ThreadSafeSimpleLRU *> storages);
+
+    /**
+     * Stops the thread and waits for it, does nothing if it isn't running
+     */
+    void Stop();
+
+    /**
+     * Makes the thread check all storages as soon as possible
+     */
+    void Wake();
+
+private:
+    void Run();
+
+    std::vector<ThreadSafeSimpleLRU *> _storages;
+    std::thread _thread;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _running;
+    bool _woken;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_RECLAIMER_H
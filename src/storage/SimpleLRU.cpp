@@ -1,163 +1,796 @@
-#include <algorithm>
-#include <iostream>
-#include <fstream>
 #include "SimpleLRU.h"
 
+#include <cstring>
+#include <ctime>
+#include <new>
+
+#include <afina/allocator/Error.h>
+
 namespace Afina {
 namespace Backend {
 
-bool SimpleLRU::PutItem(const std::string &key, const std::string &value) {
-  std::size_t additional_size = key.size() + value.size();
-  if (additional_size > _max_size)
-    return false;
-
-  while (_actual_size + additional_size > _max_size) {
-    Delete(_lru_tail->_key);
-  }
-
-  _actual_size += additional_size;
-
-  if (_lru_head)
-  {
-    std::unique_ptr<lru_node> old_head (std::move(_lru_head));
-    _lru_head.reset(new lru_node (key, value));
-    _lru_head->_next = std::move(old_head);
-    if (_lru_head->_next)
-      _lru_head->_next->_prev = _lru_head.get();
-    if (_lru_tail == nullptr)
-      _lru_tail = _lru_head.get();
-  }
-  else
-  {
-    _lru_head.reset(new lru_node (key, value));
-    _lru_tail = _lru_head.get();
-  }
-
-
-  _lru_index.insert(std::make_pair(std::ref(_lru_head->_key), std::ref(*_lru_head)));
-  return true;
-}
-
-bool SimpleLRU::SetItem(const std::string &key, const std::string &value,
-                        iterator_class &item) {
-    if (key.size() + value.size() > _max_size)
+namespace {
+
+// Values of at least that size are kept in shared buffers, smaller ones are cheaper to copy, see
+// also Execute::Output which references values of the same size
+constexpr size_t kMinSharedValue = 2048;
+
+// Number of keys MultiGet prefetches index memory for at once
+constexpr size_t kMultiGetGroup = 16;
+
+// Share of the memory limit protected segment of segmented LRU could take
+constexpr size_t kProtectedPercent = 80;
+
+// Share of the memory limit W-TinyLFU window takes
+constexpr size_t kWindowPercent = 1;
+
+// Number of old buckets each insert moves while index grows. Rehash is over after inserts of a few
+// percent of items, so chains of the buckets not moved yet don't get long meanwhile
+constexpr size_t kRehashStep = 16;
+
+} // namespace
+
+constexpr size_t SimpleLRU::kShrinkStep;
+constexpr size_t SimpleLRU::kWheelLevels;
+constexpr size_t SimpleLRU::kWheelBits;
+constexpr size_t SimpleLRU::kWheelSlots;
+
+// See SimpleLRU.h
+SimpleLRU::SimpleLRU(size_t max_size, Policy policy)
+    : _max_size(max_size), _limit(max_size), _buckets(16, lru_bucket(nullptr)), _lru(kSegments), _policy(policy) {}
+
+// See SimpleLRU.h
+SimpleLRU::SimpleLRU(std::unique_ptr<Allocator::Slab> slab, Policy policy)
+    : _max_size(slab->limit()), _limit(_max_size), _slab(std::move(slab)), _buckets(16, lru_bucket(nullptr)),
+      _lru(_slab->classes() * kSegments), _policy(policy) {}
+
+// See SimpleLRU.h
+SimpleLRU::SimpleLRU(size_t max_size, size_t arena_size, Policy policy)
+    : _max_size(max_size), _limit(max_size), _arena_region(new char[arena_size]),
+      _arena(new Allocator::Simple(_arena_region.get(), arena_size)), _arena_reserve(arena_size / 8),
+      _buckets(16, lru_bucket(nullptr)), _lru(kSegments), _policy(policy) {}
+
+// See SimpleLRU.h
+SimpleLRU::SimpleLRU(size_t max_size, std::shared_ptr<Allocator::SmallAlloc> items, Policy policy)
+    : _max_size(max_size), _limit(max_size), _small(std::move(items)),
+      _index_resource(new Allocator::SmallAllocResource(*_small)),
+      _buckets(16, lru_bucket(nullptr), _index_resource.get()), _old_buckets(_index_resource.get()), _lru(kSegments),
+      _policy(policy) {}
+
+// See SimpleLRU.h
+SimpleLRU::~SimpleLRU() {
+    for (lru_list &list : _lru) {
+        while (list.head) {
+            lru_node *next = list.head->_next;
+            FreeNode(list.head);
+            list.head = next;
+        }
+    }
+}
+
+// See SimpleLRU.h
+size_t SimpleLRU::ItemSize(size_t key_size, size_t value_size) { return sizeof(lru_node) + key_size + value_size; }
+
+// See SimpleLRU.h
+uint32_t SimpleLRU::Now() const {
+    // Coarse clock is read without syscall and costs a few nanoseconds, second precision is enough
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return uint32_t(ts.tv_sec);
+}
+
+// See SimpleLRU.h
+uint32_t SimpleLRU::Hash(const std::string &key) {
+    uint64_t h = std::hash<std::string>()(key);
+    return uint32_t(h ^ (h >> 32));
+}
+
+// See SimpleLRU.h
+Allocator::Pointer SimpleLRU::ArenaAlloc(size_t size) {
+    try {
+        return _arena->alloc(size);
+    } catch (Allocator::AllocError &) {
+    }
+
+    // Either there is no free space or it is fragmented. Make enough room with some reserve, so that
+    // the next few allocations don't need compaction, and then put all free space together
+    lru_node *victim;
+    while (_arena->available() < size + _arena_reserve && (victim = Victim(0)) != nullptr) {
+        DeleteItem(victim);
+    }
+    _arena->defrag();
+
+    try {
+        return _arena->alloc(size);
+    } catch (Allocator::AllocError &) {
+        return Allocator::Pointer();
+    }
+}
+
+// See SimpleLRU.h
+SimpleLRU::lru_node *SimpleLRU::AllocNode(const char *key, size_t key_size, uint32_t hash,
+                                          const std::string &value, uint32_t deadline) {
+    std::size_t extra = deadline != 0 ? sizeof(lru_expiry) : 0;
+    std::size_t size = extra + ItemSize(key_size, value.size());
+    std::size_t size_class = ClassOf(size);
+    lru_node *victim;
+
+    // Block of the shared value node holds only the reference, but the whole value is accounted
+    bool shared = !_slab && !_arena && value.size() >= kMinSharedValue;
+    std::size_t block_size = shared ? extra + HandleOffset<shared_value>(key_size) + sizeof(shared_value) : size;
+
+    void *block = nullptr;
+    if (_slab) {
+        // Chunks are reused within a size class only, so evict items of the same class
+        while ((block = _slab->alloc(size)) == nullptr && (victim = Victim(size_class)) != nullptr) {
+            DeleteItem(victim);
+        }
+        if (block == nullptr) {
+            return nullptr;
+        }
+        size = _slab->chunk_size(_slab->class_of(size));
+    } else {
+        Shrink();
+        while (_actual_size + size > _limit) {
+            DeleteItem(Victim(size_class));
+        }
+
+        // Allocator could be shared and exhausted by other storages, make room from this one then
+        while (_small && (block = _small->alloc(block_size)) == nullptr && (victim = Victim(size_class)) != nullptr) {
+            DeleteItem(victim);
+        }
+        if (_small && block == nullptr) {
+            return nullptr;
+        }
+    }
+
+    Allocator::Pointer arena_value;
+    if (_arena) {
+        arena_value = ArenaAlloc(value.size());
+        if (arena_value.get() == nullptr) {
+            return nullptr;
+        }
+        block = ::operator new(extra + HandleOffset<Allocator::Pointer>(key_size) + sizeof(Allocator::Pointer));
+    } else if (block == nullptr) {
+        block = ::operator new(block_size);
+    }
+
+    lru_node *node = reinterpret_cast<lru_node *>(static_cast<char *>(block) + extra);
+    node->_prev = node->_next = node->_hash_next = nullptr;
+    node->_hash = hash;
+    node->_key_size = key_size;
+    node->_segment = kProbation;
+    node->_flags = extra != 0 ? kExpiring : 0;
+    node->_value_size = value.size();
+    node->_value_capacity = shared ? 0 : size - extra - sizeof(lru_node) - key_size;
+    if (extra != 0) {
+        Expiry(node)->deadline = deadline;
+    }
+    std::memcpy(node->key(), key, key_size);
+    if (shared) {
+        new (&SharedValue(node)) shared_value(std::make_shared<const std::string>(value));
+    } else {
+        if (_arena) {
+            new (&ArenaValue(node)) Allocator::Pointer(arena_value);
+        }
+        std::memcpy(Value(node), value.data(), value.size());
+    }
+
+    _actual_size += size;
+    return node;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::FreeNode(lru_node *node) {
+    std::size_t block_size = BlockSize(node);
+    if (_arena) {
+        _arena->free(ArenaValue(node));
+        ArenaValue(node).~Pointer();
+    } else if (Shared(node)) {
+        SharedValue(node).~shared_value();
+        block_size = ExpirySize(node) + HandleOffset<shared_value>(node->_key_size) + sizeof(shared_value);
+    }
+
+    void *block = Expiring(node) ? static_cast<void *>(Expiry(node)) : node;
+    if (_slab) {
+        _slab->free(block, block_size);
+    } else if (_small) {
+        _small->free(block, block_size);
+    } else {
+        ::operator delete(block);
+    }
+}
+
+// See SimpleLRU.h
+SimpleLRU::lru_node *SimpleLRU::Find(const std::string &key, uint32_t hash) const {
+    lru_node *node = Bucket(hash);
+    for (; node != nullptr; node = node->_hash_next) {
+        if (node->_hash == hash && node->_key_size == key.size() &&
+            std::memcmp(node->key(), key.data(), key.size()) == 0) {
+            break;
+        }
+    }
+    return node;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::IndexInsert(lru_node *node) {
+    if (!_old_buckets.empty()) {
+        RehashStep(kRehashStep);
+    }
+    if (_items >= _buckets.size()) {
+        Grow();
+    }
+
+    lru_node *&bucket = Bucket(node->_hash);
+    node->_hash_next = bucket;
+    bucket = node;
+    _items++;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::IndexRemove(lru_node *node) {
+    lru_node **pos = &Bucket(node->_hash);
+    while (*pos != node) {
+        pos = &(*pos)->_hash_next;
+    }
+    *pos = node->_hash_next;
+    _items--;
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::Resize(size_t max_size) {
+    if (_slab) {
         return false;
+    }
+
+    // Nothing is evicted right now, the limit writers meet goes down step by step
+    _max_size = max_size;
+    _limit = std::max(max_size, std::min(_limit, _actual_size));
+    return true;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::Reserve(size_t items) {
+    std::size_t size = _buckets.size();
+    while (size < items) {
+        size *= 2;
+    }
+    if (size == _buckets.size()) {
+        return;
+    }
+
+    Allocator::Vector<lru_bucket> buckets(_buckets.get_allocator());
+    buckets.resize(size);
+    RehashStep(_old_buckets.size());
+    StartRehash(buckets);
+    RehashStep(_old_buckets.size());
+}
+
+// See SimpleLRU.h
+void SimpleLRU::Grow() {
+    Allocator::Vector<lru_bucket> buckets(_buckets.get_allocator());
+    try {
+        buckets.resize(_buckets.size() * 2);
+    } catch (std::bad_alloc &) {
+        // Shared allocator is exhausted, index still works with longer chains
+        return;
+    }
+
+    // Previous rehash is normally over by now, see kRehashStep
+    RehashStep(_old_buckets.size());
+    StartRehash(buckets);
+}
+
+// See SimpleLRU.h
+void SimpleLRU::StartRehash(Allocator::Vector<lru_bucket> &buckets) {
+    _old_buckets.swap(_buckets);
+    _buckets.swap(buckets);
+    _rehash_pos = 0;
+
+    // Sketch tells apart about as many keys as there are items, estimates gathered so far are kept
+    if (_policy == Policy::TinyLFU) {
+        _sketch.Rebuild(_buckets.size());
+    }
+}
+
+// See SimpleLRU.h
+void SimpleLRU::RehashStep(size_t count) {
+    if (_old_buckets.empty()) {
+        return;
+    }
+
+    // Items of the old bucket go to the new buckets with the same low bits of the index only, those
+    // are set right before, nothing could get there earlier
+    std::size_t old_size = _old_buckets.size();
+    std::size_t end = std::min(old_size, _rehash_pos + count);
+    for (; _rehash_pos < end; _rehash_pos++) {
+        for (std::size_t i = _rehash_pos; i < _buckets.size(); i += old_size) {
+            _buckets[i].head = nullptr;
+        }
+
+        lru_node *node = _old_buckets[_rehash_pos].head;
+        while (node != nullptr) {
+            lru_node *next = node->_hash_next;
+            lru_node *&bucket = _buckets[node->_hash & (_buckets.size() - 1)].head;
+            node->_hash_next = bucket;
+            bucket = node;
+            node = next;
+        }
+    }
+
+    if (_rehash_pos == _old_buckets.size()) {
+        Allocator::Vector<lru_bucket>(_old_buckets.get_allocator()).swap(_old_buckets);
+        _rehash_pos = 0;
+    }
+}
+
+// See SimpleLRU.h
+void SimpleLRU::Unlink(lru_list &list, lru_node *node) const {
+    if (node->_prev) {
+        node->_prev->_next = node->_next;
+    } else {
+        list.head = node->_next;
+    }
+
+    if (node->_next) {
+        node->_next->_prev = node->_prev;
+    } else {
+        list.tail = node->_prev;
+    }
+}
 
-    auto &i = item->second.get();
+// See SimpleLRU.h
+void SimpleLRU::LinkHead(lru_list &list, lru_node *node) const {
+    node->_prev = nullptr;
+    node->_next = list.head;
+    if (list.head) {
+        list.head->_prev = node;
+    } else {
+        list.tail = node;
+    }
+    list.head = node;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::MoveToHead(lru_node *node) const {
+    if (_policy != Policy::LRU && node->_segment == kProbation) {
+        Promote(node);
+        return;
+    }
+
+    lru_list &list = ListOf(node);
+    if (node != list.head) {
+        Unlink(list, node);
+        LinkHead(list, node);
+    }
+}
+
+// See SimpleLRU.h
+void SimpleLRU::Promote(lru_node *node) const {
+    std::size_t block_size = BlockSize(node);
+    std::size_t size_class = ClassOf(block_size);
+    lru_list &probation = ListOf(size_class, kProbation);
+    lru_list &protect = ListOf(size_class, kProtected);
+
+    Unlink(probation, node);
+    node->_segment = kProtected;
+    LinkHead(protect, node);
+    _protected_size += block_size;
+
+    // Demoted items get one more chance: they are the most recent in probation and get back once accessed
+    while (_protected_size * 100 > _max_size * kProtectedPercent && protect.tail != node) {
+        lru_node *demoted = protect.tail;
+        Unlink(protect, demoted);
+        demoted->_segment = kProbation;
+        LinkHead(probation, demoted);
+        _protected_size -= BlockSize(demoted);
+    }
+}
+
+// See SimpleLRU.h
+SimpleLRU::lru_node *SimpleLRU::Victim(size_t size_class) {
+    if (_policy != Policy::TinyLFU) {
+        return MainVictim(size_class);
+    }
 
-    // Update LRU structure
-    if (_lru_head->_key != key) {
-        if (_lru_tail->_key == key) {
-            _lru_head->_prev = _lru_tail;
-            _lru_tail->_next = std::move(_lru_head);
-            _lru_head = std::move(_lru_tail->_prev->_next);
-            _lru_tail = _lru_tail->_next.get();
-            _lru_head->_prev = nullptr;
+    // Window takes everything while nothing is evicted. Then its least recent items move to the main cache
+    // for free until it is full and after that each of them is admitted only if used more often than the
+    // main cache victim, ties keep the latter. So the window stays at its share
+    lru_list &window = ListOf(size_class, kWindow);
+    std::size_t main_limit = _max_size - _max_size * kWindowPercent / 100;
+    while (window.tail != nullptr) {
+        lru_node *candidate = window.tail;
+        lru_node *victim = MainVictim(size_class);
+        bool room = _actual_size - _window_size + BlockSize(candidate) <= main_limit;
+        if (!room && victim != nullptr && _sketch.Estimate(candidate->_hash) <= _sketch.Estimate(victim->_hash)) {
+            return candidate;
+        }
+
+        Unlink(window, candidate);
+        candidate->_segment = kProbation;
+        LinkHead(ListOf(size_class, kProbation), candidate);
+        _window_size -= BlockSize(candidate);
+        if (!room && victim != nullptr) {
+            return victim;
+        }
+    }
+    return MainVictim(size_class);
+}
+
+// See SimpleLRU.h
+void SimpleLRU::WheelInsert(lru_node *node) {
+    WheelLink(node);
+    _wheel_items++;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::WheelLink(lru_node *node) {
+    // Level is the first one which slots span covers the time left, item that is due already goes to
+    // the slot processed right now
+    uint32_t deadline = std::max(Expiry(node)->deadline, _wheel_time);
+    uint32_t left = deadline - _wheel_time;
+    size_t level = 0;
+    while (level + 1 < kWheelLevels && left >= (uint32_t(1) << ((level + 1) * kWheelBits))) {
+        level++;
+    }
+
+    lru_node *&slot = _wheel[level][(deadline >> (level * kWheelBits)) & (kWheelSlots - 1)];
+    lru_expiry *expiry = Expiry(node);
+    expiry->next = slot;
+    expiry->pprev = &slot;
+    if (slot != nullptr) {
+        Expiry(slot)->pprev = &expiry->next;
+    }
+    slot = node;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::WheelRemove(lru_node *node) {
+    if (Deadline(node) == 0) {
+        return;
+    }
+
+    lru_expiry *expiry = Expiry(node);
+    *expiry->pprev = expiry->next;
+    if (expiry->next != nullptr) {
+        Expiry(expiry->next)->pprev = expiry->pprev;
+    }
+    _wheel_items--;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::Expire() {
+    uint32_t now = Now();
+    while (_wheel_time < now && _wheel_items > 0) {
+        _wheel_time++;
+
+        // Slot of the higher level is due once all lower levels wrap, its items are spread over them
+        for (size_t level = 1; level < kWheelLevels; level++) {
+            if ((_wheel_time & ((uint32_t(1) << (level * kWheelBits)) - 1)) != 0) {
+                break;
+            }
+
+            lru_node *&slot = _wheel[level][(_wheel_time >> (level * kWheelBits)) & (kWheelSlots - 1)];
+            lru_node *node = slot;
+            slot = nullptr;
+            while (node != nullptr) {
+                lru_node *next = Expiry(node)->next;
+                WheelLink(node);
+                node = next;
+            }
+        }
+
+        lru_node *&slot = _wheel[0][_wheel_time & (kWheelSlots - 1)];
+        while (slot != nullptr) {
+            DeleteItem(slot);
+        }
+    }
+
+    // Nothing to expire, wheel just catches up
+    if (_wheel_time < now) {
+        _wheel_time = now;
+    }
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::Reclaim(size_t free_percent, size_t count, void *&detached) {
+    Expire();
+    if (_slab) {
+        return true;
+    }
+
+    // Victim is removed by the node, same as writers do, no key lookup is involved. Heap and shared
+    // allocator are thread safe, so the block could be freed later
+    lru_node *chain = static_cast<lru_node *>(detached);
+    for (; FreePercent() < free_percent; count--) {
+        lru_node *victim = Victim(0);
+        if (victim == nullptr) {
+            break;
+        } else if (count == 0) {
+            detached = chain;
+            return false;
+        }
+
+        if (_arena) {
+            DeleteItem(victim);
         } else {
-            std::unique_ptr<lru_node> tmp =  std::move(i._next);
-            _lru_head->_prev = i._prev->_next.get();
-            i._next = std::move(_lru_head);
-            _lru_head = std::move(i._prev->_next);
-            tmp->_prev = _lru_head->_prev;
-            _lru_head->_prev->_next = std::move(tmp);
+            DetachItem(victim);
+            victim->_next = chain;
+            chain = victim;
         }
     }
+    detached = chain;
+    return true;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::Release(void *detached) {
+    lru_node *node = static_cast<lru_node *>(detached);
+    while (node != nullptr) {
+        lru_node *next = node->_next;
+        FreeNode(node);
+        node = next;
+    }
+}
 
-    _actual_size = _actual_size - _lru_head->_value.size() + value.size();
-    while (_actual_size > _max_size) {
-        Delete(_lru_tail->_key);
+// See SimpleLRU.h
+SimpleLRU::lru_node *SimpleLRU::FindLive(const std::string &key, uint32_t hash) {
+    lru_node *node = Find(key, hash);
+    if (node != nullptr && Expired(node)) {
+        DeleteItem(node);
+        return nullptr;
     }
+    return node;
+}
 
-    _lru_head->_value.assign(value);
+// See SimpleLRU.h
+bool SimpleLRU::PutItem(const std::string &key, uint32_t hash, const std::string &value, uint32_t deadline) {
+    std::size_t size = (deadline != 0 ? sizeof(lru_expiry) : 0) + ItemSize(key.size(), value.size());
+    if (size > (_slab ? _slab->max_size() : _max_size) || key.size() > UINT16_MAX) {
+        return false;
+    }
+
+    lru_node *node = AllocNode(key.data(), key.size(), hash, value, deadline);
+    if (node == nullptr) {
+        return false;
+    }
+    LinkItem(node);
     return true;
 }
 
-// See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Put(const std::string &key, const std::string &value) {
-    auto item = _lru_index.find(key);
-    if (item != _lru_index.end())
-      return SetItem(key, value, item);
+// See SimpleLRU.h
+void SimpleLRU::LinkItem(lru_node *node) {
+    if (Deadline(node) != 0) {
+        WheelInsert(node);
+    }
 
-    return PutItem(key, value);
+    // W-TinyLFU puts new items to the window, they get to the main cache once pushed out of it
+    if (_policy == Policy::TinyLFU) {
+        node->_segment = kWindow;
+        _window_size += BlockSize(node);
+    }
+    LinkHead(ListOf(node), node);
+    IndexInsert(node);
+    Record(node->_hash);
 }
 
-// See MapBasedGlobalLockImpl.h
+// See SimpleLRU.h
+bool SimpleLRU::SetItem(lru_node *node, const std::string &value, uint32_t deadline) {
+    if (!Shared(node) && value.size() <= node->_value_capacity && (Expiring(node) || deadline == 0)) {
+        // Update in place, block keeps its size. Shared value is immutable, it is always replaced
+        std::memcpy(Value(node), value.data(), value.size());
+        node->_value_size = value.size();
+        if (Deadline(node) != deadline) {
+            WheelRemove(node);
+            Expiry(node)->deadline = deadline;
+            if (deadline != 0) {
+                WheelInsert(node);
+            }
+        }
+        MoveToHead(node);
+        return true;
+    }
+
+    std::size_t size = (deadline != 0 ? sizeof(lru_expiry) : 0) + ItemSize(node->_key_size, value.size());
+    if (size > (_slab ? _slab->max_size() : _max_size)) {
+        return false;
+    }
+
+    // Value doesn't fit, replace the whole block. New one is built first, so that failed update
+    // keeps the old value. Meanwhile old one is out of the lists and accounting, so that it
+    // couldn't be evicted while making room and doesn't take the room itself
+    UnlinkItem(node);
+    lru_node *replacement = AllocNode(node->key(), node->_key_size, node->_hash, value, deadline);
+    if (replacement == nullptr) {
+        RelinkItem(node);
+        return false;
+    }
+
+    IndexRemove(node);
+    FreeNode(node);
+    LinkItem(replacement);
+    return true;
+}
+
+// See SimpleLRU.h
+void SimpleLRU::DeleteItem(lru_node *node) {
+    DetachItem(node);
+    FreeNode(node);
+}
+
+// See SimpleLRU.h
+void SimpleLRU::DetachItem(lru_node *node) {
+    UnlinkItem(node);
+    IndexRemove(node);
+}
+
+// See SimpleLRU.h
+void SimpleLRU::UnlinkItem(lru_node *node) {
+    WheelRemove(node);
+    _actual_size -= BlockSize(node);
+    if (node->_segment == kProtected) {
+        _protected_size -= BlockSize(node);
+    } else if (node->_segment == kWindow) {
+        _window_size -= BlockSize(node);
+    }
+    Unlink(ListOf(node), node);
+}
+
+// See SimpleLRU.h
+void SimpleLRU::RelinkItem(lru_node *node) {
+    if (Deadline(node) != 0) {
+        WheelInsert(node);
+    }
+    _actual_size += BlockSize(node);
+    if (node->_segment == kProtected) {
+        _protected_size += BlockSize(node);
+    } else if (node->_segment == kWindow) {
+        _window_size += BlockSize(node);
+    }
+    LinkHead(ListOf(node), node);
+}
+
+// See Storage.h
+bool SimpleLRU::Put(const std::string &key, const std::string &value) { return SimpleLRU::Put(key, value, 0); }
+
+// See Storage.h
+bool SimpleLRU::Put(const std::string &key, const std::string &value, uint32_t ttl) {
+    Expire();
+    uint32_t hash = Hash(key);
+    lru_node *node = FindLive(key, hash);
+    if (node != nullptr) {
+        return SetItem(node, value, DeadlineOf(ttl));
+    }
+    return PutItem(key, hash, value, DeadlineOf(ttl));
+}
+
+// See Storage.h
 bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value) {
-  if (_lru_index.find(key) != _lru_index.end())
-    return false;
+    return SimpleLRU::PutIfAbsent(key, value, 0);
+}
 
-  return PutItem(key, value);
+// See Storage.h
+bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) {
+    Expire();
+    uint32_t hash = Hash(key);
+    if (FindLive(key, hash) != nullptr) {
+        return false;
+    }
+    return PutItem(key, hash, value, DeadlineOf(ttl));
 }
 
-// See MapBasedGlobalLockImpl.h
+// See Storage.h
 bool SimpleLRU::Set(const std::string &key, const std::string &value) {
-  auto item = _lru_index.find(key);
-  if (item == _lru_index.end())
-    return false;
+    Expire();
+    lru_node *node = FindLive(key, Hash(key));
+    if (node == nullptr) {
+        return false;
+    }
+    return SetItem(node, value, Deadline(node));
+}
 
-  return SetItem(key, value, item);
+// See Storage.h
+bool SimpleLRU::Set(const std::string &key, const std::string &value, uint32_t ttl) {
+    Expire();
+    lru_node *node = FindLive(key, Hash(key));
+    if (node == nullptr) {
+        return false;
+    }
+    return SetItem(node, value, DeadlineOf(ttl));
 }
 
-// See MapBasedGlobalLockImpl.h
+// See Storage.h
 bool SimpleLRU::Delete(const std::string &key) {
-    auto item = _lru_index.find(key);
-    if (item == _lru_index.end())
+    Expire();
+    lru_node *node = FindLive(key, Hash(key));
+    if (node == nullptr) {
         return false;
+    }
 
-    _actual_size = _actual_size - key.size() - item->second.get()._value.size();
-    auto &curr = item->second.get()._prev ? item->second.get()._prev->_next : _lru_head;
-    if (curr->_next) {
-        curr->_next->_prev = curr->_prev;
-        if (curr->_prev) {
-            curr->_prev->_next = std::move(curr->_next);
-        }
-        else {
-            _lru_head = std::move(curr->_next);
-        }
+    DeleteItem(node);
+    return true;
+}
+
+// See Storage.h
+bool SimpleLRU::Get(const std::string &key, std::string &value) const {
+    uint32_t hash = Hash(key);
+    Record(hash);
+    lru_node *node = Find(key, hash);
+    if (node == nullptr || Expired(node)) {
+        return false;
     }
-    else {
-        lru_node *_tail_prev = _lru_tail->_prev;
-        if (_tail_prev) {
-            _lru_tail->_prev->_next.reset();
-        }
-        else {
-            _lru_head.reset();
-        }
-        _lru_tail = _tail_prev;
+
+    if (Shared(node)) {
+        value.assign(*SharedValue(node));
+    } else {
+        value.assign(Value(node), node->_value_size);
     }
+    MoveToHead(node);
+    return true;
+}
 
-    _lru_index.erase(item);
+// See Storage.h
+bool SimpleLRU::GetShared(const std::string &key, std::shared_ptr<const std::string> &value) const {
+    std::string copy;
+    std::shared_ptr<const std::string> shared;
+    if (!Lookup(key, copy, shared)) {
+        return false;
+    }
+
+    value = shared ? std::move(shared) : std::make_shared<const std::string>(std::move(copy));
     return true;
 }
 
-// See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Get(const std::string &key, std::string &value) const {
-  auto item = _lru_index.find(key);
-  if (item == _lru_index.end())
-    return false;
-
-  lru_node &curr = item->second.get();
-  value.assign(curr._value);
-
-  if (curr._key != _lru_head->_key) {
-    if (curr._next) {
-      std::unique_ptr<lru_node> tmp = std::move(curr._next);
-      tmp->_prev = curr._prev;
-      curr._next = std::move(_lru_head);
-      _lru_head = std::move(curr._prev->_next);
-      curr._prev->_next = std::move(tmp);
-      _lru_head->_next->_prev = _lru_head.get();
-    }
-    else {
-      _lru_tail = curr._prev;
-      curr._next = std::move(_lru_head);
-      _lru_head = std::move(curr._prev->_next);
-      _lru_head->_next->_prev = _lru_head.get();
-    }
-    _lru_head->_prev = nullptr;
-  }
-
-  return true;
+// See Storage.h
+bool SimpleLRU::Lookup(const std::string &key, std::string &value, std::shared_ptr<const std::string> &shared) const {
+    uint32_t hash = Hash(key);
+    Record(hash);
+    lru_node *node = Find(key, hash);
+    if (node == nullptr || Expired(node)) {
+        return false;
+    }
+
+    Read(node, value, shared);
+    return true;
+}
+
+// See Storage.h
+void SimpleLRU::MultiGet(Entry **entries, size_t count) const {
+    // Buckets of the whole group are requested first, then chain heads, so that cache misses of
+    // different keys overlap instead of going one after another
+    uint32_t hashes[kMultiGetGroup];
+    for (size_t begin = 0; begin < count; begin += kMultiGetGroup) {
+        size_t size = std::min(count - begin, kMultiGetGroup);
+        for (size_t i = 0; i < size; i++) {
+            hashes[i] = Hash(entries[begin + i]->key);
+            __builtin_prefetch(&Bucket(hashes[i]));
+        }
+        for (size_t i = 0; i < size; i++) {
+            __builtin_prefetch(Bucket(hashes[i]));
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            Entry &entry = *entries[begin + i];
+            entry.shared.reset();
+            Record(hashes[i]);
+            lru_node *node = Find(entry.key, hashes[i]);
+            entry.found = node != nullptr && !Expired(node);
+            if (entry.found) {
+                Read(node, entry.value, entry.shared);
+            }
+        }
+    }
+}
+
+// See SimpleLRU.h
+void SimpleLRU::Read(lru_node *node, std::string &value, std::shared_ptr<const std::string> &shared) const {
+    if (Shared(node)) {
+        shared = SharedValue(node);
+    } else {
+        value.assign(Value(node), node->_value_size);
+    }
+    MoveToHead(node);
 }
 
 } // namespace Backend
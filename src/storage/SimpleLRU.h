@@ -1,13 +1,22 @@
 #ifndef AFINA_STORAGE_SIMPLE_LRU_H
 #define AFINA_STORAGE_SIMPLE_LRU_H
 
-#include <unordered_map>
-#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <afina/Storage.h>
+#include <afina/allocator/Pointer.h>
+#include <afina/allocator/Simple.h>
+#include <afina/allocator/Slab.h>
+#include <afina/allocator/SmallAlloc.h>
+#include <afina/allocator/StlAllocator.h>
+
+#include "FrequencySketch.h"
 
 namespace Afina {
 namespace Backend {
@@ -15,77 +24,427 @@ namespace Backend {
 /**
  * # Map based implementation
  * That is NOT thread safe implementation!!
+ *
+ * Each item is a single memory block: header with LRU and hash chain links followed by key and
+ * value bytes. Index is a chained hash table that links items through the header, so there are
+ * no allocations besides the item itself. Index grows incrementally: once it doubles, the old bucket
+ * array is kept and each insert moves items of a few old buckets, so that no single operation pays
+ * for rehash of the whole index.
+ *
+ * Memory limit applies to the whole item blocks, i.e key and value sizes plus header. Bucket
+ * array of the index isn't accounted.
+ *
+ * Optionally item blocks could be taken from the slab allocator. In that case the memory limit is
+ * the allocator one and there is a separate LRU list per size class: once a class runs out of chunks
+ * the least recent item of the same class gets evicted, so a new item always reuses the chunk of
+ * exactly the same size.
+ *
+ * Another option is to keep values in a preallocated region managed by compacting allocator, then
+ * item block holds a handle to the value instead of value itself. Once the region has no continuous
+ * space left, items get evicted until there is enough free space plus some reserve and the region
+ * is compacted.
+ *
+ * Item blocks could also come from lock-free SmallAlloc shared by several storages, e.g stripes of
+ * StripedLRU, so that storages working in different threads don't contend in the heap.
+ *
+ * Unless slab or arena is used, large values are not placed in item blocks but kept in immutable
+ * shared buffers, item holds a reference instead. GetShared() hands out such buffer without copying
+ * it, so it could be sent to the client after the storage lock is released. Value replaced or evicted
+ * meanwhile lives until the last reference goes, that memory isn't accounted by the storage.
+ *
+ * Eviction policy is either plain LRU or segmented LRU. The latter puts new items into probation
+ * segment and moves them to protected one on the second access. Protected segment takes at most
+ * 80% of the memory limit, its least recent items go back to probation, and eviction takes the
+ * least recent probation item first. So a scan of keys accessed once only churns probation and
+ * doesn't flush the hot set.
+ *
+ * W-TinyLFU policy adds admission filter to the segmented LRU. Frequency of all keys looked up or
+ * added is estimated by a sketch. New items go to a small LRU window first, items pushed out of the
+ * window enter probation. Once room is needed, the least recent window item is the candidate and it
+ * is compared with the main space victim, the least recent probation item or protected one if
+ * probation is empty: the one estimated to be used less often is evicted, ties evict the candidate.
+ * So keys written once don't displace popular ones, while the window still lets bursts of new keys
+ * get hits. Sketch memory isn't accounted, same as index one. Sketch is rebuilt along with the index,
+ * estimates survive that.
+ *
+ * Item stored with ttl has expiration record right before the header, it is accounted as a part of
+ * the item. Expired item is never returned, and it is reclaimed by a hierarchical timing wheel: four
+ * levels of 64 slots, slot of the first level holds items expiring in a particular second, one of
+ * the next level items expiring in a particular 64 seconds interval and so on. Wheel advances on
+ * each modification, so it takes constant time per second and per expired item, items of the
+ * higher level slot are spread over the lower levels once its interval comes.
+ *
+ * Writers evict items inline once the memory limit is reached. Thread safe version could leave
+ * that to the background thread instead, see Reclaim().
  */
 class SimpleLRU : public Afina::Storage {
 public:
-    explicit SimpleLRU(size_t max_size = 1024) : _max_size(max_size) {}
-
-    ~SimpleLRU() override {
-        _lru_index.clear();
-        if (_lru_head) {
-          while (_lru_tail->_prev) {
-            _lru_tail = _lru_tail->_prev;
-            _lru_tail->_next.reset();
-          }
-          _lru_head.reset();
-        }
-    }
+    enum class Policy {
+        // Evict the least recent item
+        LRU,
+
+        // Keep items accessed more than once in protected segment, evict ones accessed once first
+        SegmentedLRU,
+
+        // Segmented LRU behind the window, which admits new items only if they are used more often than victim
+        TinyLFU
+    };
+
+    explicit SimpleLRU(size_t max_size = 1024, Policy policy = Policy::LRU);
+
+    // Items are allocated from the given slab allocator, its limit bounds the storage size
+    explicit SimpleLRU(std::unique_ptr<Allocator::Slab> slab, Policy policy = Policy::LRU);
+
+    // Values are kept in the region of arena_size bytes, max_size still limits items the usual way
+    SimpleLRU(size_t max_size, size_t arena_size, Policy policy = Policy::LRU);
+
+    // Items are allocated from the given thread safe allocator, which could be shared between storages
+    SimpleLRU(size_t max_size, std::shared_ptr<Allocator::SmallAlloc> items, Policy policy = Policy::LRU);
+
+    ~SimpleLRU() override;
 
     // Implements Afina::Storage interface
     bool Put(const std::string &key, const std::string &value) override;
 
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value, uint32_t ttl) override;
+
     // Implements Afina::Storage interface
     bool PutIfAbsent(const std::string &key, const std::string &value) override;
 
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) override;
+
     // Implements Afina::Storage interface
     bool Set(const std::string &key, const std::string &value) override;
 
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value, uint32_t ttl) override;
+
     // Implements Afina::Storage interface
     bool Delete(const std::string &key) override;
 
     // Implements Afina::Storage interface
     bool Get(const std::string &key, std::string &value) const override;
 
+    // Implements Afina::Storage interface
+    bool GetShared(const std::string &key, std::shared_ptr<const std::string> &value) const override;
+
+    // Implements Afina::Storage interface, small value is copied while large one is shared, so that
+    // caller could copy it out of the lock
+    bool Lookup(const std::string &key, std::string &value, std::shared_ptr<const std::string> &shared) const override;
+
+    // Implements Afina::Storage interface, index memory of the whole batch is prefetched at once
+    void MultiGet(Entry **entries, size_t count) const override;
+
+    // Implements Afina::Storage interface, slab storage can't be resized as the slab has fixed size
+    bool Resize(size_t max_size) override;
+
+    /**
+     * Sizes index for the given number of items up front, so that it doesn't grow until there are
+     * more of them. Index is rebuilt at once, so that is meant to be done before the storage is filled
+     */
+    void Reserve(size_t items);
+
+    /**
+     * Number of bytes an item with the given key and value sizes takes from the storage
+     * memory limit
+     */
+    static size_t ItemSize(size_t key_size, size_t value_size);
+
+protected:
+    /**
+     * Current time in seconds, item expires once it reaches the deadline of the item
+     */
+    virtual uint32_t Now() const;
+
+    /**
+     * Share of the memory limit that could be taken without eviction, in percent
+     */
+    size_t FreePercent() const {
+        return _actual_size >= _max_size ? 0 : (_max_size - _actual_size) * 100 / _max_size;
+    }
+
+    /**
+     * Reclaims expired items, then evicts at most count items the way writers do until free_percent
+     * of the memory limit is available. Returns true once there is nothing more to do.
+     *
+     * Unless items come from the slab or values from the arena, evicted items are only detached from
+     * the storage and chained to detached, Release() frees them later, e.g once lock is released.
+     *
+     * Slab chunks are reused within their size class only, so slab storage reclaims expired items only
+     */
+    bool Reclaim(size_t free_percent, size_t count, void *&detached);
+
+    /**
+     * Frees items detached by Reclaim(), doesn't touch the storage state
+     */
+    void Release(void *detached);
+
 private:
-  struct lru_node {
-    lru_node *_prev = nullptr;
-    std::unique_ptr<lru_node> _next;
+    using shared_value = std::shared_ptr<const std::string>;
+
+    // Number of bytes each allocation evicts on top of its own size while the storage shrinks
+    static constexpr size_t kShrinkStep = 16 * 1024;
+
+    // Timing wheel geometry, see class description
+    static constexpr size_t kWheelLevels = 4;
+    static constexpr size_t kWheelBits = 6;
+    static constexpr size_t kWheelSlots = 1 << kWheelBits;
+
+    struct lru_node {
+        // LRU list links
+        lru_node *_prev;
+        lru_node *_next;
+
+        // Next node in the same index bucket
+        lru_node *_hash_next;
+
+        uint32_t _hash;
+        uint16_t _key_size;
+
+        // LRU segment the node belongs to
+        uint8_t _segment;
+
+        // Set of kExpiring, etc
+        uint8_t _flags;
+        uint32_t _value_size;
+
+        // Number of bytes available for value in this block, could be greater than value size
+        // once value gets shrinked in place. Value is kept in the shared buffer if it is less
+        uint32_t _value_capacity;
+
+        // Key and value are placed in the same block right after the header
+        inline char *key() const { return reinterpret_cast<char *>(const_cast<lru_node *>(this + 1)); }
+        inline char *value() const { return key() + _key_size; }
+    };
+
+    struct lru_list {
+        lru_node *head = nullptr;
+        lru_node *tail = nullptr;
+    };
+
+    // Index bucket. Bucket array isn't filled on allocation, rehash sets each bucket right before items
+    // could get there, so that growing index doesn't touch all its memory at once
+    struct lru_bucket {
+        lru_bucket() {}
+        explicit lru_bucket(lru_node *node) : head(node) {}
+
+        lru_node *head;
+    };
+
+    // Segments of each LRU list, plain LRU keeps all items in probation, only W-TinyLFU uses window
+    enum Segment : uint8_t { kProbation = 0, kProtected = 1, kWindow = 2, kSegments = 3 };
+
+    // Node flags
+    enum Flag : uint8_t { kExpiring = 1 };
+
+    // Expiration record of the item stored with ttl
+    struct lru_expiry {
+        // Timing wheel slot links, pprev points to the slot or to the next field of the previous node
+        lru_node *next;
+        lru_node **pprev;
+
+        // Time the item expires at, zero if it doesn't. Record stays once ttl is reset
+        uint32_t deadline;
+    };
+
+    static uint32_t Hash(const std::string &key);
+
+    // Number of bytes the node takes from the memory limit
+    size_t BlockSize(const lru_node *node) const {
+        return ExpirySize(node) + ItemSize(node->_key_size, std::max(node->_value_size, node->_value_capacity));
+    }
+
+    // Expiration record is placed in the block right before the node
+    static bool Expiring(const lru_node *node) { return node->_flags & kExpiring; }
+    static size_t ExpirySize(const lru_node *node) { return Expiring(node) ? sizeof(lru_expiry) : 0; }
+    static lru_expiry *Expiry(const lru_node *node) {
+        return reinterpret_cast<lru_expiry *>(const_cast<lru_node *>(node)) - 1;
+    }
+    static uint32_t Deadline(const lru_node *node) { return Expiring(node) ? Expiry(node)->deadline : 0; }
+
+    // Deadline of the item stored now with the given ttl
+    uint32_t DeadlineOf(uint32_t ttl) const { return ttl == 0 ? 0 : Now() + ttl; }
+
+    // Expired item is still in the storage until the timing wheel gets to it, but it is never returned
+    bool Expired(const lru_node *node) const {
+        uint32_t deadline = Deadline(node);
+        return deadline != 0 && deadline <= Now();
+    }
+
+    // Value isn't in the block but in the shared buffer referenced from the block
+    static bool Shared(const lru_node *node) { return node->_value_size > node->_value_capacity; }
+
+    // Lists of the node segments, there is only one pair unless slab allocator is used
+    size_t ClassOf(size_t block_size) const { return _slab ? _slab->class_of(block_size) : 0; }
+    lru_list &ListOf(size_t size_class, uint16_t segment) const { return _lru[size_class * kSegments + segment]; }
+    lru_list &ListOf(const lru_node *node) const { return ListOf(ClassOf(BlockSize(node)), node->_segment); }
+
+    // Item to evict from the given size class, nullptr if the class is empty. W-TinyLFU moves window
+    // items to the main cache or picks one of them instead of the main cache victim
+    lru_node *Victim(size_t size_class);
+
+    // Least recent item of the main cache, i.e of probation and protected segments
+    lru_node *MainVictim(size_t size_class) const {
+        lru_node *node = ListOf(size_class, kProbation).tail;
+        return node ? node : ListOf(size_class, kProtected).tail;
+    }
+
+    // Records access of the key for admission filter
+    void Record(uint32_t hash) const {
+        if (_policy == Policy::TinyLFU) {
+            _sketch.Increment(hash);
+        }
+    }
+
+    // Value of the node, either inline or from the arena. Shared value is only read through SharedValue()
+    char *Value(const lru_node *node) const {
+        return _arena ? static_cast<char *>(ArenaValue(node).get()) : node->value();
+    }
+
+    // Handle of the arena value or shared value reference is stored after the key
+    template <typename T> static size_t HandleOffset(size_t key_size) {
+        return (sizeof(lru_node) + key_size + alignof(T) - 1) & ~(alignof(T) - 1);
+    }
+    template <typename T> static T &Handle(const lru_node *node) {
+        return *reinterpret_cast<T *>(reinterpret_cast<char *>(const_cast<lru_node *>(node)) +
+                                      HandleOffset<T>(node->_key_size));
+    }
+    static Allocator::Pointer &ArenaValue(const lru_node *node) { return Handle<Allocator::Pointer>(node); }
+    static shared_value &SharedValue(const lru_node *node) { return Handle<shared_value>(node); }
+
+    // Brings the limit writers evict items to meet a step closer to the memory limit
+    void Shrink() {
+        if (_limit > _max_size) {
+            std::size_t limit = std::min(_limit, _actual_size);
+            _limit = limit > _max_size + kShrinkStep ? limit - kShrinkStep : _max_size;
+        }
+    }
+
+    // Takes value block from the arena, evicts items and compacts arena if needed
+    Allocator::Pointer ArenaAlloc(size_t size);
+
+    // Creates new detached node for the given key/value pair, evicts other items to make a room.
+    // Returns nullptr if there is no way to get memory for the node
+    lru_node *AllocNode(const char *key, size_t key_size, uint32_t hash, const std::string &value,
+                        uint32_t deadline);
+    void FreeNode(lru_node *node);
+
+    // Copies value of the found node or shares it, node becomes the most recent one
+    void Read(lru_node *node, std::string &value, std::shared_ptr<const std::string> &shared) const;
+
+    // Index operations
+    lru_node *Find(const std::string &key, uint32_t hash) const;
+    void IndexInsert(lru_node *node);
+    void IndexRemove(lru_node *node);
+
+    // Bucket the hash belongs to, it is in the old array while rehash hasn't got to it yet
+    lru_node *const &Bucket(uint32_t hash) const {
+        std::size_t old_index = hash & (_old_buckets.size() - 1);
+        if (!_old_buckets.empty() && old_index >= _rehash_pos) {
+            return _old_buckets[old_index].head;
+        }
+        return _buckets[hash & (_buckets.size() - 1)].head;
+    }
+    lru_node *&Bucket(uint32_t hash) {
+        return const_cast<lru_node *&>(static_cast<const SimpleLRU *>(this)->Bucket(hash));
+    }
+
+    // Doubles number of buckets, keeps index as is if there is no memory for that. Items are moved
+    // to the new buckets by RehashStep() later
+    void Grow();
+
+    // Makes the given array the index one, all items are yet to be moved to it
+    void StartRehash(Allocator::Vector<lru_bucket> &buckets);
+
+    // Moves items of at most count old buckets to the new ones
+    void RehashStep(std::size_t count);
+
+    // LRU list operations
+    void Unlink(lru_list &list, lru_node *node) const;
+    void LinkHead(lru_list &list, lru_node *node) const;
+    void MoveToHead(lru_node *node) const;
+
+    // Moves probation node to the protected segment, demotes least recent protected nodes if it gets too big
+    void Promote(lru_node *node) const;
+
+    // Timing wheel operations, only items with deadline are in the wheel
+    void WheelInsert(lru_node *node);
+    void WheelLink(lru_node *node);
+    void WheelRemove(lru_node *node);
+
+    // Advances timing wheel to the current time, deletes items expired meanwhile
+    void Expire();
+
+    // Finds the key, deletes it if the item is expired
+    lru_node *FindLive(const std::string &key, uint32_t hash);
+
+    bool PutItem(const std::string &key, uint32_t hash, const std::string &value, uint32_t deadline);
+    bool SetItem(lru_node *node, const std::string &value, uint32_t deadline);
+    void DeleteItem(lru_node *node);
+
+    // Adds just allocated node to the index, lists and timing wheel
+    void LinkItem(lru_node *node);
+
+    // Removes node from the index, lists and timing wheel, node memory is still there
+    void DetachItem(lru_node *node);
+
+    // Same as above, but node stays in the index. Node couldn't be evicted until it is relinked
+    void UnlinkItem(lru_node *node);
+
+    // Puts node taken out by UnlinkItem back to the head of its list
+    void RelinkItem(lru_node *node);
+
+    // Maximum number of bytes could be stored in this cache.
+    // i.e all items (headers+keys+values) must be less the _max_size
+    std::size_t _max_size;
+
+    // Limit writers evict items to meet, greater than _max_size for a while once the storage shrinks
+    std::size_t _limit;
+
+    // Source of item blocks, global heap is used if none is set
+    std::unique_ptr<Allocator::Slab> _slab;
+    std::shared_ptr<Allocator::SmallAlloc> _small;
+
+    // Values region and its allocator, if set values aren't stored in item blocks
+    std::unique_ptr<char[]> _arena_region;
+    std::unique_ptr<Allocator::Simple> _arena;
+    std::size_t _arena_reserve = 0;
 
-    const std::string _key;
-    std::string _value;
+    // Actual number of bytes stored in this cache
+    // Always less than _limit
+    std::size_t _actual_size = 0;
 
-    lru_node(const std::string &key, const std::string &value) : _key (key), _value (value) {}
-  };
+    // Index memory comes from the items allocator if it is shared, default resource otherwise
+    std::unique_ptr<Allocator::MemoryResource> _index_resource;
 
-  // Maximum number of bytes could be stored in this cache.
-  // i.e all (keys+values) must be less the _max_size
-  std::size_t _max_size;
+    // Main data index for fast search, size is always power of two
+    Allocator::Vector<lru_bucket> _buckets;
+    std::size_t _items = 0;
 
-  // Actual number of bytes stored in this cache
-  // Always less than _max_size
-  std::size_t _actual_size = 0;
+    // Half as big index the items are moved from while index grows, empty otherwise. Buckets before
+    // _rehash_pos are moved already
+    Allocator::Vector<lru_bucket> _old_buckets;
+    std::size_t _rehash_pos = 0;
 
-  // Main data index for fast search
-  std::unordered_map<std::reference_wrapper<const std::string>,
-                     std::reference_wrapper<lru_node>,
-                     std::hash<std::string>,
-                     std::equal_to<const std::string>> _lru_index;
+    // Data storage, pair of segment lists per slab size class.
+    // New elements go to head
+    mutable std::vector<lru_list> _lru;
 
-  // Data storage.
-  // New elements go to head
-  mutable std::unique_ptr<lru_node> _lru_head;
-  mutable lru_node *_lru_tail = nullptr;
+    Policy _policy;
 
-  using iterator_class = std::unordered_map<std::reference_wrapper<const std::string>,
-      std::reference_wrapper<lru_node>,
-      std::hash<std::string>,
-      std::equal_to<const std::string>>::iterator;
+    // Number of bytes taken by the items of protected and window segments
+    mutable std::size_t _protected_size = 0;
+    std::size_t _window_size = 0;
 
-  bool PutItem(const std::string &key, const std::string &value);
-  bool SetItem(const std::string &key, const std::string &value,
-               iterator_class &item);
+    // Access frequency estimate of W-TinyLFU, sized after the index
+    mutable FrequencySketch _sketch;
 
-  bool DeleteItem(iterator_class &item);
+    // Timing wheel slots of each level, time it was advanced to and number of items in it
+    lru_node *_wheel[kWheelLevels][kWheelSlots] = {};
+    uint32_t _wheel_time = 0;
+    std::size_t _wheel_items = 0;
 };
 
 } // namespace Backend
@@ -0,0 +1,153 @@
+#include "StripedLRU.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+// See StripedLRU.h
+StripedLRU::StripedLRU(size_t stripe_count, size_t max_size, SimpleLRU::Policy policy)
+    : StripedLRU(stripe_count, max_size, nullptr, policy) {}
+
+// See StripedLRU.h
+StripedLRU::StripedLRU(size_t stripe_count, size_t max_size, std::shared_ptr<Allocator::SmallAlloc> items,
+                       SimpleLRU::Policy policy) {
+    if (stripe_count == 0) {
+        throw std::runtime_error("Number of stripes must be positive");
+    }
+
+    size_t stripe_size = max_size / stripe_count;
+    if (stripe_size == 0) {
+        throw std::runtime_error("Memory budget is too small for the given number of stripes");
+    }
+
+    _stripes.reserve(stripe_count);
+    for (size_t i = 0; i < stripe_count; i++) {
+        if (items) {
+            _stripes.emplace_back(new ThreadSafeSimpleLRU(stripe_size, items, policy));
+        } else {
+            _stripes.emplace_back(new ThreadSafeSimpleLRU(stripe_size, policy));
+        }
+    }
+}
+
+// See StripedLRU.h
+void StripedLRU::Reserve(size_t items) {
+    for (auto &stripe : _stripes) {
+        stripe->Reserve((items + _stripes.size() - 1) / _stripes.size());
+    }
+}
+
+// See StripedLRU.h
+void StripedLRU::SetWatermarks(size_t low, size_t high) {
+    _reclaim = high > 0;
+    for (auto &stripe : _stripes) {
+        stripe->SetWatermarks(low, high, _reclaim ? &_reclaimer : nullptr);
+    }
+}
+
+// See StripedLRU.h
+void StripedLRU::Start() {
+    if (_reclaim) {
+        std::vector<ThreadSafeSimpleLRU *> stripes;
+        for (auto &stripe : _stripes) {
+            stripes.push_back(stripe.get());
+        }
+        _reclaimer.Start(std::move(stripes));
+    }
+}
+
+// See StripedLRU.h
+void StripedLRU::Stop() { _reclaimer.Stop(); }
+
+// See Storage.h
+bool StripedLRU::Put(const std::string &key, const std::string &value) { return SelectStripe(key).Put(key, value); }
+
+// See Storage.h
+bool StripedLRU::Put(const std::string &key, const std::string &value, uint32_t ttl) {
+    return SelectStripe(key).Put(key, value, ttl);
+}
+
+// See Storage.h
+bool StripedLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+    return SelectStripe(key).PutIfAbsent(key, value);
+}
+
+// See Storage.h
+bool StripedLRU::PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) {
+    return SelectStripe(key).PutIfAbsent(key, value, ttl);
+}
+
+// See Storage.h
+bool StripedLRU::Set(const std::string &key, const std::string &value) { return SelectStripe(key).Set(key, value); }
+
+// See Storage.h
+bool StripedLRU::Set(const std::string &key, const std::string &value, uint32_t ttl) {
+    return SelectStripe(key).Set(key, value, ttl);
+}
+
+// See Storage.h
+bool StripedLRU::Delete(const std::string &key) { return SelectStripe(key).Delete(key); }
+
+// See Storage.h
+bool StripedLRU::Get(const std::string &key, std::string &value) const { return SelectStripe(key).Get(key, value); }
+
+// See Storage.h
+bool StripedLRU::GetShared(const std::string &key, std::shared_ptr<const std::string> &value) const {
+    return SelectStripe(key).GetShared(key, value);
+}
+
+// See Storage.h
+bool StripedLRU::Lookup(const std::string &key, std::string &value, std::shared_ptr<const std::string> &shared) const {
+    return SelectStripe(key).Lookup(key, value, shared);
+}
+
+// See Storage.h
+void StripedLRU::MultiGet(Entry **entries, size_t count) const {
+    // Counting sort of the entries by stripe, buffers are reused by all calls of the thread
+    static thread_local std::vector<size_t> stripe_of, offsets;
+    static thread_local std::vector<Entry *> grouped;
+    stripe_of.resize(count);
+    offsets.assign(_stripes.size() + 1, 0);
+    for (size_t i = 0; i < count; i++) {
+        stripe_of[i] = StripeOf(entries[i]->key);
+        offsets[stripe_of[i] + 1]++;
+    }
+    for (size_t s = 1; s < offsets.size(); s++) {
+        offsets[s] += offsets[s - 1];
+    }
+
+    grouped.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        grouped[offsets[stripe_of[i]]++] = entries[i];
+    }
+    std::copy(grouped.begin(), grouped.end(), entries);
+
+    // Offsets are moved to the end of groups now
+    size_t begin = 0;
+    for (size_t s = 0; s < _stripes.size(); s++) {
+        size_t end = offsets[s];
+        if (end > begin) {
+            _stripes[s]->MultiGet(entries + begin, end - begin);
+        }
+        begin = end;
+    }
+}
+
+// See Storage.h
+bool StripedLRU::Resize(size_t max_size) {
+    size_t stripe_size = max_size / _stripes.size();
+    if (stripe_size == 0) {
+        return false;
+    }
+
+    bool result = true;
+    for (auto &stripe : _stripes) {
+        result &= stripe->Resize(stripe_size);
+    }
+    return result;
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,114 @@
+#ifndef AFINA_STORAGE_STRIPED_LRU_H
+#define AFINA_STORAGE_STRIPED_LRU_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/Storage.h>
+
+#include "ThreadSafeSimpleLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Sharded SimpleLRU
+ * Keys are distributed between a number of independent ThreadSafeSimpleLRU
+ * instances (stripes) by hash. Each stripe has its own lock and owns equal
+ * slice of the memory budget, so operations on keys from different stripes
+ * never contend with each other.
+ *
+ * Note that LRU order is maintained per stripe, so the item evicted is the
+ * least recently used one in its stripe, not in the whole storage.
+ */
+class StripedLRU : public Afina::Storage {
+public:
+    /**
+     * @param stripe_count number of independent shards, must be positive
+     * @param max_size total memory budget, split equally between stripes
+     * @param policy eviction policy of each stripe
+     */
+    explicit StripedLRU(size_t stripe_count = 4, size_t max_size = 1024,
+                        SimpleLRU::Policy policy = SimpleLRU::Policy::LRU);
+
+    /**
+     * Same as above, items of all stripes are allocated from the given allocator
+     */
+    StripedLRU(size_t stripe_count, size_t max_size, std::shared_ptr<Allocator::SmallAlloc> items,
+               SimpleLRU::Policy policy = SimpleLRU::Policy::LRU);
+    ~StripedLRU() { Stop(); }
+
+    /**
+     * Sizes index of each stripe for its share of the given number of items, see SimpleLRU::Reserve
+     */
+    void Reserve(size_t items);
+
+    /**
+     * Makes background thread keep free memory of each stripe between the given shares of the stripe
+     * memory limit, see ThreadSafeSimpleLRU::SetWatermarks. Single thread serves all stripes
+     */
+    void SetWatermarks(size_t low, size_t high);
+
+    // Implements Afina::Storage interface, launches reclaim thread if watermarks are set
+    void Start() override;
+
+    // Implements Afina::Storage interface
+    void Stop() override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value, uint32_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) const override;
+
+    // Implements Afina::Storage interface
+    bool GetShared(const std::string &key, std::shared_ptr<const std::string> &value) const override;
+
+    // Implements Afina::Storage interface
+    bool Lookup(const std::string &key, std::string &value, std::shared_ptr<const std::string> &shared) const override;
+
+    // Implements Afina::Storage interface, entries are grouped by stripe and each stripe is locked once
+    void MultiGet(Entry **entries, size_t count) const override;
+
+    // Implements Afina::Storage interface, memory limit is split equally between stripes as before
+    bool Resize(size_t max_size) override;
+
+private:
+    // Returns stripe responsible for the given key
+    ThreadSafeSimpleLRU &SelectStripe(const std::string &key) const { return *_stripes[StripeOf(key)]; }
+    size_t StripeOf(const std::string &key) const { return _hash(key) % _stripes.size(); }
+
+    std::hash<std::string> _hash;
+
+    // Independent shards, each one is protected by its own mutex
+    std::vector<std::unique_ptr<ThreadSafeSimpleLRU>> _stripes;
+
+    // Background reclaim of all stripes, goes away before them
+    Reclaimer _reclaimer;
+    bool _reclaim = false;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_STRIPED_LRU_H
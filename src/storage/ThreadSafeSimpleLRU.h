@@ -1,10 +1,13 @@
 #ifndef AFINA_STORAGE_THREAD_SAFE_SIMPLE_LRU_H
 #define AFINA_STORAGE_THREAD_SAFE_SIMPLE_LRU_H
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 
+#include "Reclaimer.h"
 #include "SimpleLRU.h"
 
 namespace Afina {
@@ -12,29 +15,119 @@ namespace Backend {
 
 /**
  * # SimpleLRU thread safe version
+ * Lock is held only for the lookup of large values, they are copied or handed out as shared
+ * buffers once it is released
  *
- *
+ * Optionally eviction is done in background: once a write leaves less free memory than the low
+ * watermark, reclaim thread is woken up and evicts items until free memory gets to the high one.
+ * So under write bursts writers find room ready and don't evict while holding the lock.
  */
 class ThreadSafeSimpleLRU : public SimpleLRU {
 public:
-    explicit ThreadSafeSimpleLRU(size_t max_size = 1024) : SimpleLRU(max_size) {}
+    explicit ThreadSafeSimpleLRU(size_t max_size = 1024, Policy policy = Policy::LRU) : SimpleLRU(max_size, policy) {}
+
+    explicit ThreadSafeSimpleLRU(std::unique_ptr<Allocator::Slab> slab, Policy policy = Policy::LRU)
+        : SimpleLRU(std::move(slab), policy) {}
+
+    ThreadSafeSimpleLRU(size_t max_size, size_t arena_size, Policy policy = Policy::LRU)
+        : SimpleLRU(max_size, arena_size, policy) {}
+
+    ThreadSafeSimpleLRU(size_t max_size, std::shared_ptr<Allocator::SmallAlloc> items, Policy policy = Policy::LRU)
+        : SimpleLRU(max_size, std::move(items), policy) {}
+
+    ~ThreadSafeSimpleLRU() override { Stop(); }
+
+    /**
+     * Makes background thread keep free memory between the given shares of the memory limit, in
+     * percent. Thread is run either by the given reclaimer, which could serve several storages, or
+     * by the own one which Start() launches. Zero high watermark disables background reclaim.
+     * Must be called before the storage is used
+     */
+    void SetWatermarks(size_t low, size_t high, Reclaimer *reclaimer = nullptr) {
+        _low_watermark = low;
+        _high_watermark = high;
+        if (reclaimer != nullptr) {
+            _reclaimer = reclaimer;
+        } else if (high > 0) {
+            _own_reclaimer.reset(new Reclaimer());
+            _reclaimer = _own_reclaimer.get();
+        } else {
+            _reclaimer = nullptr;
+        }
+    }
+
+    // see SimpleLRU.h, reclaimer if any takes over eviction once the storage shrinks
+    bool Resize(size_t max_size) override {
+        return Write([&] { return SimpleLRU::Resize(max_size); });
+    }
 
     // see SimpleLRU.h
-    bool Put(const std::string &key, const std::string &value) override {
+    void Reserve(size_t items) {
         std::lock_guard<std::mutex> lock (_mutex);
-        return SimpleLRU::Put(key, value);
+        SimpleLRU::Reserve(items);
+    }
+
+    // Implements Afina::Storage interface, launches own reclaimer if any
+    void Start() override {
+        if (_own_reclaimer) {
+            _own_reclaimer->Start({this});
+        }
+    }
+
+    // Implements Afina::Storage interface
+    void Stop() override {
+        if (_own_reclaimer) {
+            _own_reclaimer->Stop();
+        }
+    }
+
+    /**
+     * Runs one batch of background reclaim, returns true if there is more to do. Lock is held for
+     * the batch only, so writers get in between batches, and evicted items are freed once it is released
+     */
+    bool Reclaim() {
+        void *detached = nullptr;
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock (_mutex);
+            done = SimpleLRU::Reclaim(_high_watermark, kReclaimBatch, detached);
+            if (done) {
+                _reclaim_pending.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        SimpleLRU::Release(detached);
+        return !done;
+    }
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, const std::string &value) override {
+        return Write([&] { return SimpleLRU::Put(key, value); });
+    }
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, const std::string &value, uint32_t ttl) override {
+        return Write([&] { return SimpleLRU::Put(key, value, ttl); });
     }
 
     // see SimpleLRU.h
     bool PutIfAbsent(const std::string &key, const std::string &value) override {
-        std::lock_guard<std::mutex> lock (_mutex);
-        return SimpleLRU::PutIfAbsent(key, value);
+        return Write([&] { return SimpleLRU::PutIfAbsent(key, value); });
+    }
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value, uint32_t ttl) override {
+        return Write([&] { return SimpleLRU::PutIfAbsent(key, value, ttl); });
     }
 
     // see SimpleLRU.h
     bool Set(const std::string &key, const std::string &value) override {
-        std::lock_guard<std::mutex> lock (_mutex);
-        return SimpleLRU::Set(key, value);
+        return Write([&] { return SimpleLRU::Set(key, value); });
+    }
+
+    // see SimpleLRU.h
+    bool Set(const std::string &key, const std::string &value, uint32_t ttl) override {
+        return Write([&] { return SimpleLRU::Set(key, value, ttl); });
     }
 
     // see SimpleLRU.h
@@ -45,12 +138,76 @@ public:
 
     // see SimpleLRU.h
     bool Get(const std::string &key, std::string &value) const override {
+        std::shared_ptr<const std::string> shared;
+        {
+            std::lock_guard<std::mutex> lock (_mutex);
+            if (!SimpleLRU::Lookup(key, value, shared)) {
+                return false;
+            }
+        }
+
+        if (shared) {
+            value.assign(*shared);
+        }
+        return true;
+    }
+
+    // see SimpleLRU.h
+    bool GetShared(const std::string &key, std::shared_ptr<const std::string> &value) const override {
+        std::string copy;
+        std::shared_ptr<const std::string> shared;
+        {
+            std::lock_guard<std::mutex> lock (_mutex);
+            if (!SimpleLRU::Lookup(key, copy, shared)) {
+                return false;
+            }
+        }
+
+        value = shared ? std::move(shared) : std::make_shared<const std::string>(std::move(copy));
+        return true;
+    }
+
+    // see SimpleLRU.h
+    bool Lookup(const std::string &key, std::string &value, std::shared_ptr<const std::string> &shared) const override {
+        std::lock_guard<std::mutex> lock (_mutex);
+        return SimpleLRU::Lookup(key, value, shared);
+    }
+
+    // see SimpleLRU.h, lock is taken once for all keys
+    void MultiGet(Entry **entries, size_t count) const override {
         std::lock_guard<std::mutex> lock (_mutex);
-        return SimpleLRU::Get(key, value);
+        SimpleLRU::MultiGet(entries, count);
     }
 
 private:
+    // Maximum number of items evicted by the background thread at once
+    static constexpr size_t kReclaimBatch = 32;
+
+    // Runs modification under the lock, wakes reclaimer up if free memory gets low
+    template <typename F> bool Write(F write) {
+        bool result, low;
+        {
+            std::lock_guard<std::mutex> lock (_mutex);
+            result = write();
+            low = _reclaimer != nullptr && FreePercent() < _low_watermark;
+        }
+
+        if (low && !_reclaim_pending.exchange(true, std::memory_order_relaxed)) {
+            _reclaimer->Wake();
+        }
+        return result;
+    }
+
     mutable std::mutex _mutex;
+
+    // Background reclaim keeps free memory between watermarks, in percent of the memory limit
+    size_t _low_watermark = 0;
+    size_t _high_watermark = 0;
+    Reclaimer *_reclaimer = nullptr;
+    std::unique_ptr<Reclaimer> _own_reclaimer;
+
+    // Reclaimer is woken up and hasn't reached the high watermark yet
+    std::atomic<bool> _reclaim_pending{false};
 };
 
 } // namespace Backend
@@ -0,0 +1,230 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/MemPool.h>
+#include <afina/allocator/SlabCache.h>
+#include <afina/allocator/SmallAlloc.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+TEST(ArenaTest, MapUnmap) {
+    EXPECT_THROW(Arena(1024, 64 * 1024), std::runtime_error);
+    EXPECT_THROW(Arena(1024 * 1024, 3 * 4096), std::runtime_error);
+
+    Arena arena(4 * 64 * 1024, 64 * 1024);
+    set<void *> slabs;
+    void *p;
+    while ((p = arena.map()) != nullptr) {
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % arena.slab_size());
+        EXPECT_EQ(p, arena.slab_of(static_cast<char *>(p) + 100));
+        EXPECT_TRUE(arena.contains(p));
+        EXPECT_TRUE(slabs.insert(p).second);
+    }
+    EXPECT_EQ(4, slabs.size());
+
+    arena.unmap(*slabs.begin());
+    EXPECT_EQ(*slabs.begin(), arena.map());
+}
+
+TEST(ArenaTest, SlabCacheKeepsFew) {
+    Arena arena(4 * 64 * 1024, 64 * 1024);
+    {
+        SlabCache cache(arena, 1);
+        void *a = cache.get();
+        void *b = cache.get();
+        cache.put(a);
+        cache.put(b);
+
+        // b went back to the arena
+        EXPECT_EQ(b, arena.map());
+        arena.unmap(b);
+        EXPECT_EQ(a, cache.get());
+        cache.put(a);
+    }
+
+    // Cache returns everything on destruction
+    int count = 0;
+    while (arena.map() != nullptr) {
+        count++;
+    }
+    EXPECT_EQ(4, count);
+}
+
+TEST(MemPoolTest, AllocFree) {
+    Arena arena(16 * 64 * 1024, 64 * 1024);
+    MemPool pool(arena, 100);
+    EXPECT_GE(pool.object_size(), 100);
+
+    // Take everything arena has
+    set<char *> objects;
+    char *p;
+    while ((p = static_cast<char *>(pool.alloc())) != nullptr) {
+        memset(p, objects.size() % 251, 100);
+        EXPECT_TRUE(objects.insert(p).second);
+        EXPECT_TRUE(arena.contains(p));
+    }
+    EXPECT_GT(objects.size(), 15 * 64 * 1024 / pool.object_size());
+
+    for (char *p : objects) {
+        pool.free(p);
+    }
+
+    // All memory is available again
+    for (size_t i = 0; i < objects.size(); i++) {
+        ASSERT_NE(nullptr, pool.alloc());
+    }
+}
+
+TEST(MemPoolTest, CrossThreadFree) {
+    Arena arena(256 * 64 * 1024, 64 * 1024);
+    MemPool pool(arena, 64);
+
+    const int count = 100000;
+    vector<void *> objects;
+    for (int i = 0; i < count; i++) {
+        void *p = pool.alloc();
+        ASSERT_NE(nullptr, p);
+        objects.push_back(p);
+    }
+
+    // Everything is freed by another thread, memory goes back to the allocating one
+    thread([&pool, &objects]() {
+        for (void *p : objects) {
+            pool.free(p);
+        }
+    }).join();
+
+    for (int i = 0; i < count; i++) {
+        ASSERT_NE(nullptr, pool.alloc());
+    }
+}
+
+TEST(MemPoolTest, ProducerConsumer) {
+    Arena arena(64 * 64 * 1024, 64 * 1024);
+    MemPool pool(arena, sizeof(uint64_t));
+
+    // Objects allocated by one thread are freed by another one, pool must not grow unbounded
+    const int rounds = 200, batch = 1000;
+    std::atomic<int> failures(0);
+    for (int r = 0; r < rounds; r++) {
+        vector<uint64_t *> objects;
+        for (int i = 0; i < batch; i++) {
+            uint64_t *p = static_cast<uint64_t *>(pool.alloc());
+            if (p == nullptr) {
+                failures++;
+                break;
+            }
+            *p = r * batch + i;
+            objects.push_back(p);
+        }
+
+        thread([&pool, &objects, &failures, r]() {
+            for (size_t i = 0; i < objects.size(); i++) {
+                if (*objects[i] != r * batch + i) {
+                    failures++;
+                }
+                pool.free(objects[i]);
+            }
+        }).join();
+    }
+    EXPECT_EQ(0, failures.load());
+}
+
+TEST(MemPoolTest, ThreadStateHandover) {
+    Arena arena(4 * 64 * 1024, 64 * 1024);
+    MemPool pool(arena, 1024);
+
+    // Each thread allocates a lot and exits, next one gets its state back
+    std::atomic<int> failures(0);
+    void *survivor = nullptr;
+    for (int t = 0; t < 16; t++) {
+        thread([&pool, &failures, &survivor, t]() {
+            vector<void *> objects;
+            for (int i = 0; i < 100; i++) {
+                void *p = pool.alloc();
+                if (p == nullptr) {
+                    failures++;
+                    return;
+                }
+                objects.push_back(p);
+            }
+            for (size_t i = 1; i < objects.size(); i++) {
+                pool.free(objects[i]);
+            }
+            pool.free(survivor);
+            survivor = objects[0];
+        }).join();
+    }
+    pool.free(survivor);
+    EXPECT_EQ(0, failures.load());
+}
+
+TEST(MemPoolTest, Concurrent) {
+    Arena arena(256 * 64 * 1024, 64 * 1024);
+    MemPool pool(arena, 48);
+
+    const int threads_count = 4, ops = 100000;
+    std::atomic<int> failures(0);
+    std::atomic<void *> exchange[64];
+    for (auto &e : exchange) {
+        e.store(nullptr);
+    }
+
+    // Threads keep a few own objects and swap others through shared slots, so that
+    // many objects are freed by non owner thread
+    vector<thread> threads;
+    for (int t = 0; t < threads_count; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < ops; i++) {
+                uint64_t *p = static_cast<uint64_t *>(pool.alloc());
+                if (p == nullptr) {
+                    failures++;
+                    return;
+                }
+                *p = t;
+
+                void *old = exchange[(i * 7 + t) % 64].exchange(p);
+                if (old != nullptr) {
+                    if (*static_cast<uint64_t *>(old) >= threads_count) {
+                        failures++;
+                    }
+                    pool.free(old);
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (auto &e : exchange) {
+        pool.free(e.load());
+    }
+    EXPECT_EQ(0, failures.load());
+}
+
+TEST(SmallAllocTest, SizeClasses) {
+    SmallAlloc a(64 * 64 * 1024, 64 * 1024);
+
+    vector<pair<char *, size_t>> ptrs;
+    for (size_t size = 1; size < 100000; size = size * 3 / 2 + 1) {
+        char *p = static_cast<char *>(a.alloc(size));
+        ASSERT_NE(nullptr, p);
+        memset(p, size % 251, size);
+        ptrs.emplace_back(p, size);
+    }
+    EXPECT_LT(a.max_size(), 64 * 1024);
+
+    for (auto &p : ptrs) {
+        for (size_t i = 0; i < p.second; i++) {
+            ASSERT_EQ(char(p.second % 251), p.first[i]);
+        }
+        a.free(p.first, p.second);
+    }
+}
@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <cstring>
+#include <set>
+
+#include <afina/allocator/Region.h>
+#include <afina/allocator/StlAllocator.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+TEST(RegionTest, BumpAndReset) {
+    Region region(1024);
+
+    char *a = static_cast<char *>(region.allocate(100));
+    char *b = static_cast<char *>(region.allocate(100));
+    EXPECT_GE(b, a + 100);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(b) % alignof(std::max_align_t));
+
+    // Large request gets its own chunk
+    char *large = static_cast<char *>(region.allocate(10000));
+    memset(large, 1, 10000);
+    size_t capacity = region.capacity();
+
+    // Memory is reused after reset, nothing new is taken from the heap
+    for (int round = 0; round < 10; round++) {
+        region.reset();
+        EXPECT_EQ(a, region.allocate(100));
+        region.allocate(100);
+        region.allocate(10000);
+    }
+    EXPECT_EQ(capacity, region.capacity());
+}
+
+TEST(RegionTest, LastBlockReturns) {
+    Region region(1024);
+
+    void *a = region.allocate(64);
+    void *b = region.allocate(64);
+    region.deallocate(a, 64);
+    EXPECT_NE(a, region.allocate(64));
+
+    void *c = region.allocate(64);
+    region.deallocate(c, 64);
+    EXPECT_EQ(c, region.allocate(64));
+    EXPECT_NE(b, c);
+}
+
+TEST(RegionTest, Containers) {
+    Region region(256);
+    for (int round = 0; round < 100; round++) {
+        {
+            Vector<String> v(&region);
+            for (int i = 0; i < 50; i++) {
+                v.emplace_back(String(40, 'a' + i % 26, &region));
+            }
+            for (int i = 0; i < 50; i++) {
+                ASSERT_EQ(String(40, 'a' + i % 26, &region), v[i]);
+            }
+        }
+        region.reset();
+    }
+}
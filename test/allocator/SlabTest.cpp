@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include <afina/allocator/Slab.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+TEST(SlabTest, InvalidConfig) {
+    EXPECT_THROW(Slab(1024, 4096), std::runtime_error);
+    EXPECT_THROW(Slab(4096, 4096, 1.0), std::runtime_error);
+}
+
+TEST(SlabTest, GeometricClasses) {
+    Slab a(1024 * 1024, 4096, 1.25, 48);
+
+    EXPECT_EQ(48, a.chunk_size(0));
+    EXPECT_EQ(4096, a.chunk_size(a.classes() - 1));
+    for (size_t i = 1; i < a.classes(); i++) {
+        EXPECT_GT(a.chunk_size(i), a.chunk_size(i - 1));
+        EXPECT_EQ(0, a.chunk_size(i) % 8);
+    }
+
+    EXPECT_EQ(0, a.class_of(1));
+    EXPECT_EQ(0, a.class_of(48));
+    EXPECT_EQ(1, a.class_of(49));
+    EXPECT_EQ(a.classes(), a.class_of(4097));
+    for (size_t n = 1; n <= 4096; n += 7) {
+        EXPECT_GE(a.chunk_size(a.class_of(n)), n);
+    }
+}
+
+TEST(SlabTest, AllocReadWrite) {
+    Slab a(64 * 4096, 4096);
+
+    vector<pair<char *, size_t>> ptrs;
+    for (size_t size = 1; size < 4096; size += 97) {
+        char *p = static_cast<char *>(a.alloc(size));
+        ASSERT_NE(nullptr, p);
+        memset(p, size % 251, size);
+        ptrs.emplace_back(p, size);
+    }
+
+    for (auto &p : ptrs) {
+        for (size_t i = 0; i < p.second; i++) {
+            ASSERT_EQ(char(p.second % 251), p.first[i]);
+        }
+        a.free(p.first, p.second);
+    }
+
+    EXPECT_EQ(nullptr, a.alloc(4097));
+}
+
+TEST(SlabTest, ClassRunsOut) {
+    Slab a(2 * 4096, 4096, 2.0, 64);
+
+    // The first page goes to the 1024 bytes class
+    EXPECT_NE(nullptr, a.alloc(1000));
+
+    // The other one is split into 64 bytes chunks
+    set<void *> chunks;
+    void *p;
+    while ((p = a.alloc(64)) != nullptr) {
+        EXPECT_TRUE(chunks.insert(p).second);
+    }
+    EXPECT_EQ(4096 / 64, chunks.size());
+    EXPECT_EQ(nullptr, a.alloc(2000));
+
+    // Freed chunk is reused by the same class
+    void *freed = *chunks.begin();
+    a.free(freed, 64);
+    EXPECT_EQ(freed, a.alloc(60));
+    EXPECT_EQ(nullptr, a.alloc(64));
+}
@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+#include <list>
+#include <map>
+#include <new>
+#include <string>
+
+#include <afina/allocator/MemoryResource.h>
+#include <afina/allocator/Slab.h>
+#include <afina/allocator/SmallAlloc.h>
+#include <afina/allocator/StlAllocator.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+namespace {
+
+// Counts requests and passes them to the heap
+class CountingResource : public MemoryResource {
+public:
+    size_t allocated = 0;
+    size_t deallocated = 0;
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        allocated++;
+        return new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+        deallocated++;
+        new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+};
+
+} // namespace
+
+TEST(StlAllocatorTest, Containers) {
+    CountingResource resource;
+    {
+        Vector<int> v(&resource);
+        for (int i = 0; i < 1000; i++) {
+            v.push_back(i);
+        }
+
+        String s("long enough string to leave small buffer", &resource);
+        s.append(s);
+
+        std::map<int, String, std::less<int>, StlAllocator<std::pair<const int, String>>> m(&resource);
+        m.emplace(1, s);
+        EXPECT_EQ(s, m.at(1));
+
+        // Copy keeps the resource
+        Vector<int> copy(v);
+        EXPECT_EQ(&resource, copy.get_allocator().resource());
+        EXPECT_EQ(v, copy);
+    }
+    EXPECT_GT(resource.allocated, 0);
+    EXPECT_EQ(resource.allocated, resource.deallocated);
+}
+
+TEST(StlAllocatorTest, DefaultResource) {
+    CountingResource resource;
+    EXPECT_EQ(new_delete_resource(), set_default_resource(&resource));
+    {
+        Vector<int> v(100, 1);
+    }
+    EXPECT_EQ(&resource, set_default_resource(nullptr));
+    EXPECT_EQ(new_delete_resource(), get_default_resource());
+    EXPECT_EQ(1, resource.allocated);
+}
+
+TEST(StlAllocatorTest, SlabResource) {
+    Slab slab(4 * 4096, 4096);
+    SlabResource resource(slab), other(slab);
+    EXPECT_TRUE(resource.is_equal(other));
+
+    std::list<int, StlAllocator<int>> l(&resource);
+    for (int i = 0; i < 100; i++) {
+        l.push_back(i);
+    }
+    l.clear();
+
+    // Larger than a slab page
+    Vector<char> v(&resource);
+    EXPECT_THROW(v.resize(8192), std::bad_alloc);
+}
+
+TEST(StlAllocatorTest, SmallAllocResource) {
+    SmallAlloc small(16 * 64 * 1024);
+    SmallAllocResource resource(small);
+    EXPECT_FALSE(resource.is_equal(*new_delete_resource()));
+
+    Vector<String> v(&resource);
+    for (int i = 0; i < 1000; i++) {
+        v.emplace_back(std::string(i % 100, 'a').c_str(), &resource);
+    }
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(i % 100, v[i].size());
+    }
+}
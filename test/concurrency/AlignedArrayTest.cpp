@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <stdexcept>
+
+#include <afina/concurrency/AlignedArray.h>
+
+using namespace std;
+using namespace Afina::Concurrency;
+
+namespace {
+
+struct alignas(64) Counted {
+    static int alive;
+    static int fail_at;
+
+    Counted() {
+        if (alive == fail_at) {
+            throw std::runtime_error("constructor failed");
+        }
+        alive++;
+    }
+    ~Counted() { alive--; }
+
+    int value = 0;
+};
+
+int Counted::alive = 0;
+int Counted::fail_at = -1;
+
+} // namespace
+
+TEST(AlignedArrayTest, ElementsAreAligned) {
+    {
+        AlignedArray<Counted> array(7);
+        EXPECT_EQ(7, array.size());
+        EXPECT_EQ(7, Counted::alive);
+        for (size_t i = 0; i < array.size(); i++) {
+            EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&array[i]) % 64);
+            array[i].value = i;
+        }
+        EXPECT_EQ(6, array[6].value);
+    }
+    EXPECT_EQ(0, Counted::alive);
+}
+
+TEST(AlignedArrayTest, FailedConstructionDestroysElements) {
+    Counted::fail_at = 3;
+    EXPECT_THROW(AlignedArray<Counted>(5), std::runtime_error);
+    Counted::fail_at = -1;
+    EXPECT_EQ(0, Counted::alive);
+}
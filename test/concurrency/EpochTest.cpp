@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/Epoch.h>
+
+using namespace std;
+using namespace Afina::Concurrency;
+
+namespace {
+
+std::atomic<int> freed(0);
+
+void Free(void *node) {
+    delete static_cast<int *>(node);
+    freed++;
+}
+
+// Collects until the given number of nodes is freed, which takes a few epochs
+bool WaitFreed(int count) {
+    for (int i = 0; i < 100 && freed.load() < count; i++) {
+        Epoch::Collect();
+    }
+    return freed.load() == count;
+}
+
+} // namespace
+
+TEST(EpochTest, FreesOutsideGuards) {
+    freed = 0;
+    for (int i = 0; i < 10; i++) {
+        Epoch::Retire(new int(i), &Free);
+    }
+    EXPECT_TRUE(WaitFreed(10));
+}
+
+TEST(EpochTest, GuardDelaysFree) {
+    freed = 0;
+    std::atomic<bool> entered(false), leave(false);
+    std::thread reader([&]() {
+        Epoch::Guard guard;
+        entered = true;
+        while (!leave) {
+            std::this_thread::yield();
+        }
+    });
+    while (!entered) {
+        std::this_thread::yield();
+    }
+
+    // Reader could have seen the node, so it stays until the reader leaves the guard
+    Epoch::Retire(new int(1), &Free);
+    for (int i = 0; i < 10; i++) {
+        Epoch::Collect();
+    }
+    EXPECT_EQ(0, freed.load());
+
+    leave = true;
+    reader.join();
+    EXPECT_TRUE(WaitFreed(1));
+}
+
+TEST(EpochTest, NestedGuards) {
+    freed = 0;
+    {
+        Epoch::Guard outer;
+        {
+            Epoch::Guard inner;
+        }
+        // Still inside the outer guard, own retired node could be in use
+        Epoch::Retire(new int(1), &Free);
+        for (int i = 0; i < 10; i++) {
+            Epoch::Collect();
+        }
+        EXPECT_EQ(0, freed.load());
+    }
+    EXPECT_TRUE(WaitFreed(1));
+}
+
+TEST(EpochTest, FreesNodesOfExitedThread) {
+    freed = 0;
+    std::atomic<bool> entered(false), leave(false);
+    std::thread reader([&]() {
+        Epoch::Guard guard;
+        entered = true;
+        while (!leave) {
+            std::this_thread::yield();
+        }
+    });
+    while (!entered) {
+        std::this_thread::yield();
+    }
+
+    // Node isn't safe to free when its thread exits, so whoever moves the epoch forward frees it
+    std::thread writer([]() { Epoch::Retire(new int(1), &Free); });
+    writer.join();
+    EXPECT_EQ(0, freed.load());
+
+    leave = true;
+    reader.join();
+    EXPECT_TRUE(WaitFreed(1));
+}
+
+TEST(EpochTest, PassesContext) {
+    std::atomic<int> count(0);
+    Epoch::Retire(new int(1),
+                  [](void *node, void *context) {
+                      delete static_cast<int *>(node);
+                      (*static_cast<std::atomic<int> *>(context))++;
+                  },
+                  &count);
+    for (int i = 0; i < 100 && count.load() == 0; i++) {
+        Epoch::Collect();
+    }
+    EXPECT_EQ(1, count.load());
+}
+
+TEST(EpochTest, ConcurrentReaders) {
+    const int threads_count = 4;
+    const int nodes_count = 10000;
+
+    // Writer keeps replacing the shared node, readers check it is never freed under them
+    std::atomic<int *> shared(new int(0));
+    std::atomic<bool> done(false);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < threads_count; t++) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                Epoch::Guard guard;
+                int *node = shared.load(std::memory_order_acquire);
+                if (*node < 0) {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    freed = 0;
+    for (int i = 1; i <= nodes_count; i++) {
+        int *old = shared.exchange(new int(i), std::memory_order_acq_rel);
+        Epoch::Retire(old, [](void *node) {
+            *static_cast<int *>(node) = -1;
+            Free(node);
+        });
+    }
+    done = true;
+    for (auto &t : readers) {
+        t.join();
+    }
+
+    EXPECT_EQ(0, failures.load());
+    EXPECT_TRUE(WaitFreed(nodes_count));
+    delete shared.load();
+}
@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/MPSCQueue.h>
+
+using namespace std;
+using namespace Afina::Concurrency;
+
+namespace {
+
+struct Item {
+    size_t producer;
+    size_t seq;
+    Item *next;
+};
+
+using Queue = MPSCQueue<Item, &Item::next>;
+
+} // namespace
+
+TEST(MPSCQueueTest, PushOrder) {
+    Queue queue;
+    EXPECT_TRUE(queue.Empty());
+    EXPECT_EQ(nullptr, queue.PopAll());
+
+    vector<Item> items(5);
+    for (size_t i = 0; i < items.size(); i++) {
+        items[i].seq = i;
+        queue.Push(&items[i]);
+    }
+    EXPECT_FALSE(queue.Empty());
+
+    size_t expected = 0;
+    for (Item *p = queue.PopAll(); p != nullptr; p = p->next) {
+        EXPECT_EQ(expected++, p->seq);
+    }
+    EXPECT_EQ(items.size(), expected);
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(MPSCQueueTest, ConcurrentProducers) {
+    const size_t producers = 4, per_producer = 100000;
+    vector<vector<Item>> items(producers, vector<Item>(per_producer));
+
+    Queue queue;
+    atomic<size_t> done(0);
+    vector<thread> threads;
+    for (size_t t = 0; t < producers; t++) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < per_producer; i++) {
+                items[t][i].producer = t;
+                items[t][i].seq = i;
+                queue.Push(&items[t][i]);
+            }
+            done++;
+        });
+    }
+
+    // Items of each producer come in the order they were pushed, none is lost
+    vector<size_t> next_seq(producers, 0);
+    size_t received = 0;
+    while (received < producers * per_producer) {
+        bool finished = done.load() == producers;
+        for (Item *p = queue.PopAll(); p != nullptr; p = p->next) {
+            ASSERT_EQ(next_seq[p->producer]++, p->seq);
+            received++;
+        }
+        if (finished) {
+            break;
+        }
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(producers * per_producer, received);
+}
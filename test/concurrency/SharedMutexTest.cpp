@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/SharedMutex.h>
+
+using namespace std;
+using namespace Afina::Concurrency;
+
+TEST(ShardedSharedMutexTest, ReadersDontBlockEachOther) {
+    ShardedSharedMutex mutex(4);
+    EXPECT_EQ(4, mutex.slots());
+
+    SharedLock<ShardedSharedMutex> lock(mutex);
+    std::atomic<bool> locked(false);
+    std::thread reader([&]() {
+        SharedLock<ShardedSharedMutex> other(mutex);
+        locked = true;
+    });
+    reader.join();
+    EXPECT_TRUE(locked.load());
+    EXPECT_FALSE(mutex.try_lock());
+}
+
+TEST(ShardedSharedMutexTest, WriterExcludesAllReaders) {
+    const int threads_count = 8;
+    ShardedSharedMutex mutex(4);
+
+    // Writer keeps both halves equal, readers of any slot must never see them differ
+    uint64_t a = 0, b = 0;
+    std::atomic<bool> done(false);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < threads_count; t++) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                SharedLock<ShardedSharedMutex> lock(mutex);
+                if (a != b) {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 10000; i++) {
+        std::lock_guard<ShardedSharedMutex> lock(mutex);
+        a++;
+        b++;
+    }
+    done = true;
+    for (auto &t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(0, failures.load());
+}
@@ -0,0 +1,93 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <ctime>
+#include <string>
+
+#include <afina/Storage.h>
+#include <afina/execute/Add.h>
+#include <afina/execute/Append.h>
+#include <afina/execute/Replace.h>
+#include <afina/execute/Set.h>
+
+using namespace std;
+using namespace Afina;
+using namespace Afina::Execute;
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Return;
+using ::testing::SetArgReferee;
+
+namespace {
+
+class MockStorage : public Storage {
+public:
+    MOCK_METHOD2(Put, bool(const string &, const string &));
+    MOCK_METHOD3(Put, bool(const string &, const string &, uint32_t));
+    MOCK_METHOD2(PutIfAbsent, bool(const string &, const string &));
+    MOCK_METHOD3(PutIfAbsent, bool(const string &, const string &, uint32_t));
+    MOCK_METHOD2(Set, bool(const string &, const string &));
+    MOCK_METHOD3(Set, bool(const string &, const string &, uint32_t));
+    MOCK_METHOD1(Delete, bool(const string &));
+    MOCK_CONST_METHOD2(Get, bool(const string &, string &));
+};
+
+} // namespace
+
+TEST(InsertCommandTest, RelativeExpire) {
+    MockStorage storage;
+    string out;
+    EXPECT_CALL(storage, Put("k", "v", 60)).WillOnce(Return(true));
+    Execute::Set("k", 0, 60).Execute(storage, "v", out);
+    EXPECT_EQ("STORED", out);
+
+    EXPECT_CALL(storage, PutIfAbsent("k", "v", 0)).WillOnce(Return(false));
+    Add("k", 0, 0).Execute(storage, "v", out);
+    EXPECT_EQ("NOT_STORED", out);
+
+    EXPECT_CALL(storage, Set("k", "v", 30)).WillOnce(Return(true));
+    Replace("k", 0, 30).Execute(storage, "v", out);
+    EXPECT_EQ("STORED", out);
+}
+
+TEST(InsertCommandTest, AbsoluteExpire) {
+    MockStorage storage;
+    string out;
+    int32_t now = time(nullptr);
+
+    // Expire time is a moment an hour later, but the second could change meanwhile
+    EXPECT_CALL(storage, Put("k", "v", ::testing::AllOf(::testing::Ge(3599u), ::testing::Le(3600u))))
+        .WillOnce(Return(true));
+    Execute::Set("k", 0, now + 3600).Execute(storage, "v", out);
+    EXPECT_EQ("STORED", out);
+
+    EXPECT_CALL(storage, Delete("k")).WillOnce(Return(true));
+    Execute::Set("k", 0, now - 3600).Execute(storage, "v", out);
+    EXPECT_EQ("STORED", out);
+}
+
+TEST(InsertCommandTest, ExpiredAtOnce) {
+    MockStorage storage;
+    string out;
+
+    // Nothing gets stored, but set still replaces the old value
+    EXPECT_CALL(storage, Delete("k")).WillOnce(Return(false));
+    Execute::Set("k", 0, -1).Execute(storage, "v", out);
+    EXPECT_EQ("STORED", out);
+
+    EXPECT_CALL(storage, Get("k", _)).WillOnce(Return(false));
+    Add("k", 0, -1).Execute(storage, "v", out);
+    EXPECT_EQ("STORED", out);
+
+    EXPECT_CALL(storage, Delete("k")).WillOnce(Return(false));
+    Replace("k", 0, -1).Execute(storage, "v", out);
+    EXPECT_EQ("NOT_STORED", out);
+}
+
+TEST(InsertCommandTest, AppendKeepsExpiration) {
+    MockStorage storage;
+    string out;
+    EXPECT_CALL(storage, Get("k", _)).WillOnce(DoAll(SetArgReferee<1>(string("a")), Return(true)));
+    EXPECT_CALL(storage, Set("k", "ab")).WillOnce(Return(true));
+    Append("k", 0, 60).Execute(storage, "b", out);
+    EXPECT_EQ("STORED", out);
+}
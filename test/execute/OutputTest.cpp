@@ -0,0 +1,144 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+
+#include <afina/Storage.h>
+#include <afina/execute/Get.h>
+#include <afina/execute/Output.h>
+
+using namespace std;
+using namespace Afina;
+using namespace Afina::Execute;
+
+namespace {
+
+// Collects everything pending, passing at most count pieces at once
+string Drain(Output &out, size_t count, size_t step) {
+    string result;
+    struct iovec iov[16];
+    while (!out.empty()) {
+        size_t filled = out.Prepare(iov, count);
+        EXPECT_GT(filled, 0);
+
+        size_t taken = 0;
+        for (size_t i = 0; i < filled && taken < step; i++) {
+            size_t n = min(iov[i].iov_len, step - taken);
+            result.append(static_cast<char *>(iov[i].iov_base), n);
+            taken += n;
+        }
+        out.Consume(taken);
+    }
+    return result;
+}
+
+// Storage holding the single value
+class OneValue : public Storage {
+public:
+    explicit OneValue(const string &value) : value(make_shared<const string>(value)) {}
+
+    bool Put(const string &, const string &) override { return false; }
+    bool PutIfAbsent(const string &, const string &) override { return false; }
+    bool Set(const string &, const string &) override { return false; }
+    bool Delete(const string &) override { return false; }
+
+    bool Get(const string &key, string &out) const override {
+        if (key != "k") {
+            return false;
+        }
+        out = *value;
+        return true;
+    }
+
+    bool Lookup(const string &key, string &, shared_ptr<const string> &out) const override {
+        if (key != "k") {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+    shared_ptr<const string> value;
+};
+
+} // namespace
+
+TEST(OutputTest, TextIsMerged) {
+    Output out;
+    EXPECT_TRUE(out.empty());
+
+    out.Append("abc");
+    out.Append("def", 3);
+    out.Append(make_shared<const string>("small"));
+    EXPECT_EQ(11, out.size());
+
+    struct iovec iov[4];
+    EXPECT_EQ(1, out.Prepare(iov, 4));
+    EXPECT_EQ("abcdefsmall", Drain(out, 4, 100));
+    EXPECT_TRUE(out.empty());
+}
+
+TEST(OutputTest, LargeValueIsReferenced) {
+    Output out;
+    auto value = make_shared<const string>(Output::kMinReferenced, 'x');
+    out.Append("VALUE\r\n");
+    out.Append(value);
+    out.Append("\r\nEND");
+
+    struct iovec iov[4];
+    ASSERT_EQ(3, out.Prepare(iov, 4));
+    EXPECT_EQ(value->data(), iov[1].iov_base);
+    EXPECT_EQ(2, value.use_count());
+
+    EXPECT_EQ("VALUE\r\n" + *value + "\r\nEND", Drain(out, 4, 100));
+    EXPECT_EQ(1, value.use_count());
+}
+
+TEST(OutputTest, PartialConsume) {
+    Output out;
+    string expected;
+    for (int i = 0; i < 100; i++) {
+        string text = "line " + to_string(i) + "\r\n";
+        auto value = make_shared<const string>(Output::kMinReferenced + i, 'a' + i % 26);
+        out.Append(text);
+        out.Append(value);
+        expected += text + *value;
+    }
+    EXPECT_EQ(expected.size(), out.size());
+    EXPECT_EQ(expected, Drain(out, 3, 777));
+}
+
+TEST(OutputTest, KeepsAppendingWhileSending) {
+    Output out;
+    string expected, result;
+    struct iovec iov[1];
+    for (int i = 0; i < 1000; i++) {
+        string text = to_string(i) + ";";
+        out.Append(text);
+        expected += text;
+
+        // Send a bit less than added, so that output never gets empty
+        out.Prepare(iov, 1);
+        size_t n = min<size_t>(iov[0].iov_len, 2);
+        result.append(static_cast<char *>(iov[0].iov_base), n);
+        out.Consume(n);
+    }
+    result += Drain(out, 1, 100);
+    EXPECT_EQ(expected, result);
+}
+
+TEST(OutputTest, GetReferencesValue) {
+    OneValue storage(string(10000, 'v'));
+    Allocator::Vector<Allocator::String> keys;
+    keys.emplace_back("k");
+    keys.emplace_back("missing");
+    Get get(keys);
+
+    Output out;
+    get.Execute(storage, "", out);
+    EXPECT_EQ(2, storage.value.use_count());
+
+    string text;
+    get.Execute(storage, "", text);
+    EXPECT_EQ(text, Drain(out, 16, 1 << 20));
+    EXPECT_EQ("VALUE k 0 10000\r\n" + *storage.value + "\r\nEND", text);
+}
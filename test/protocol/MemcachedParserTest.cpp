@@ -4,10 +4,13 @@
 #include <string>
 
 #include <afina/execute/Add.h>
+#include <afina/execute/CacheMemlimit.h>
 #include <afina/execute/Get.h>
 #include <afina/execute/Set.h>
 #include <afina/execute/Stats.h>
 
+#include <afina/allocator/Region.h>
+
 #include <protocol/Parser.h>
 
 using namespace Afina;
@@ -58,6 +61,25 @@ TEST(MemcachedParserTest, SimpleAdd) {
     ASSERT_EQ(-1, tmp->expire());
 }
 
+// Verify expire time of several digits
+TEST(MemcachedParserTest, ExpireTime) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse("set foo 0 3600 6\r\n", consumed));
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_EQ(3600, reinterpret_cast<Execute::Set *>(cmd.get())->expire());
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("add foo 0 -120 6\r\n", consumed));
+    cmd = parser.Build(value_size);
+    ASSERT_EQ(-120, reinterpret_cast<Execute::Add *>(cmd.get())->expire());
+
+    parser.Reset();
+    EXPECT_THROW(parser.Parse("set foo 0 99999999999 6\r\n", consumed), std::runtime_error);
+}
+
 // Verify simple get command passed in a single string
 TEST(MemcachedParserTest, SimpleGet) {
     Protocol::Parser parser;
@@ -98,3 +120,45 @@ TEST(MemcachedParserTest, Stats) {
     Execute::Stats *tmp = reinterpret_cast<Execute::Stats *>(cmd.get());
     ASSERT_FALSE(tmp == nullptr);
 }
+
+TEST(MemcachedParserTest, CacheMemlimit) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse("cache_memlimit 512\r\nget foo\r\n", consumed));
+    ASSERT_EQ(20, consumed);
+    ASSERT_EQ("cache_memlimit", parser.Name());
+
+    // Argument isn't a data block size
+    size_t value_size = 1;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_NE(nullptr, dynamic_cast<Execute::CacheMemlimit *>(cmd.get()));
+    ASSERT_EQ(0, value_size);
+}
+
+// Verify commands could be built in the request memory
+TEST(MemcachedParserTest, RequestMemory) {
+    Allocator::Region region;
+    Protocol::Parser parser(&region);
+
+    for (int i = 0; i < 10; i++) {
+        size_t consumed = 0;
+        ASSERT_TRUE(parser.Parse("get first_very_long_key second_very_long_key\r\n", consumed));
+
+        size_t value_size;
+        std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+        ASSERT_FALSE(cmd == nullptr);
+
+        std::vector<std::string> keys = reinterpret_cast<Execute::Get *>(cmd.get())->keys();
+        ASSERT_EQ(2, keys.size());
+        ASSERT_EQ("first_very_long_key", keys[0]);
+        ASSERT_EQ("second_very_long_key", keys[1]);
+
+        cmd.reset();
+        parser.Reset();
+        region.reset();
+    }
+
+    // Every round took the same memory
+    EXPECT_EQ(4096, region.capacity());
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include <sys/uio.h>
+
+#include <afina/execute/Output.h>
+
+#include <protocol/Processor.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+
+namespace {
+
+// Takes everything pending out of the output
+std::string Take(Execute::Output &out) {
+    std::string result;
+    struct iovec iov[16];
+    while (!out.empty()) {
+        size_t filled = out.Prepare(iov, 16);
+        size_t taken = 0;
+        for (size_t i = 0; i < filled; i++) {
+            result.append(static_cast<char *>(iov[i].iov_base), iov[i].iov_len);
+            taken += iov[i].iov_len;
+        }
+        out.Consume(taken);
+    }
+    return result;
+}
+
+const std::string kRequests = "set foo 0 0 3\r\nbar\r\nget foo\r\nappend foo 0 0 3\r\nbaz\r\nget foo\r\n";
+const std::string kResponses = "STORED\r\nVALUE foo 0 3\r\nbar\r\nEND\r\nSTORED\r\nVALUE foo 0 6\r\nbarbaz\r\nEND\r\n";
+
+} // namespace
+
+TEST(ProcessorTest, PipelinedCommands) {
+    Backend::SimpleLRU storage;
+    Protocol::Processor processor(storage);
+    Execute::Output out;
+    EXPECT_EQ(kRequests.size(), processor.Process(kRequests.data(), kRequests.size(), out));
+    EXPECT_EQ(kResponses, Take(out));
+}
+
+TEST(ProcessorTest, CommandsSpanReads) {
+    Backend::SimpleLRU storage;
+    Protocol::Processor processor(storage);
+    Execute::Output out;
+    for (char c : kRequests) {
+        EXPECT_EQ(1, processor.Process(&c, 1, out));
+    }
+    EXPECT_EQ(kResponses, Take(out));
+}
+
+TEST(ProcessorTest, StopsOnOutputLimit) {
+    Backend::SimpleLRU storage;
+    Protocol::Processor processor(storage);
+    Execute::Output out;
+
+    // Command is finished even if it makes output exceed the limit, the next one isn't started
+    size_t consumed = processor.Process(kRequests.data(), kRequests.size(), out, 1);
+    EXPECT_EQ(std::string("set foo 0 0 3\r\nbar\r\n").size(), consumed);
+    EXPECT_EQ("STORED\r\n", Take(out));
+
+    consumed += processor.Process(kRequests.data() + consumed, kRequests.size() - consumed, out);
+    EXPECT_EQ(kRequests.size(), consumed);
+    EXPECT_EQ(kResponses.substr(8), Take(out));
+}
+
+TEST(ProcessorTest, BadDataChunk) {
+    Backend::SimpleLRU storage;
+    Protocol::Processor processor(storage);
+    Execute::Output out;
+
+    std::string requests = "set foo 0 0 3\r\nbar\r\nset foo 0 0 3\r\nbarXX";
+    EXPECT_THROW(processor.Process(requests.data(), requests.size(), out), std::runtime_error);
+    EXPECT_EQ("STORED\r\n", Take(out));
+
+    // Partial command is dropped, so the next request starts from scratch
+    processor.Reset();
+    std::string get = "get foo\r\n";
+    EXPECT_EQ(get.size(), processor.Process(get.data(), get.size(), out));
+    EXPECT_EQ("VALUE foo 0 3\r\nbar\r\nEND\r\n", Take(out));
+}
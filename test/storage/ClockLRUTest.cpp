@@ -0,0 +1,163 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/ClockLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+TEST(ClockLRUTest, PutGetDelete) {
+    ClockLRU storage;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "val3"));
+    EXPECT_TRUE(storage.Set("KEY2", "val22"));
+    EXPECT_FALSE(storage.Set("KEY3", "val3"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val1", value);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val22", value);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+}
+
+TEST(ClockLRUTest, ReferencedSurvive) {
+    // Room for exactly 4 items of 8 bytes
+    ClockLRU storage(32);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(storage.Put("KEY" + to_string(i), "val" + to_string(i)));
+    }
+
+    // KEY0 and KEY2 are hot
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY0", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+
+    EXPECT_TRUE(storage.Put("KEY4", "val4"));
+    EXPECT_TRUE(storage.Put("KEY5", "val5"));
+
+    EXPECT_TRUE(storage.Get("KEY0", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY3", value));
+    EXPECT_TRUE(storage.Get("KEY4", value));
+    EXPECT_TRUE(storage.Get("KEY5", value));
+}
+
+TEST(ClockLRUTest, SetNeverEvictsItself) {
+    ClockLRU storage(32);
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+
+    EXPECT_FALSE(storage.Set("KEY2", std::string(29, 'x')));
+    EXPECT_TRUE(storage.Set("KEY2", std::string(28, 'x')));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ(std::string(28, 'x'), value);
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY3", value));
+}
+
+TEST(ClockLRUTest, ShrinkIsGradual) {
+    // Items take 200 bytes each
+    const std::string value(195, 'x');
+    ClockLRU storage(1000 * 200);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(storage.Put(to_string(10000 + i), value));
+    }
+
+    // Nothing is evicted right away, each write evicts a bounded number of items more than it needs
+    auto count = [&storage](int from, int to) {
+        int present = 0;
+        std::string res;
+        for (int i = from; i < to; i++) {
+            present += storage.Get(to_string(10000 + i), res);
+        }
+        return present;
+    };
+    EXPECT_TRUE(storage.Resize(100 * 200));
+    EXPECT_EQ(1000, count(0, 1000));
+
+    ASSERT_TRUE(storage.Put("11000", value));
+    EXPECT_GT(count(0, 1001), 500);
+
+    for (int i = 1001; i < 1100; i++) {
+        ASSERT_TRUE(storage.Put(to_string(10000 + i), value));
+    }
+    EXPECT_EQ(100, count(0, 1100));
+
+    // Grown storage takes more items at once
+    EXPECT_TRUE(storage.Resize(200 * 200));
+    for (int i = 1100; i < 1200; i++) {
+        ASSERT_TRUE(storage.Put(to_string(10000 + i), value));
+    }
+    EXPECT_EQ(200, count(0, 1200));
+}
+
+TEST(ClockLRUTest, ConcurrentReadWrite) {
+    const int threads_count = 8;
+    ClockLRU storage(64 * 1024);
+    for (int i = 0; i < 100; i++) {
+        storage.Put("KEY" + to_string(i), "val" + to_string(i));
+    }
+
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; t++) {
+        threads.emplace_back([&storage, &failures, t]() {
+            std::string value;
+            for (int i = 0; i < 10000; i++) {
+                std::string key = "KEY" + to_string(i % 100);
+                if (t == 0 && i % 10 == 0) {
+                    storage.Put(key, "val" + to_string(i % 100));
+                } else if (!storage.Get(key, value) || value != "val" + to_string(i % 100)) {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(0, failures.load());
+}
+
+TEST(ClockLRUTest, Expiration) {
+    ClockLRU storage;
+    EXPECT_TRUE(storage.Put("KEY1", "val1", 1));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY3", "val3", 1));
+    EXPECT_TRUE(storage.Put("KEY4", "val4", 1));
+    EXPECT_TRUE(storage.Set("KEY4", "val44", 100));
+    EXPECT_TRUE(storage.Set("KEY1", "val11"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val11", value);
+
+    // Set without ttl keeps the deadline, with ttl replaces it
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY3", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_TRUE(storage.Get("KEY4", value));
+    EXPECT_EQ("val44", value);
+
+    // Expired item counts as absent one
+    EXPECT_FALSE(storage.Set("KEY1", "val1"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY1", "val1"));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Delete("KEY3"));
+}
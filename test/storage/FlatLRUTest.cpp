@@ -0,0 +1,213 @@
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "storage/FlatLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+TEST(FlatLRUTest, PutGetDelete) {
+    FlatLRU storage;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "val3"));
+    EXPECT_TRUE(storage.Set("KEY2", "val22"));
+    EXPECT_FALSE(storage.Set("KEY3", "val3"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val1", value);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val22", value);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+}
+
+TEST(FlatLRUTest, EvictLeastRecent) {
+    const size_t length = 20;
+    FlatLRU storage(1000 * FlatLRU::ItemSize(length, length));
+
+    for (long i = 0; i < 1000; ++i) {
+        auto key = "Key " + to_string(i);
+        auto val = "Val " + to_string(i);
+        key.resize(length, ' ');
+        val.resize(length, ' ');
+        EXPECT_TRUE(storage.Put(key, val));
+    }
+
+    // Touch first 100 items, so that the next 100 become least recent
+    std::string res;
+    for (long i = 0; i < 100; ++i) {
+        auto key = "Key " + to_string(i);
+        key.resize(length, ' ');
+        EXPECT_TRUE(storage.Get(key, res));
+    }
+
+    for (long i = 1000; i < 1100; ++i) {
+        auto key = "Key " + to_string(i);
+        key.resize(length, ' ');
+        EXPECT_TRUE(storage.Put(key, std::string(length, 'x')));
+    }
+
+    for (long i = 0; i < 1100; ++i) {
+        auto key = "Key " + to_string(i);
+        key.resize(length, ' ');
+        EXPECT_EQ(i < 100 || i >= 200, storage.Get(key, res)) << key;
+    }
+}
+
+TEST(FlatLRUTest, OverheadIsAccounted) {
+    // Items are tiny, limit would hold thousands of them if only keys and values were counted
+    FlatLRU storage(100 * FlatLRU::ItemSize(4, 4));
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(storage.Put("K" + to_string(1000 + i), "v" + to_string(100 + i % 900)));
+    }
+
+    int found = 0;
+    std::string value;
+    for (int i = 0; i < 1000; i++) {
+        found += storage.Get("K" + to_string(1000 + i), value);
+    }
+    EXPECT_EQ(100, found);
+    EXPECT_TRUE(storage.Get("K1999", value));
+    EXPECT_FALSE(storage.Get("K1899", value));
+
+    // Value moved to the heap takes its bytes on top of the entry
+    EXPECT_TRUE(storage.Set("K1999", std::string(200, 'x')));
+    found = 0;
+    for (int i = 0; i < 1000; i++) {
+        found += storage.Get("K" + to_string(1000 + i), value);
+    }
+    EXPECT_LT(found, 100);
+}
+
+TEST(FlatLRUTest, ShrinkIsGradual) {
+    FlatLRU storage(1000 * FlatLRU::ItemSize(5, 3));
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(storage.Put("K" + to_string(1000 + i), "val"));
+    }
+
+    // Nothing is evicted right away, each write evicts a bounded number of items more than it needs
+    auto count = [&storage](int from, int to) {
+        int present = 0;
+        std::string value;
+        for (int i = from; i < to; i++) {
+            present += storage.Get("K" + to_string(1000 + i), value);
+        }
+        return present;
+    };
+    EXPECT_TRUE(storage.Resize(100 * FlatLRU::ItemSize(5, 3)));
+    EXPECT_EQ(1000, count(0, 1000));
+
+    ASSERT_TRUE(storage.Put("K2000", "val"));
+    EXPECT_GT(count(0, 1001), 500);
+
+    for (int i = 1001; i < 1100; i++) {
+        ASSERT_TRUE(storage.Put("K" + to_string(1000 + i), "val"));
+    }
+    EXPECT_EQ(100, count(0, 1100));
+    EXPECT_EQ(100, count(1000, 1100));
+
+    // Grown storage takes more items at once
+    EXPECT_TRUE(storage.Resize(200 * FlatLRU::ItemSize(5, 3)));
+    for (int i = 1100; i < 1200; i++) {
+        ASSERT_TRUE(storage.Put("K" + to_string(1000 + i), "val"));
+    }
+    EXPECT_EQ(200, count(0, 1200));
+}
+
+// Random operations must give the same results as a reference map as long as
+// nothing gets evicted
+TEST(FlatLRUTest, MatchesReference) {
+    FlatLRU storage(1024 * 1024);
+    std::map<std::string, std::string> reference;
+
+    std::srand(42);
+    for (int i = 0; i < 100000; i++) {
+        std::string key = "k" + to_string(std::rand() % 2000);
+        std::string value = "v" + to_string(i);
+        std::string res;
+
+        switch (std::rand() % 4) {
+        case 0:
+            EXPECT_TRUE(storage.Put(key, value));
+            reference[key] = value;
+            break;
+        case 1:
+            EXPECT_EQ(reference.erase(key) > 0, storage.Delete(key));
+            break;
+        case 2:
+            EXPECT_EQ(reference.count(key) > 0, storage.Set(key, value));
+            if (reference.count(key) > 0) {
+                reference[key] = value;
+            }
+            break;
+        default:
+            EXPECT_EQ(reference.count(key) > 0, storage.Get(key, res));
+            if (reference.count(key) > 0) {
+                EXPECT_EQ(reference[key], res);
+            }
+        }
+    }
+}
+
+TEST(FlatLRUTest, InlineAndBlockValues) {
+    FlatLRU storage(1024);
+    std::string small(10, 's'), large(100, 'l'), value;
+
+    // Value moves between entry and heap block in both directions, key must survive
+    EXPECT_TRUE(storage.Put("KEY", small));
+    EXPECT_TRUE(storage.Set("KEY", large));
+    EXPECT_TRUE(storage.Get("KEY", value));
+    EXPECT_EQ(large, value);
+    EXPECT_TRUE(storage.Set("KEY", large + large));
+    EXPECT_TRUE(storage.Get("KEY", value));
+    EXPECT_EQ(large + large, value);
+    EXPECT_TRUE(storage.Set("KEY", small));
+    EXPECT_TRUE(storage.Get("KEY", value));
+    EXPECT_EQ(small, value);
+
+    std::string long_key(50, 'k');
+    EXPECT_TRUE(storage.Put(long_key, small));
+    EXPECT_TRUE(storage.Get(long_key, value));
+    EXPECT_EQ(small, value);
+    EXPECT_FALSE(storage.PutIfAbsent(long_key, large));
+    EXPECT_TRUE(storage.Delete(long_key));
+    EXPECT_FALSE(storage.Get(long_key, value));
+    EXPECT_TRUE(storage.Get("KEY", value));
+}
+
+TEST(FlatLRUTest, Expiration) {
+    FlatLRU storage;
+    EXPECT_TRUE(storage.Put("KEY1", "val1", 1));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY3", "val3", 1));
+    EXPECT_TRUE(storage.Put("KEY4", "val4", 1));
+    EXPECT_TRUE(storage.Set("KEY4", "val44", 100));
+    EXPECT_TRUE(storage.Set("KEY1", "val11"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val11", value);
+
+    // Set without ttl keeps the deadline, with ttl replaces it
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY3", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_TRUE(storage.Get("KEY4", value));
+    EXPECT_EQ("val44", value);
+
+    // Expired item counts as absent one
+    EXPECT_FALSE(storage.Set("KEY1", "val1"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY1", "val1"));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Delete("KEY3"));
+}
@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include "storage/FrequencySketch.h"
+
+using namespace Afina::Backend;
+
+TEST(FrequencySketchTest, CountsAccesses) {
+    FrequencySketch sketch(1000);
+    EXPECT_EQ(4096, sketch.width());
+
+    for (uint32_t hash = 0; hash < 100; hash++) {
+        for (uint32_t i = 0; i < hash % 10; i++) {
+            sketch.Increment(hash);
+        }
+    }
+
+    // Collisions could only make estimate larger, the sketch is wide enough for that not to happen here
+    for (uint32_t hash = 0; hash < 100; hash++) {
+        EXPECT_EQ(hash % 10, sketch.Estimate(hash));
+    }
+    EXPECT_EQ(0, sketch.Estimate(12345));
+}
+
+TEST(FrequencySketchTest, Saturates) {
+    FrequencySketch sketch(1000);
+    for (int i = 0; i < 100; i++) {
+        sketch.Increment(42);
+    }
+    EXPECT_EQ(FrequencySketch::kMaxFrequency, sketch.Estimate(42));
+}
+
+TEST(FrequencySketchTest, Ages) {
+    FrequencySketch sketch(100);
+    for (int i = 0; i < 12; i++) {
+        sketch.Increment(7);
+    }
+    EXPECT_EQ(12, sketch.Estimate(7));
+
+    // Enough other keys to reach sample size of ten increments per key
+    for (uint32_t hash = 1000; hash < 1000 + 10 * 100 - 12; hash++) {
+        sketch.Increment(hash);
+    }
+    EXPECT_EQ(6, sketch.Estimate(7));
+}
+
+TEST(FrequencySketchTest, ResizeResets) {
+    FrequencySketch sketch;
+    sketch.Increment(1);
+    sketch.Resize(100);
+    EXPECT_EQ(512, sketch.width());
+    EXPECT_EQ(0, sketch.Estimate(1));
+}
+
+TEST(FrequencySketchTest, RebuildKeepsEstimates) {
+    FrequencySketch sketch(1000);
+    for (uint32_t hash = 0; hash < 100; hash++) {
+        for (uint32_t i = 0; i < hash % 10; i++) {
+            sketch.Increment(hash);
+        }
+    }
+
+    // Growing copies counters, so estimates stay exact
+    sketch.Rebuild(4000);
+    EXPECT_EQ(16384, sketch.width());
+    for (uint32_t hash = 0; hash < 100; hash++) {
+        EXPECT_EQ(hash % 10, sketch.Estimate(hash));
+    }
+
+    // Folded counters could only overestimate
+    sketch.Rebuild(100);
+    EXPECT_EQ(512, sketch.width());
+    for (uint32_t hash = 0; hash < 100; hash++) {
+        EXPECT_LE(hash % 10, sketch.Estimate(hash));
+    }
+}
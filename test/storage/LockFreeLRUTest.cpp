@@ -0,0 +1,211 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/Epoch.h>
+
+#include "storage/LockFreeLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+namespace {
+
+// Access stamps come from a coarse clock, items must be accessed far enough apart to be ordered
+void Tick() { std::this_thread::sleep_for(std::chrono::milliseconds(20)); }
+
+// Frees items removed by this thread, they are accounted until then. Nobody else is inside a guard, so
+// a few epochs are enough
+void Reclaim() {
+    for (int i = 0; i < 10; i++) {
+        Afina::Concurrency::Epoch::Collect();
+    }
+}
+
+} // namespace
+
+TEST(LockFreeLRUTest, PutGetDelete) {
+    LockFreeLRU storage;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "val3"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY3", "val3"));
+    EXPECT_TRUE(storage.Set("KEY2", "val22"));
+    EXPECT_FALSE(storage.Set("KEY4", "val4"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val1", value);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val22", value);
+    EXPECT_TRUE(storage.Get("KEY3", value));
+    EXPECT_EQ("val3", value);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    Reclaim();
+    EXPECT_EQ(LockFreeLRU::ItemSize(4, 5) + LockFreeLRU::ItemSize(4, 4), storage.size());
+}
+
+TEST(LockFreeLRUTest, SharedBucket) {
+    // Far more items than buckets, chains are long
+    LockFreeLRU storage(1024 * 1024, 16);
+    EXPECT_EQ(16, storage.buckets());
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(storage.Put("KEY" + to_string(i), "val" + to_string(i)));
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        EXPECT_TRUE(storage.Delete("KEY" + to_string(i)));
+    }
+
+    std::string value;
+    for (int i = 0; i < 1000; i++) {
+        bool found = storage.Get("KEY" + to_string(i), value);
+        EXPECT_EQ(i % 2 == 1, found);
+        if (found) {
+            EXPECT_EQ("val" + to_string(i), value);
+        }
+    }
+}
+
+TEST(LockFreeLRUTest, EvictsLeastRecentlyUsed) {
+    // Room for exactly 4 items, eviction samples all of them
+    LockFreeLRU storage(4 * LockFreeLRU::ItemSize(4, 4));
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(storage.Put("KEY" + to_string(i), "val" + to_string(i)));
+        Tick();
+    }
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY0", value));
+    Tick();
+    EXPECT_TRUE(storage.Put("KEY4", "val4"));
+    Reclaim();
+    EXPECT_EQ(4 * LockFreeLRU::ItemSize(4, 4), storage.size());
+
+    EXPECT_TRUE(storage.Get("KEY0", value));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_TRUE(storage.Get("KEY3", value));
+    EXPECT_TRUE(storage.Get("KEY4", value));
+
+    EXPECT_FALSE(storage.Put("KEY5", std::string(4 * LockFreeLRU::ItemSize(4, 4), 'x')));
+}
+
+TEST(LockFreeLRUTest, SparseTableEvicts) {
+    // Items are far apart, eviction probes past its bucket limit until it finds one
+    const size_t item_size = LockFreeLRU::ItemSize(4, 4);
+    LockFreeLRU storage(4 * item_size, 1 << 16);
+    for (int i = 0; i < 8; i++) {
+        EXPECT_TRUE(storage.Put("KEY" + to_string(i), "val" + to_string(i)));
+    }
+    Reclaim();
+    // Victims of the recent puts could still be retired and accounted when later puts evict
+    EXPECT_LE(storage.size(), 4 * item_size);
+    EXPECT_TRUE(storage.size() > 0);
+}
+
+TEST(LockFreeLRUTest, Expiration) {
+    LockFreeLRU storage;
+    EXPECT_TRUE(storage.Put("KEY1", "val1", 1));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Set("KEY1", "val11"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val11", value);
+
+    // Set without ttl keeps the deadline
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_FALSE(storage.Set("KEY1", "val1"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY1", "val1"));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+}
+
+TEST(LockFreeLRUTest, ShrinkIsGradual) {
+    const size_t item_size = LockFreeLRU::ItemSize(7, 100);
+    LockFreeLRU storage(2000 * item_size);
+    for (int i = 0; i < 2000; i++) {
+        EXPECT_TRUE(storage.Put("KEY" + to_string(1000 + i), std::string(100, 'v')));
+    }
+
+    // Each write evicts a bit more than it adds, until the new limit is reached
+    EXPECT_TRUE(storage.Resize(1000 * item_size));
+    EXPECT_TRUE(storage.Put("KEY0000", std::string(100, 'v')));
+    EXPECT_GT(storage.size(), 1500 * item_size);
+
+    for (int i = 0; i < 1000 && storage.size() > 1000 * item_size; i++) {
+        EXPECT_TRUE(storage.Put("KEY" + to_string(1000 + i), std::string(100, 'v')));
+    }
+    EXPECT_LE(storage.size(), 1000 * item_size);
+}
+
+TEST(LockFreeLRUTest, RetiredItemsAreAccounted) {
+    const size_t item_size = LockFreeLRU::ItemSize(4, 4);
+    LockFreeLRU storage(100 * item_size);
+
+    std::atomic<bool> entered(false), leave(false);
+    std::thread reader([&]() {
+        Afina::Concurrency::Epoch::Guard guard;
+        entered = true;
+        while (!leave) {
+            std::this_thread::yield();
+        }
+    });
+    while (!entered) {
+        std::this_thread::yield();
+    }
+
+    // Reader could still see the replaced item, its memory isn't free yet
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY1", "val2"));
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    Reclaim();
+    EXPECT_EQ(2 * item_size, storage.size());
+
+    leave = true;
+    reader.join();
+    for (int i = 0; i < 100 && storage.size() > 0; i++) {
+        Afina::Concurrency::Epoch::Collect();
+    }
+    EXPECT_EQ(0, storage.size());
+}
+
+TEST(LockFreeLRUTest, ConcurrentReadWrite) {
+    const int threads_count = 8;
+    const int keys_count = 1000;
+    LockFreeLRU storage(100 * LockFreeLRU::ItemSize(7, 7), 64);
+
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; t++) {
+        threads.emplace_back([&storage, &failures, t]() {
+            std::string value;
+            for (int i = 0; i < 20000; i++) {
+                int k = (i * 7 + t * 13) % keys_count;
+                std::string key = "KEY" + to_string(k);
+                if (i % 4 == 0) {
+                    storage.Put(key, "val" + to_string(k));
+                } else if (i % 16 == 1) {
+                    storage.Delete(key);
+                } else if (storage.Get(key, value) && value != "val" + to_string(k)) {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(0, failures.load());
+    Reclaim();
+    EXPECT_LE(storage.size(), 100 * LockFreeLRU::ItemSize(7, 7));
+}
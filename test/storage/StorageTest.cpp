@@ -1,9 +1,11 @@
 #include "gtest/gtest.h"
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <set>
 #include <vector>
 
+#include <afina/allocator/SmallAlloc.h>
 #include <afina/execute/Add.h>
 #include <afina/execute/Append.h>
 #include <afina/execute/Delete.h>
@@ -147,7 +149,7 @@ std::string pad_space(const std::string &s, size_t length) {
 
 TEST(StorageTest, BigTest) {
     const size_t length = 20;
-    SimpleLRU storage(2 * 100000 * length);
+    SimpleLRU storage(100000 * SimpleLRU::ItemSize(length, length));
 
     for (long i = 0; i < 100000; ++i) {
         auto key = pad_space("Key " + std::to_string(i), length);
@@ -168,7 +170,7 @@ TEST(StorageTest, BigTest) {
 
 TEST(StorageTest, MaxTest) {
     const size_t length = 20;
-    SimpleLRU storage(2 * 1000 * length);
+    SimpleLRU storage(1000 * SimpleLRU::ItemSize(length, length));
 
     std::stringstream ss;
 
@@ -195,3 +197,510 @@ TEST(StorageTest, MaxTest) {
         EXPECT_FALSE(storage.Get(key, res));
     }
 }
+
+TEST(StorageTest, SlabEvictsSameClass) {
+    const size_t length = 20;
+    std::unique_ptr<Afina::Allocator::Slab> owner(new Afina::Allocator::Slab(3 * 4096, 4096, 2.0, 64));
+    Afina::Allocator::Slab *slab = owner.get();
+    SimpleLRU storage(std::move(owner));
+
+    // Small items take a single page, large ones take two others
+    std::string small(length, 's'), large(1000, 'l');
+    size_t small_count = 4096 / slab->chunk_size(slab->class_of(SimpleLRU::ItemSize(length, length)));
+    for (long i = 0; i < 4; ++i) {
+        EXPECT_TRUE(storage.Put(pad_space("Large " + std::to_string(i), length), large));
+    }
+    for (size_t i = 0; i < small_count + 10; ++i) {
+        EXPECT_TRUE(storage.Put(pad_space("Small " + std::to_string(i), length), small));
+    }
+
+    // Once small class runs out only small items get evicted
+    std::string res;
+    for (size_t i = 0; i < small_count + 10; ++i) {
+        EXPECT_EQ(i >= 10, storage.Get(pad_space("Small " + std::to_string(i), length), res));
+    }
+    for (long i = 0; i < 4; ++i) {
+        EXPECT_TRUE(storage.Get(pad_space("Large " + std::to_string(i), length), res));
+        EXPECT_EQ(large, res);
+    }
+
+    // There are no pages left for a new class
+    EXPECT_FALSE(storage.Put("Huge", std::string(3000, 'h')));
+}
+
+TEST(StorageTest, FailedUpdateKeepsValue) {
+    std::unique_ptr<Afina::Allocator::Slab> slab(new Afina::Allocator::Slab(4096, 4096, 2.0, 64));
+    SimpleLRU storage(std::move(slab));
+
+    // The only page is taken by the small class, larger value of the same key has nowhere to go
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_FALSE(storage.Set("KEY1", std::string(1000, 'x')));
+    EXPECT_FALSE(storage.Put("KEY1", std::string(1000, 'x')));
+
+    std::string res;
+    EXPECT_TRUE(storage.Get("KEY1", res));
+    EXPECT_EQ("val1", res);
+    EXPECT_TRUE(storage.Get("KEY2", res));
+    EXPECT_EQ("val2", res);
+
+    EXPECT_TRUE(storage.Set("KEY1", "value1"));
+    EXPECT_TRUE(storage.Get("KEY1", res));
+    EXPECT_EQ("value1", res);
+}
+
+TEST(StorageTest, GrowingUpdateEvictsOthers) {
+    SimpleLRU storage(3 * SimpleLRU::ItemSize(4, 4));
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+
+    // KEY1 is the least recent one, but it is being updated, so the next one makes room
+    EXPECT_TRUE(storage.Set("KEY1", "val1val1"));
+    std::string res;
+    EXPECT_TRUE(storage.Get("KEY1", res));
+    EXPECT_EQ("val1val1", res);
+    EXPECT_FALSE(storage.Get("KEY2", res));
+    EXPECT_TRUE(storage.Get("KEY3", res));
+}
+
+TEST(StorageTest, SlabRandomSizes) {
+    std::unique_ptr<Afina::Allocator::Slab> slab(new Afina::Allocator::Slab(64 * 4096, 4096));
+    SimpleLRU storage(std::move(slab));
+
+    std::srand(42);
+    std::vector<std::string> values(500);
+    for (long i = 0; i < 100000; ++i) {
+        size_t k = std::rand() % values.size();
+        std::string key = "Key " + std::to_string(k);
+        if (std::rand() % 2) {
+            values[k] = std::string(std::rand() % 2000, 'a' + k % 26);
+            EXPECT_TRUE(storage.Put(key, values[k]));
+        } else {
+            std::string res;
+            if (storage.Get(key, res)) {
+                EXPECT_EQ(values[k], res);
+            }
+        }
+    }
+}
+
+TEST(StorageTest, ArenaRandomSizes) {
+    SimpleLRU storage(1024 * 1024, 64 * 1024);
+
+    std::srand(42);
+    std::vector<std::string> values(500);
+    size_t hits = 0;
+    for (long i = 0; i < 100000; ++i) {
+        size_t k = std::rand() % values.size();
+        std::string key = "Key " + std::to_string(k);
+        if (std::rand() % 2) {
+            values[k] = std::string(std::rand() % 2000, 'a' + k % 26);
+            EXPECT_TRUE(storage.Put(key, values[k]));
+        } else {
+            std::string res;
+            if (storage.Get(key, res)) {
+                EXPECT_EQ(values[k], res);
+                hits++;
+            }
+        }
+    }
+
+    // Arena is compacted rather than wiped out
+    EXPECT_GT(hits, 0);
+}
+
+TEST(StorageTest, SharedValue) {
+    SimpleLRU storage(1024 * 1024);
+
+    std::string large(10000, 'l');
+    EXPECT_TRUE(storage.Put("Large", large));
+    EXPECT_TRUE(storage.Put("Small", "small"));
+
+    // Large value is handed out without copying, small one is copied
+    std::shared_ptr<const std::string> first, second, small;
+    EXPECT_TRUE(storage.GetShared("Large", first));
+    EXPECT_TRUE(storage.GetShared("Large", second));
+    EXPECT_EQ(large, *first);
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_TRUE(storage.GetShared("Small", small));
+    EXPECT_EQ("small", *small);
+    EXPECT_FALSE(storage.GetShared("Missing", small));
+    EXPECT_EQ("small", *small);
+
+    std::string copy;
+    std::shared_ptr<const std::string> shared;
+    EXPECT_TRUE(storage.Lookup("Small", copy, shared));
+    EXPECT_EQ("small", copy);
+    EXPECT_EQ(nullptr, shared);
+    EXPECT_TRUE(storage.Lookup("Large", copy, shared));
+    EXPECT_EQ(first.get(), shared.get());
+    shared.reset();
+
+    // Buffer stays unchanged once value is replaced or deleted
+    EXPECT_TRUE(storage.Set("Large", "now small"));
+    std::string res;
+    EXPECT_TRUE(storage.Get("Large", res));
+    EXPECT_EQ("now small", res);
+    EXPECT_TRUE(storage.Put("Large", std::string(5000, 'n')));
+    EXPECT_TRUE(storage.Get("Large", res));
+    EXPECT_EQ(std::string(5000, 'n'), res);
+    EXPECT_TRUE(storage.Delete("Large"));
+    EXPECT_EQ(large, *first);
+    EXPECT_EQ(2, first.use_count());
+}
+
+TEST(StorageTest, SharedValueEvicts) {
+    const size_t length = 20, value_size = 4096;
+    SimpleLRU storage(10 * SimpleLRU::ItemSize(length, value_size));
+
+    // Shared values are accounted in full even though item blocks are small
+    for (long i = 0; i < 20; ++i) {
+        EXPECT_TRUE(storage.Put(pad_space("Key " + std::to_string(i), length), std::string(value_size, 'a' + i)));
+    }
+    for (long i = 0; i < 20; ++i) {
+        std::string res;
+        EXPECT_EQ(i >= 10, storage.Get(pad_space("Key " + std::to_string(i), length), res));
+    }
+}
+
+TEST(StorageTest, SharedRandomSizes) {
+    std::shared_ptr<Afina::Allocator::SmallAlloc> items(new Afina::Allocator::SmallAlloc(64 * 64 * 1024));
+    SimpleLRU storage(256 * 1024, items);
+
+    std::srand(42);
+    std::vector<std::string> values(500);
+    for (long i = 0; i < 100000; ++i) {
+        size_t k = std::rand() % values.size();
+        std::string key = "Key " + std::to_string(k);
+        if (std::rand() % 2) {
+            values[k] = std::string(std::rand() % 4000, 'a' + k % 26);
+            EXPECT_TRUE(storage.Put(key, values[k]));
+        } else if (std::rand() % 2) {
+            std::string res;
+            if (storage.Get(key, res)) {
+                EXPECT_EQ(values[k], res);
+            }
+        } else {
+            std::shared_ptr<const std::string> res;
+            if (storage.GetShared(key, res)) {
+                EXPECT_EQ(values[k], *res);
+            }
+        }
+    }
+}
+
+TEST(StorageTest, IncrementalRehash) {
+    SimpleLRU storage(64 * 1024 * 1024);
+
+    // Index grows several times, every key must be found whichever bucket array it is in meanwhile
+    std::set<int> present;
+    for (int i = 0; i < 20000; i++) {
+        ASSERT_TRUE(storage.Put("Key " + std::to_string(i), std::to_string(i)));
+        present.insert(i);
+        if (i % 3 == 0) {
+            ASSERT_TRUE(storage.Delete("Key " + std::to_string(i / 2)) == (present.erase(i / 2) == 1));
+        }
+
+        std::string res;
+        int probe = i * 7919 % (i + 1);
+        ASSERT_EQ(present.count(probe) == 1, storage.Get("Key " + std::to_string(probe), res)) << i;
+    }
+
+    for (int i = 0; i < 20000; i++) {
+        std::string res;
+        ASSERT_EQ(present.count(i) == 1, storage.Get("Key " + std::to_string(i), res)) << i;
+        if (present.count(i) == 1) {
+            EXPECT_EQ(std::to_string(i), res);
+        }
+    }
+}
+
+TEST(StorageTest, Reserve) {
+    SimpleLRU storage(64 * 1024 * 1024);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(storage.Put("Key " + std::to_string(i), std::to_string(i)));
+    }
+
+    // Index is rebuilt for more items, those already stored stay
+    storage.Reserve(100000);
+    for (int i = 100; i < 1000; i++) {
+        ASSERT_TRUE(storage.Put("Key " + std::to_string(i), std::to_string(i)));
+    }
+    storage.Reserve(10);
+    for (int i = 0; i < 1000; i++) {
+        std::string res;
+        ASSERT_TRUE(storage.Get("Key " + std::to_string(i), res));
+        EXPECT_EQ(std::to_string(i), res);
+    }
+}
+
+TEST(StorageTest, ShrinkIsGradual) {
+    const size_t length = 10;
+    SimpleLRU storage(1000 * SimpleLRU::ItemSize(length, length));
+    for (long i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(storage.Put(pad_space("Key " + std::to_string(i), length), pad_space("Val", length)));
+    }
+
+    // Nothing is evicted right away, each write evicts a bounded number of items more than it needs
+    auto count = [&storage](long from, long to) {
+        long present = 0;
+        std::string res;
+        for (long i = from; i < to; ++i) {
+            present += storage.Get(pad_space("Key " + std::to_string(i), length), res);
+        }
+        return present;
+    };
+    EXPECT_TRUE(storage.Resize(100 * SimpleLRU::ItemSize(length, length)));
+    EXPECT_EQ(1000, count(0, 1000));
+
+    ASSERT_TRUE(storage.Put(pad_space("Key 1000", length), pad_space("Val", length)));
+    EXPECT_GT(count(0, 1001), 500);
+
+    for (long i = 1001; i < 1100; ++i) {
+        ASSERT_TRUE(storage.Put(pad_space("Key " + std::to_string(i), length), pad_space("Val", length)));
+    }
+    EXPECT_EQ(100, count(0, 1100));
+    EXPECT_EQ(100, count(1000, 1100));
+
+    // Grown storage takes more items at once
+    EXPECT_TRUE(storage.Resize(200 * SimpleLRU::ItemSize(length, length)));
+    for (long i = 1100; i < 1200; ++i) {
+        ASSERT_TRUE(storage.Put(pad_space("Key " + std::to_string(i), length), pad_space("Val", length)));
+    }
+    EXPECT_EQ(200, count(0, 1200));
+}
+
+TEST(StorageTest, MultiGet) {
+    const size_t length = 10;
+    SimpleLRU storage(100 * SimpleLRU::ItemSize(length, length));
+    for (long i = 0; i < 100; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, pad_space("Val " + std::to_string(i), length)));
+    }
+
+    // Batch is longer than prefetch group and has missing and repeated keys
+    std::vector<Afina::Storage::Entry> entries(50);
+    std::vector<Afina::Storage::Entry *> batch;
+    for (long i = 0; i < 50; ++i) {
+        entries[i].key = pad_space("Key " + std::to_string(i % 25 * 5), length);
+        batch.push_back(&entries[i]);
+    }
+    storage.MultiGet(batch.data(), batch.size());
+
+    for (long i = 0; i < 50; ++i) {
+        long k = i % 25 * 5;
+        EXPECT_EQ(k < 100, entries[i].found);
+        if (k < 100) {
+            EXPECT_EQ(pad_space("Val " + std::to_string(k), length), entries[i].value);
+        }
+    }
+
+    // Keys read by the batch become the most recent ones
+    for (long i = 0; i < 80; ++i) {
+        EXPECT_TRUE(storage.Put(pad_space("New " + std::to_string(i), length), pad_space("", length)));
+    }
+    std::string res;
+    for (long i = 0; i < 100; ++i) {
+        EXPECT_EQ(i % 5 == 0, storage.Get(pad_space("Key " + std::to_string(i), length), res));
+    }
+}
+
+TEST(StorageTest, SegmentedResistsScan) {
+    const size_t length = 10;
+    SimpleLRU lru(100 * SimpleLRU::ItemSize(length, length));
+    SimpleLRU slru(100 * SimpleLRU::ItemSize(length, length), SimpleLRU::Policy::SegmentedLRU);
+
+    // Hot set is accessed twice, then scan of many keys read once goes
+    std::string res;
+    for (SimpleLRU *storage : {&lru, &slru}) {
+        for (long i = 0; i < 50; ++i) {
+            EXPECT_TRUE(storage->Put(pad_space("Hot " + std::to_string(i), length), pad_space("", length)));
+        }
+        for (long i = 0; i < 50; ++i) {
+            EXPECT_TRUE(storage->Get(pad_space("Hot " + std::to_string(i), length), res));
+        }
+        for (long i = 0; i < 1000; ++i) {
+            EXPECT_TRUE(storage->Put(pad_space("Scan " + std::to_string(i), length), pad_space("", length)));
+        }
+    }
+
+    for (long i = 0; i < 50; ++i) {
+        EXPECT_FALSE(lru.Get(pad_space("Hot " + std::to_string(i), length), res));
+        EXPECT_TRUE(slru.Get(pad_space("Hot " + std::to_string(i), length), res));
+    }
+}
+
+TEST(StorageTest, SegmentedProtectedLimit) {
+    const size_t length = 10;
+    SimpleLRU storage(100 * SimpleLRU::ItemSize(length, length), SimpleLRU::Policy::SegmentedLRU);
+
+    // All items are accessed twice, but only 80% of them fit into protected segment
+    std::string res;
+    for (long i = 0; i < 100; ++i) {
+        EXPECT_TRUE(storage.Put(pad_space("Key " + std::to_string(i), length), pad_space("", length)));
+    }
+    for (long i = 0; i < 100; ++i) {
+        EXPECT_TRUE(storage.Get(pad_space("Key " + std::to_string(i), length), res));
+    }
+
+    // Demoted items are evicted first, then new ones, protected items stay
+    for (long i = 0; i < 30; ++i) {
+        EXPECT_TRUE(storage.Put(pad_space("New " + std::to_string(i), length), pad_space("", length)));
+    }
+    for (long i = 0; i < 100; ++i) {
+        EXPECT_EQ(i >= 20, storage.Get(pad_space("Key " + std::to_string(i), length), res));
+    }
+    for (long i = 0; i < 30; ++i) {
+        EXPECT_EQ(i >= 10, storage.Get(pad_space("New " + std::to_string(i), length), res));
+    }
+
+    // Deleted protected items free their share
+    for (long i = 20; i < 100; ++i) {
+        EXPECT_TRUE(storage.Delete(pad_space("Key " + std::to_string(i), length)));
+    }
+    for (long i = 0; i < 100; ++i) {
+        EXPECT_TRUE(storage.Put(pad_space("Key " + std::to_string(i), length), pad_space("", length)));
+        EXPECT_TRUE(storage.Get(pad_space("Key " + std::to_string(i), length), res));
+    }
+    for (long i = 20; i < 100; ++i) {
+        EXPECT_TRUE(storage.Get(pad_space("Key " + std::to_string(i), length), res));
+    }
+}
+
+TEST(StorageTest, TinyLFURejectsRareKeys) {
+    const size_t length = 10;
+    SimpleLRU slru(100 * SimpleLRU::ItemSize(length, length), SimpleLRU::Policy::SegmentedLRU);
+    SimpleLRU tinylfu(100 * SimpleLRU::ItemSize(length, length), SimpleLRU::Policy::TinyLFU);
+
+    // Hot set is larger than protected segment, so segmented LRU keeps part of it in probation
+    std::string res;
+    for (SimpleLRU *storage : {&slru, &tinylfu}) {
+        for (long i = 0; i < 90; ++i) {
+            EXPECT_TRUE(storage->Put(pad_space("Hot " + std::to_string(i), length), pad_space("", length)));
+        }
+        for (long j = 0; j < 3; ++j) {
+            for (long i = 0; i < 90; ++i) {
+                EXPECT_TRUE(storage->Get(pad_space("Hot " + std::to_string(i), length), res));
+            }
+        }
+
+        // Keys written once are always stored, at least until the next new key comes. Hot set is still
+        // read meanwhile, otherwise its frequency fades
+        for (long i = 0; i < 1000; ++i) {
+            auto key = pad_space("Rare " + std::to_string(i), length);
+            EXPECT_TRUE(storage->Put(key, pad_space("", length)));
+            EXPECT_TRUE(storage->Get(key, res));
+            storage->Get(pad_space("Hot " + std::to_string(i % 90), length), res);
+        }
+    }
+
+    size_t slru_hits = 0, tinylfu_hits = 0;
+    for (long i = 0; i < 90; ++i) {
+        slru_hits += slru.Get(pad_space("Hot " + std::to_string(i), length), res);
+        tinylfu_hits += tinylfu.Get(pad_space("Hot " + std::to_string(i), length), res);
+    }
+    EXPECT_GT(tinylfu_hits, 80);
+    EXPECT_LT(slru_hits, tinylfu_hits / 2);
+}
+
+namespace {
+
+// SimpleLRU which time is set by the test
+class ManualClockLRU : public SimpleLRU {
+public:
+    using SimpleLRU::SimpleLRU;
+
+    uint32_t now = 1000;
+
+protected:
+    uint32_t Now() const override { return now; }
+};
+
+} // namespace
+
+TEST(StorageTest, ExpiredIsAbsent) {
+    ManualClockLRU storage(1024 * 1024);
+    std::string res;
+    std::shared_ptr<const std::string> shared;
+
+    EXPECT_TRUE(storage.Put("key", "value", 10));
+    EXPECT_TRUE(storage.Put("forever", "value"));
+    storage.now += 9;
+    EXPECT_TRUE(storage.Get("key", res));
+
+    // Reads see nothing even though the wheel hasn't got to the item yet
+    storage.now += 1;
+    EXPECT_FALSE(storage.Get("key", res));
+    EXPECT_FALSE(storage.GetShared("key", shared));
+    EXPECT_FALSE(storage.Lookup("key", res, shared));
+    Afina::Storage::Entry entry;
+    Afina::Storage::Entry *batch[] = {&entry};
+    entry.key = "key";
+    storage.MultiGet(batch, 1);
+    EXPECT_FALSE(entry.found);
+
+    EXPECT_FALSE(storage.Set("key", "other"));
+    EXPECT_TRUE(storage.PutIfAbsent("key", "other", 5));
+    EXPECT_TRUE(storage.Get("key", res));
+    EXPECT_EQ("other", res);
+    storage.now += 5;
+    EXPECT_FALSE(storage.Delete("key"));
+
+    storage.now += 1000000;
+    EXPECT_TRUE(storage.Get("forever", res));
+}
+
+TEST(StorageTest, SetChangesExpiration) {
+    ManualClockLRU storage(1024 * 1024);
+    std::string res;
+
+    // Set without ttl keeps expiration, with ttl changes it
+    EXPECT_TRUE(storage.Put("key", "value", 10));
+    EXPECT_TRUE(storage.Set("key", "longer value"));
+    storage.now += 10;
+    EXPECT_FALSE(storage.Get("key", res));
+
+    EXPECT_TRUE(storage.Put("key", "value", 10));
+    EXPECT_TRUE(storage.Set("key", "value", 100));
+    storage.now += 50;
+    EXPECT_TRUE(storage.Put("other", "value"));
+    EXPECT_TRUE(storage.Get("key", res));
+    storage.now += 50;
+    EXPECT_FALSE(storage.Get("key", res));
+
+    // Put without ttl makes item live forever
+    EXPECT_TRUE(storage.Put("key", "value", 10));
+    EXPECT_TRUE(storage.Put("key", "value"));
+    storage.now += 100;
+    EXPECT_TRUE(storage.Put("other", "value"));
+    EXPECT_TRUE(storage.Get("key", res));
+}
+
+TEST(StorageTest, WheelReclaimsExpired) {
+    ManualClockLRU storage(4 * 1024 * 1024);
+    const uint32_t start = storage.now;
+
+    // Deadlines go over all wheel levels, shared value is referenced by the storage until the item is deleted
+    std::vector<std::shared_ptr<const std::string>> values;
+    std::vector<uint32_t> ttls;
+    for (uint32_t i = 0; i < 300; i++) {
+        ttls.push_back(1 + i * i * 29);
+        EXPECT_TRUE(storage.Put("key" + std::to_string(i), std::string(4096, 'a' + i % 26), ttls.back()));
+
+        std::shared_ptr<const std::string> value;
+        EXPECT_TRUE(storage.GetShared("key" + std::to_string(i), value));
+        values.push_back(value);
+    }
+
+    // Any modification advances the wheel
+    for (uint32_t i = 0; i < values.size(); i++) {
+        storage.now = start + ttls[i] - 1;
+        storage.Delete("none");
+        EXPECT_EQ(2, values[i].use_count()) << i;
+
+        storage.now = start + ttls[i];
+        storage.Delete("none");
+        EXPECT_EQ(1, values[i].use_count()) << i;
+    }
+}
@@ -0,0 +1,296 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/allocator/SmallAlloc.h>
+
+#include "storage/SimpleLRU.h"
+#include "storage/StripedLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina::Backend;
+using namespace std;
+
+TEST(StripedLRUTest, PutGetDelete) {
+    StripedLRU storage(8, 8 * 1024);
+
+    for (int i = 0; i < 64; i++) {
+        EXPECT_TRUE(storage.Put("KEY" + to_string(i), "val" + to_string(i)));
+    }
+
+    std::string value;
+    for (int i = 0; i < 64; i++) {
+        EXPECT_TRUE(storage.Get("KEY" + to_string(i), value));
+        EXPECT_EQ("val" + to_string(i), value);
+    }
+
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "other"));
+    EXPECT_TRUE(storage.Set("KEY1", "other"));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("other", value);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Set("KEY1", "val1"));
+}
+
+TEST(StripedLRUTest, InvalidConfig) {
+    EXPECT_THROW(StripedLRU(0, 1024), std::runtime_error);
+    EXPECT_THROW(StripedLRU(16, 8), std::runtime_error);
+}
+
+TEST(StripedLRUTest, BudgetIsSplit) {
+    // Each stripe has room for a single 8 bytes item only
+    const size_t budget = 4 * SimpleLRU::ItemSize(4, 4);
+    StripedLRU storage(4, budget);
+    EXPECT_FALSE(storage.Put("KEY1", "val12"));
+
+    // Total amount of data never exceeds the budget
+    for (int i = 0; i < 100; i++) {
+        storage.Put("K" + to_string(i % 10), "v" + to_string(100 + i));
+    }
+
+    std::string value;
+    size_t total = 0;
+    for (int i = 0; i < 10; i++) {
+        std::string key = "K" + to_string(i);
+        if (storage.Get(key, value)) {
+            total += SimpleLRU::ItemSize(key.size(), value.size());
+        }
+    }
+    EXPECT_GT(total, 0);
+    EXPECT_LE(total, budget);
+}
+
+TEST(StripedLRUTest, ConcurrentAccess) {
+    const int threads_count = 8;
+    const int keys_per_thread = 1000;
+    StripedLRU storage(16, 1024 * 1024);
+
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; t++) {
+        threads.emplace_back([&storage, &failures, t, keys_per_thread]() {
+            std::string value;
+            for (int i = 0; i < keys_per_thread; i++) {
+                std::string key = "KEY" + to_string(t) + "_" + to_string(i);
+                if (!storage.Put(key, key)) {
+                    failures++;
+                }
+                if (!storage.Get(key, value) || value != key) {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(0, failures.load());
+}
+
+TEST(StripedLRUTest, SharedAllocator) {
+    const int threads_count = 8;
+    const int keys_per_thread = 1000;
+    std::shared_ptr<Afina::Allocator::SmallAlloc> items(new Afina::Allocator::SmallAlloc(64 * 64 * 1024));
+    StripedLRU storage(16, 1024 * 1024, items);
+
+    // Items put by one thread are overwritten and freed by the others
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; t++) {
+        threads.emplace_back([&storage, &failures, t, keys_per_thread]() {
+            std::string value;
+            for (int i = 0; i < keys_per_thread; i++) {
+                std::string key = "KEY" + to_string(i);
+                std::string put = key + "_" + to_string(t);
+                if (!storage.Put(key, put)) {
+                    failures++;
+                }
+                if (!storage.Get(key, value) || value.compare(0, key.size() + 1, key + "_") != 0) {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(0, failures.load());
+}
+
+TEST(StripedLRUTest, AllocatorExhausted) {
+    // Allocator runs out of memory long before storage budget does
+    std::shared_ptr<Afina::Allocator::SmallAlloc> items(new Afina::Allocator::SmallAlloc(4 * 64 * 1024));
+    SimpleLRU storage(64 * 1024 * 1024, items);
+
+    std::string value;
+    for (int i = 0; i < 100000; i++) {
+        std::string key = "KEY" + to_string(i);
+        ASSERT_TRUE(storage.Put(key, std::string(100, 'a' + i % 26)));
+        ASSERT_TRUE(storage.Get(key, value));
+    }
+    EXPECT_FALSE(storage.Get("KEY0", value));
+}
+
+TEST(StripedLRUTest, MultiGet) {
+    StripedLRU storage(8, 1024 * 1024);
+    for (int i = 0; i < 100; i += 2) {
+        ASSERT_TRUE(storage.Put("KEY" + to_string(i), i % 10 ? "val" + to_string(i) : std::string(4096, 'a' + i % 26)));
+    }
+
+    // Entries get regrouped by stripe, each of them still gets the result for its own key
+    std::vector<Afina::Storage::Entry> entries(100);
+    std::vector<Afina::Storage::Entry *> batch;
+    for (int i = 0; i < 100; i++) {
+        entries[i].key = "KEY" + to_string(i);
+        batch.push_back(&entries[i]);
+    }
+    storage.MultiGet(batch.data(), batch.size());
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(i % 2 == 0, entries[i].found) << i;
+        if (!entries[i].found) {
+            continue;
+        }
+        if (i % 10) {
+            EXPECT_EQ(nullptr, entries[i].shared);
+            EXPECT_EQ("val" + to_string(i), entries[i].value);
+        } else {
+            ASSERT_NE(nullptr, entries[i].shared);
+            EXPECT_EQ(std::string(4096, 'a' + i % 26), *entries[i].shared);
+        }
+    }
+}
+
+namespace {
+
+// Number of keys KEY0..KEY<count-1> present in the storage
+int CountPresent(Afina::Storage &storage, int count) {
+    int present = 0;
+    std::string value;
+    for (int i = 0; i < count; i++) {
+        present += storage.Get("KEY" + to_string(i), value);
+    }
+    return present;
+}
+
+// Waits for the background reclaim to get the number of present keys down to the limit
+int WaitReclaimed(Afina::Storage &storage, int count, int limit) {
+    int present = CountPresent(storage, count);
+    for (int i = 0; i < 500 && present > limit; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        present = CountPresent(storage, count);
+    }
+    return present;
+}
+
+} // namespace
+
+TEST(StripedLRUTest, BackgroundReclaim) {
+    const size_t item_size = SimpleLRU::ItemSize(5, 5);
+    ThreadSafeSimpleLRU storage(100 * item_size);
+    storage.SetWatermarks(20, 40);
+    storage.Start();
+
+    // Writes never fail, while background thread gets storage down to the high watermark
+    for (int i = 0; i < 90; i++) {
+        ASSERT_TRUE(storage.Put("KEY" + to_string(10 + i), "val" + to_string(10 + i)));
+    }
+
+    // Reads would change the order, so reclaim is given plenty of time instead of being polled
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    storage.Stop();
+
+    // The least recent items go first
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY10", value));
+    EXPECT_TRUE(storage.Get("KEY99", value));
+
+    int present = CountPresent(storage, 100);
+    EXPECT_LE(present, 60);
+    EXPECT_GE(present, 50);
+}
+
+TEST(StripedLRUTest, NoReclaimWithoutWatermarks) {
+    const size_t item_size = SimpleLRU::ItemSize(5, 5);
+    ThreadSafeSimpleLRU storage(100 * item_size);
+    storage.Start();
+    for (int i = 0; i < 90; i++) {
+        ASSERT_TRUE(storage.Put("KEY" + to_string(10 + i), "val" + to_string(10 + i)));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(90, CountPresent(storage, 100));
+    storage.Stop();
+}
+
+TEST(StripedLRUTest, StripesReclaim) {
+    const size_t item_size = SimpleLRU::ItemSize(6, 6);
+    StripedLRU storage(4, 4 * 100 * item_size);
+    storage.SetWatermarks(10, 50);
+    storage.Start();
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; t++) {
+        writers.emplace_back([&storage, t]() {
+            for (int i = 100 + t; i < 1000; i += 4) {
+                storage.Put("KEY" + to_string(i), "val" + to_string(i));
+            }
+        });
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+
+    // Each stripe keeps at most half of its limit once reclaim is done
+    EXPECT_LE(WaitReclaimed(storage, 1000, 200), 200);
+    storage.Stop();
+}
+
+TEST(StripedLRUTest, ShrinkInBackground) {
+    const size_t item_size = SimpleLRU::ItemSize(6, 6);
+    StripedLRU storage(4, 4 * 1000 * item_size);
+    storage.SetWatermarks(5, 10);
+    storage.Start();
+    for (int i = 1000; i < 3000; i++) {
+        storage.Put("KEY" + to_string(i), "val" + to_string(i));
+    }
+
+    // Reclaimer gets storage down to the new limit without any writes
+    ASSERT_TRUE(storage.Resize(4 * 100 * item_size));
+    EXPECT_LE(WaitReclaimed(storage, 3000, 400), 400);
+    storage.Stop();
+}
+
+TEST(StripedLRUTest, Expiration) {
+    StripedLRU storage(4, 4 * 1024);
+    EXPECT_TRUE(storage.Put("KEY1", "val1", 1));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY3", "val3", 1));
+    EXPECT_TRUE(storage.Put("KEY4", "val4", 1));
+    EXPECT_TRUE(storage.Set("KEY4", "val44", 100));
+    EXPECT_TRUE(storage.Set("KEY1", "val11"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val11", value);
+
+    // Set without ttl keeps the deadline, with ttl replaces it
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY3", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_TRUE(storage.Get("KEY4", value));
+    EXPECT_EQ("val44", value);
+
+    // Expired item counts as absent one
+    EXPECT_FALSE(storage.Set("KEY1", "val1"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY1", "val1"));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Delete("KEY3"));
+}